@@ -0,0 +1,253 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <numeric>
+#include "CompletionTrie.h"
+#include "TelexData.h"
+
+namespace VietType {
+namespace Completion {
+
+using namespace VietType::Telex;
+
+static_assert(CompletionTrie::MaxWords <= UINT16_MAX + 1);
+
+bool CompletionTrie::MakeKey(
+    std::wstring_view word, _Out_ std::span<uint8_t, MaxWordLength> symbols, _Out_ int& tone) const {
+    tone = static_cast<int>(Tones::Z);
+    if (word.size() > MaxWordLength) {
+        return false;
+    }
+    for (std::size_t i = 0; i < word.size(); i++) {
+        auto lk = _letters[GetCharInfo(word[i]).letter];
+        if (!lk.symbol) {
+            return false;
+        }
+        if (lk.tone != static_cast<uint8_t>(Tones::Z)) {
+            if (tone != static_cast<int>(Tones::Z)) {
+                return false;
+            }
+            tone = lk.tone;
+        }
+        symbols[i] = lk.symbol;
+    }
+    return true;
+}
+
+CompletionTrie CompletionTrie::Build(std::span<const std::wstring_view> words, std::span<const uint32_t> weights) {
+    assert(weights.empty() || weights.size() == words.size());
+    CompletionTrie trie;
+
+    auto letterSymbol = [](wchar_t c) { return static_cast<uint8_t>(1 + ToneSymbols + GetCharInfo(c).letter); };
+    for (wchar_t c = L'a'; c <= L'z'; c++) {
+        trie._letters[GetCharInfo(c).letter] = {letterSymbol(c), static_cast<uint8_t>(Tones::Z)};
+    }
+    for (auto c : vietnameseLetters) {
+        trie._letters[GetCharInfo(c).letter] = {letterSymbol(c), static_cast<uint8_t>(Tones::Z)};
+    }
+    for (const auto& [base, toned] : transitions_tones) {
+        for (std::size_t t = 1; t < toned.size(); t++) {
+            trie._letters[GetCharInfo(toned[t]).letter] = {letterSymbol(base), static_cast<uint8_t>(t)};
+        }
+    }
+
+    // the tone goes first so that a toned prefix is a single subtree
+    struct Entry {
+        Key key;
+        std::wstring word;
+        uint32_t weight;
+    };
+    std::vector<Entry> entries;
+    std::array<uint8_t, MaxWordLength> symbols;
+    int tone;
+    for (std::size_t i = 0; i < words.size(); i++) {
+        std::wstring lower(words[i]);
+        for (auto& c : lower) {
+            c = ToLower(c);
+        }
+        if (lower.empty() || !trie.MakeKey(lower, symbols, tone)) {
+            continue;
+        }
+        Key key{static_cast<uint8_t>(1 + tone)};
+        key.insert(key.end(), symbols.begin(), symbols.begin() + lower.size());
+        auto weight = weights.empty() ? static_cast<uint32_t>(MaxWordLength - lower.size()) : weights[i];
+        entries.push_back(Entry{std::move(key), std::move(lower), weight});
+    }
+    // keep the first of any duplicates
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.key < b.key; });
+    entries.erase(
+        std::unique(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.key == b.key; }),
+        entries.end());
+    if (entries.size() > MaxWords) {
+        entries.resize(MaxWords);
+    }
+
+    auto n = static_cast<uint32_t>(entries.size());
+    std::vector<Key> keys;
+    keys.reserve(n);
+    trie._offsets.reserve(n + 1);
+    trie._weights.reserve(n);
+    for (auto& e : entries) {
+        trie._offsets.push_back(static_cast<uint32_t>(trie._text.size()));
+        trie._text.append(e.word);
+        trie._weights.push_back(e.weight);
+        keys.push_back(std::move(e.key));
+    }
+    trie._offsets.push_back(static_cast<uint32_t>(trie._text.size()));
+
+    trie._states.push_back(State{0, -1, 0, n});
+    std::size_t firstFree = 1;
+    trie.Place(0, keys, 0, n, 0, firstFree);
+    trie._states.shrink_to_fit();
+
+    // sparse table for the best word of any range
+    if (n) {
+        auto levels = static_cast<std::size_t>(std::bit_width(n));
+        trie._best.resize(levels * n);
+        std::iota(trie._best.begin(), trie._best.begin() + n, uint16_t(0));
+        for (std::size_t l = 1; l < levels; l++) {
+            auto half = std::size_t(1) << (l - 1);
+            for (std::size_t i = 0; i + 2 * half <= n; i++) {
+                trie._best[l * n + i] = static_cast<uint16_t>(
+                    trie.Better(trie._best[(l - 1) * n + i], trie._best[(l - 1) * n + i + half]));
+            }
+        }
+    }
+    return trie;
+}
+
+// keys[first, last) all share the path to state up to depth, shorter keys sort first
+void CompletionTrie::Place(
+    uint32_t state,
+    std::span<const Key> keys,
+    uint32_t first,
+    uint32_t last,
+    std::size_t depth,
+    _Inout_ std::size_t& firstFree) {
+    while (first < last && keys[first].size() == depth) {
+        first++;
+    }
+    if (first == last) {
+        return;
+    }
+
+    struct Child {
+        uint8_t symbol;
+        uint32_t first;
+        uint32_t last;
+    };
+    std::vector<Child> children;
+    for (auto i = first; i < last; i++) {
+        auto symbol = keys[i][depth];
+        if (children.empty() || children.back().symbol != symbol) {
+            children.push_back(Child{symbol, i, i + 1});
+        } else {
+            children.back().last = i + 1;
+        }
+    }
+
+    // first fit: the lowest base at which every child lands on a free slot, no lower than the first free slot
+    auto isFree = [&](std::size_t s) { return s >= _states.size() || _states[s].check < 0; };
+    while (!isFree(firstFree)) {
+        firstFree++;
+    }
+    auto base = static_cast<int32_t>(firstFree > children[0].symbol ? firstFree - children[0].symbol : 1);
+    while (!std::all_of(children.begin(), children.end(), [&](const Child& c) { return isFree(base + c.symbol); })) {
+        base++;
+    }
+    auto size = static_cast<std::size_t>(base) + children.back().symbol + 1;
+    if (_states.size() < size) {
+        _states.resize(size, State{0, -1, 0, 0});
+    }
+    _states[state].base = base;
+    for (const auto& c : children) {
+        _states[base + c.symbol] = State{0, static_cast<int32_t>(state), c.first, c.last};
+    }
+    for (const auto& c : children) {
+        Place(base + c.symbol, keys, c.first, c.last, depth + 1, firstFree);
+    }
+}
+
+uint32_t CompletionTrie::Best(uint32_t first, uint32_t last) const {
+    assert(first < last);
+    auto n = Count();
+    auto l = static_cast<std::size_t>(std::bit_width(last - first) - 1);
+    return Better(_best[l * n + first], _best[l * n + last - (uint32_t(1) << l)]);
+}
+
+std::size_t CompletionTrie::Complete(std::wstring_view prefix, _Out_ std::span<CompletionResult> results) const {
+    if (_states.empty() || results.empty()) {
+        return 0;
+    }
+    std::array<uint8_t, MaxWordLength> symbols;
+    int tone;
+    if (!MakeKey(prefix, symbols, tone)) {
+        return 0;
+    }
+
+    // each pending range with its best word, best first; a result splits its range in two
+    struct Pending {
+        uint32_t best;
+        uint32_t first;
+        uint32_t last;
+    };
+    std::array<Pending, ToneSymbols + 2 * MaxResults> heap;
+    std::size_t pending = 0;
+    auto worse = [this](const Pending& a, const Pending& b) { return Better(a.best, b.best) == b.best; };
+    auto push = [&](uint32_t first, uint32_t last) {
+        if (first < last) {
+            heap[pending++] = Pending{Best(first, last), first, last};
+            std::push_heap(heap.begin(), heap.begin() + pending, worse);
+        }
+    };
+
+    // without a tone in the prefix the tone is still to come, any of them will do
+    auto toneFirst = tone == static_cast<int>(Tones::Z) ? 0 : tone;
+    auto toneLast = tone == static_cast<int>(Tones::Z) ? static_cast<int>(ToneSymbols) - 1 : tone;
+    for (auto t = toneFirst; t <= toneLast; t++) {
+        auto s = static_cast<uint32_t>(_states[0].base + 1 + t);
+        if (s >= _states.size() || _states[s].check != 0) {
+            continue;
+        }
+        std::size_t i = 0;
+        for (; i < prefix.size(); i++) {
+            auto next = static_cast<uint32_t>(_states[s].base + symbols[i]);
+            if (!_states[s].base || next >= _states.size() || _states[next].check != static_cast<int32_t>(s)) {
+                break;
+            }
+            s = next;
+        }
+        if (i == prefix.size()) {
+            push(_states[s].first, _states[s].last);
+        }
+    }
+
+    std::size_t count = 0;
+    auto wanted = std::min(results.size(), MaxResults);
+    while (count < wanted && pending) {
+        std::pop_heap(heap.begin(), heap.begin() + pending, worse);
+        auto top = heap[--pending];
+        results[count++] = CompletionResult{
+            std::wstring_view(_text).substr(_offsets[top.best], _offsets[top.best + 1] - _offsets[top.best]),
+            _weights[top.best],
+        };
+        push(top.first, top.best);
+        push(top.best + 1, top.last);
+    }
+    return count;
+}
+
+std::size_t CompletionTrie::Complete(const ITelexEngine& engine, _Out_ std::span<CompletionResult> results) const {
+    std::array<wchar_t, MaxWordLength> buffer;
+    auto length = engine.Peek(buffer);
+    if (!length || length > buffer.size()) {
+        return 0;
+    }
+    return Complete(std::wstring_view(buffer.data(), length), results);
+}
+
+} // namespace Completion
+} // namespace VietType
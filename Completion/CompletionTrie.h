@@ -0,0 +1,121 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Telex.h"
+#include "TelexChars.h"
+
+namespace VietType {
+namespace Completion {
+
+struct CompletionResult {
+    // lowercase, points into the trie
+    std::wstring_view word;
+    uint32_t weight;
+};
+
+/// <summary>
+/// top-k prefix completion over a fixed list of Vietnamese words;
+/// words are keyed by their tone followed by their letters without the tone, so a prefix with a tone only completes
+/// to words of that tone, wherever the mark sits, and a prefix without one completes to words of every tone since
+/// Telex types the tone last;
+/// the keys live in a double-array trie whose states each cover the run of words under them in key order,
+/// and a sparse table over the weights gives the best word of any run in O(1),
+/// so a lookup is one array step per prefix character plus O(k log k) for the results, without allocating
+/// </summary>
+class CompletionTrie {
+public:
+    static constexpr std::size_t MaxWords = UINT16_MAX;
+    static constexpr std::size_t MaxWordLength = 32;
+    static constexpr std::size_t MaxResults = 16;
+
+    CompletionTrie() = default;
+
+    /// <summary>
+    /// build the trie from a word list, e.g. data/vw39kw.txt;
+    /// without weights, shorter words rank first;
+    /// words with anything but Vietnamese letters, with more than one tone or longer than MaxWordLength are skipped,
+    /// as are duplicates and everything past MaxWords
+    /// </summary>
+    /// <param name="weights">empty, or one per word; higher ranks first</param>
+    static CompletionTrie Build(std::span<const std::wstring_view> words, std::span<const uint32_t> weights = {});
+
+    /// <summary>
+    /// the best words starting with the prefix, by decreasing weight then in key order;
+    /// the prefix is matched case-insensitively and may be a whole word
+    /// </summary>
+    /// <returns>number of results filled in, at most MaxResults</returns>
+    std::size_t Complete(std::wstring_view prefix, _Out_ std::span<CompletionResult> results) const;
+    /// <summary>
+    /// complete what the engine shows for the word being typed (its Peek output)
+    /// </summary>
+    std::size_t Complete(const Telex::ITelexEngine& engine, _Out_ std::span<CompletionResult> results) const;
+
+    std::size_t Count() const {
+        return _weights.size();
+    }
+    /// <summary>
+    /// size of the double array, including free slots
+    /// </summary>
+    std::size_t StateCount() const {
+        return _states.size();
+    }
+
+private:
+    // symbol 0 is never used, 1 to 6 are the tones and the rest are letters without tones
+    static constexpr uint8_t ToneSymbols = 6;
+    static constexpr std::size_t SymbolCount = 1 + ToneSymbols + Telex::CharLetterCount;
+    static_assert(SymbolCount <= UINT8_MAX + 1);
+
+    struct State {
+        int32_t base;
+        // parent state, -1 if the slot is free
+        int32_t check;
+        // the words under this state are [first, last) in key order
+        uint32_t first;
+        uint32_t last;
+    };
+
+    struct LetterKey {
+        // symbol of the letter without its tone, 0 if not a letter
+        uint8_t symbol;
+        // Telex::Tones value, Z for none
+        uint8_t tone;
+    };
+
+    using Key = std::vector<uint8_t>;
+
+    // one symbol per character of the word, without the tone; false if the word cannot be keyed
+    bool MakeKey(std::wstring_view word, _Out_ std::span<uint8_t, MaxWordLength> symbols, _Out_ int& tone) const;
+    void Place(
+        uint32_t state,
+        std::span<const Key> keys,
+        uint32_t first,
+        uint32_t last,
+        std::size_t depth,
+        _Inout_ std::size_t& firstFree);
+    uint32_t Better(uint32_t a, uint32_t b) const {
+        return _weights[a] > _weights[b] || (_weights[a] == _weights[b] && a < b) ? a : b;
+    }
+    uint32_t Best(uint32_t first, uint32_t last) const;
+
+    std::array<LetterKey, Telex::CharLetterCount> _letters{};
+    std::vector<State> _states;
+    // words in key order, each ending at the next offset
+    std::wstring _text;
+    std::vector<uint32_t> _offsets;
+    std::vector<uint32_t> _weights;
+    // level l holds the best word of [i, i + 2^l) at l * Count() + i
+    std::vector<uint16_t> _best;
+};
+
+} // namespace Completion
+} // namespace VietType
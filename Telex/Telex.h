@@ -4,11 +4,18 @@
 #pragma once
 
 #include <vector>
+#include <cstddef>
+#include <span>
 #include <string>
+#include <string_view>
 
 namespace VietType {
 namespace Telex {
 
+class WordFilter;
+class AutocorrectRules;
+struct TelexSnapshot;
+
 // State transition is as follows:
 
 // Valid (initial) -> Valid|Invalid (by pushing a character)
@@ -32,6 +39,9 @@ enum class TelexStates {
     TxError = -1,      // can never be a state, returned when PushChar encounters an error
 };
 
+// Retrieve/RetrieveRaw/Peek never return more characters than this
+constexpr std::size_t MaxOutputLength = 256;
+
 struct TelexConfig {
     // put the tone in "oa"/"uy" in the second character instead of the first
     bool oa_uy_tone1 = true;
@@ -43,6 +53,17 @@ struct TelexConfig {
     unsigned long optimize_multilang = 1;
     // enable certain autocorrect rules
     bool autocorrect = false;
+    // more English words to leave alone on Commit when optimize_multilang is on, not owned by the config and must
+    // outlive every engine using it
+    const WordFilter* english_filter = nullptr;
+    // rules Commit applies when autocorrect is on instead of AutocorrectRules::Default(), not owned by the config and
+    // must outlive every engine using it
+    const AutocorrectRules* autocorrect_rules = nullptr;
+    // number of committed words each engine remembers, 0 to disable; rounded up to a multiple of 4. A word is only
+    // remembered once it is typed twice, so this pays off for running text where common words keep coming back (in
+    // the Zipf-distributed word stream of benchcommitcache, 1024 entries hit 72% of commits and cut the time to type
+    // it by about 30%), and costs a few tens of ns per commit when few words repeat
+    unsigned int commit_cache_size = 0;
 };
 
 class ITelexEngine {
@@ -51,7 +72,8 @@ public:
     }
 
     virtual const TelexConfig& GetConfig() const = 0;
-    virtual void SetConfig(const TelexConfig& configconfig) = 0;
+    // false if the engine cannot take the config, see TelexNew; the engine is then left as it was
+    virtual bool SetConfig(const TelexConfig& config) = 0;
 
     virtual void Reset() = 0;
     virtual TelexStates PushChar(_In_ wchar_t c) = 0;
@@ -59,16 +81,34 @@ public:
     virtual TelexStates Commit() = 0;
     virtual TelexStates ForceCommit() = 0;
     virtual TelexStates Cancel() = 0;
-    virtual TelexStates Backconvert(_In_ const std::wstring& s) = 0;
+    virtual TelexStates Backconvert(_In_ std::wstring_view s) = 0;
 
     virtual TelexStates GetState() const = 0;
     virtual std::wstring Retrieve() const = 0;
     virtual std::wstring RetrieveRaw() const = 0;
     virtual std::wstring Peek() const = 0;
+    // the span overloads write up to buffer.size() characters without a terminator and return the full length,
+    // which is never more than MaxOutputLength
+    virtual std::size_t Retrieve(_Out_ std::span<wchar_t> buffer) const = 0;
+    virtual std::size_t RetrieveRaw(_Out_ std::span<wchar_t> buffer) const = 0;
+    virtual std::size_t Peek(_Out_ std::span<wchar_t> buffer) const = 0;
     virtual std::wstring::size_type Count() const = 0;
+
+    // the word being typed, so that it can be put aside and picked up again; false if it is too long to save
+    virtual bool SaveSnapshot(_Out_ TelexSnapshot& snapshot) const = 0;
+    // the snapshot must come from an engine with the same config
+    virtual void RestoreSnapshot(_In_ const TelexSnapshot& snapshot) = 0;
+    // for a snapshot from an engine with another config, the word is then kept as SetConfig keeps it
+    virtual void RestoreSnapshotUnderNewConfig(_In_ const TelexSnapshot& snapshot) = 0;
 };
 
+// the options checked while typing are compiled into the returned engine, SetConfig fails if they change;
+// optimize_multilang above 3 is taken as 3, as the engine from TelexNewDynamic does
 ITelexEngine* TelexNew(const TelexConfig&);
+// the returned engine takes any config in SetConfig
+ITelexEngine* TelexNewDynamic(const TelexConfig&);
+// the engine TelexNew returns for the config, picking up the word being typed on the given engine
+ITelexEngine* TelexNewFrom(const ITelexEngine& engine, const TelexConfig& config);
 void TelexDelete(ITelexEngine*);
 
 } // namespace Telex
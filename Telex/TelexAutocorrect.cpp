@@ -0,0 +1,241 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <bit>
+#include <map>
+#include "TelexAutocorrect.h"
+
+namespace VietType {
+namespace Telex {
+
+using Rule = AutocorrectRule;
+
+static constexpr uint8_t ToneSJ = Rule::ToneBit(Tones::S) | Rule::ToneBit(Tones::J);
+static constexpr uint8_t ToneNotSJ = Rule::AllTones & ~ToneSJ;
+static constexpr int ToneCount = std::bit_width(Rule::AllTones);
+
+// Commit rewrites v first and c2 after, so the case bit of a new c2 character comes from the rewritten word
+static constexpr std::array builtinRules{
+    Rule{.v = L"wu", .newV = L"\x1b0u"},
+    Rule{.v = L"wo", .conditions = AutocorrectHasC1, .newV = L"\x1a1"},
+    Rule{.v = L"wuo", .newV = L"\x1b0\x1a1"},
+    // 'ach' and 'êch' only take the sharp and heavy tones, so a lone h after a/ê is ch with them and nh otherwise
+    Rule{.v = L"a", .c2 = L"h", .tones = ToneSJ, .newC2 = L"ch"},
+    Rule{.v = L"\xea", .c2 = L"h", .tones = ToneSJ, .newC2 = L"ch"},
+    Rule{.v = L"a", .c2 = L"h", .tones = ToneNotSJ, .conditions = AutocorrectMultilangLow, .newC2 = L"nh"},
+    Rule{.v = L"a", .c2 = L"h", .tones = ToneNotSJ, .conditions = AutocorrectValidRespos, .newC2 = L"nh"},
+    Rule{.v = L"\xea", .c2 = L"h", .tones = ToneNotSJ, .conditions = AutocorrectMultilangLow, .newC2 = L"nh"},
+    Rule{.v = L"\xea", .c2 = L"h", .tones = ToneNotSJ, .conditions = AutocorrectValidRespos, .newC2 = L"nh"},
+    Rule{.c2 = L"gn", .conditions = AutocorrectValidRespos, .newC2 = L"ng"},
+    Rule{.c2 = L"g", .conditions = AutocorrectValidRespos | AutocorrectMultilangLow, .newC2 = L"ng"},
+};
+
+std::span<const AutocorrectRule> AutocorrectRules::BuiltinRules() {
+    return builtinRules;
+}
+
+const AutocorrectRules& AutocorrectRules::Default() {
+    static const AutocorrectRules rules = Compile(builtinRules);
+    return rules;
+}
+
+AutocorrectRules AutocorrectRules::Compile(std::span<const AutocorrectRule> rules) {
+    AutocorrectRules compiled;
+    auto& issues = compiled._issues;
+    auto describe = [](const AutocorrectRule& r) {
+        std::wstring s;
+        s.append(r.c1).push_back(L'|');
+        s.append(r.v).push_back(L'|');
+        s.append(r.c2).append(L" -> ");
+        s.append(r.newV).push_back(L'|');
+        s.append(r.newC2);
+        return s;
+    };
+
+    // give every pattern an index per part, 0 standing for any other string
+    std::array<std::vector<std::wstring_view>, PartCount> patterns;
+    auto patternId = [&](Part part, std::wstring_view s) {
+        auto& list = patterns[part];
+        return static_cast<std::size_t>(std::find(list.begin(), list.end(), s) - list.begin()) + 1;
+    };
+    auto stringIndex = [&](std::wstring_view s) -> uint16_t {
+        if (s == Rule::Any) {
+            return 0;
+        }
+        auto& strings = compiled._strings;
+        auto it = std::find(strings.begin(), strings.end(), s);
+        if (it == strings.end()) {
+            it = strings.emplace(strings.end(), s);
+        }
+        return static_cast<uint16_t>(it - strings.begin() + 1);
+    };
+
+    struct Accepted {
+        const AutocorrectRule* rule;
+        Replacement replacement;
+    };
+    std::vector<Accepted> accepted;
+    for (const auto& r : rules) {
+        std::array<std::wstring_view, PartCount> parts{r.c1, r.v, r.c2};
+        auto packable = std::all_of(parts.begin(), parts.end(), [](std::wstring_view s) {
+            return s == Rule::Any || Pack(C1, s);
+        });
+        auto fits = [](std::wstring_view s) {
+            return s == Rule::Any || (s.size() <= MaxPartLength && s.find(L'\0') == std::wstring_view::npos);
+        };
+        if (!packable || !fits(r.newV) || !fits(r.newC2)) {
+            issues.push_back(L"part too long or with characters that cannot be packed: " + describe(r));
+            continue;
+        }
+        if (r.newV == Rule::Any && r.newC2 == Rule::Any) {
+            issues.push_back(L"rule rewrites nothing: " + describe(r));
+            continue;
+        }
+        if (!(r.tones & Rule::AllTones) || (r.tones & ~Rule::AllTones)) {
+            issues.push_back(L"rule has no tones or unknown ones: " + describe(r));
+            continue;
+        }
+
+        if (compiled._strings.size() + 2 > UINT16_MAX) {
+            issues.push_back(L"too many distinct replacements: " + describe(r));
+            continue;
+        }
+        auto sizes = compiled._sizes;
+        for (int p = 0; p < PartCount; p++) {
+            if (parts[p] != Rule::Any && patternId(static_cast<Part>(p), parts[p]) > patterns[p].size()) {
+                sizes[p]++;
+            }
+        }
+        if (sizes[C1] * sizes[V] * sizes[C2] > MaxCells) {
+            issues.push_back(L"too many distinct patterns: " + describe(r));
+            continue;
+        }
+        for (int p = 0; p < PartCount; p++) {
+            if (parts[p] != Rule::Any && patternId(static_cast<Part>(p), parts[p]) > patterns[p].size()) {
+                patterns[p].push_back(parts[p]);
+            }
+        }
+        compiled._sizes = sizes;
+        accepted.push_back(Accepted{&r, Replacement{stringIndex(r.newV), stringIndex(r.newC2)}});
+    }
+    compiled._count = accepted.size();
+
+    // pattern index lookup, at most half full
+    std::size_t patternCount = patterns[C1].size() + patterns[V].size() + patterns[C2].size();
+    auto tableSize = std::bit_ceil(std::max<std::size_t>(patternCount * 2, 2));
+    compiled._keys.assign(tableSize, 0);
+    compiled._ids.assign(tableSize, 0);
+    compiled._shift = 64 - std::countr_zero(tableSize);
+    for (int p = 0; p < PartCount; p++) {
+        for (std::size_t i = 0; i < patterns[p].size(); i++) {
+            auto key = Pack(static_cast<Part>(p), patterns[p][i]);
+            auto slot = compiled.Slot(key);
+            while (compiled._keys[slot]) {
+                slot = (slot + 1) & (tableSize - 1);
+            }
+            compiled._keys[slot] = key;
+            compiled._ids[slot] = static_cast<uint16_t>(i + 1);
+        }
+    }
+
+    // a rule goes into every cell whose parts it matches, keeping the table order within each cell
+    auto cellCount = compiled._sizes[C1] * compiled._sizes[V] * compiled._sizes[C2];
+    std::vector<std::vector<uint32_t>> cells(cellCount);
+    for (uint32_t i = 0; i < accepted.size(); i++) {
+        const auto& r = *accepted[i].rule;
+        auto range = [&](Part part, std::wstring_view s) {
+            if (s == Rule::Any) {
+                return std::pair<std::size_t, std::size_t>(0, compiled._sizes[part]);
+            }
+            auto id = patternId(part, s);
+            return std::pair<std::size_t, std::size_t>(id, id + 1);
+        };
+        auto [c1First, c1Last] = range(C1, r.c1);
+        auto [vFirst, vLast] = range(V, r.v);
+        auto [c2First, c2Last] = range(C2, r.c2);
+        for (auto c1 = c1First; c1 < c1Last; c1++) {
+            for (auto v = vFirst; v < vLast; v++) {
+                for (auto c2 = c2First; c2 < c2Last; c2++) {
+                    cells[(c1 * compiled._sizes[V] + v) * compiled._sizes[C2] + c2].push_back(i);
+                }
+            }
+        }
+
+        std::array<std::pair<Part, std::wstring_view>, 2> rewritten{{{V, r.newV}, {C2, r.newC2}}};
+        for (auto [part, replacement] : rewritten) {
+            if (replacement == Rule::Any) {
+                continue;
+            }
+            auto pattern = part == V ? r.v : r.c2;
+            if (pattern == Rule::Any) {
+                compiled._rewritesAny[part] = true;
+            } else {
+                compiled._rewritten[part].emplace_back(pattern);
+            }
+        }
+    }
+
+    // run the rules of each distinct cell for every tone and set of conditions
+    auto& replacements = compiled._replacements;
+    replacements.push_back(Replacement{0, 0});
+    std::map<uint32_t, uint32_t> knownReplacements{{0, 0}};
+    std::map<std::vector<uint32_t>, uint32_t> knownCells;
+    compiled._cells.reserve(cellCount);
+    for (const auto& cell : cells) {
+        auto [it, added] = knownCells.emplace(cell, static_cast<uint32_t>(compiled._outcomes.size()));
+        compiled._cells.push_back(it->second);
+        if (!added) {
+            continue;
+        }
+        for (int t = 0; t < ToneCount; t++) {
+            for (unsigned conditions = 0; conditions < ConditionSets; conditions++) {
+                Replacement outcome{0, 0};
+                for (auto i : cell) {
+                    const auto& r = *accepted[i].rule;
+                    auto replacement = accepted[i].replacement;
+                    if (!(r.tones & (1 << t)) || (r.conditions & ~conditions) || (replacement.v && outcome.v) ||
+                        (replacement.c2 && outcome.c2)) {
+                        continue;
+                    }
+                    outcome.v = outcome.v ? outcome.v : replacement.v;
+                    outcome.c2 = outcome.c2 ? outcome.c2 : replacement.c2;
+                }
+                auto [found, isNew] = knownReplacements.emplace(
+                    (uint32_t{outcome.v} << 16) | outcome.c2, static_cast<uint32_t>(replacements.size()));
+                if (isNew) {
+                    replacements.push_back(outcome);
+                }
+                compiled._outcomes.push_back(found->second);
+            }
+        }
+    }
+    return compiled;
+}
+
+AutocorrectRules::Rewrite AutocorrectRules::Find(
+    std::wstring_view c1, std::wstring_view v, std::wstring_view c2, Tones t, unsigned conditions) const {
+    Rewrite result;
+    if (_cells.empty()) {
+        return result;
+    }
+    auto cell = (Id(C1, c1) * _sizes[V] + Id(V, v)) * _sizes[C2] + Id(C2, c2);
+    auto outcome = _cells[cell] + static_cast<std::size_t>(t) * ConditionSets + (conditions & (ConditionSets - 1));
+    auto replacement = _replacements[_outcomes[outcome]];
+    if (replacement.v) {
+        result.v = _strings[replacement.v - 1];
+    }
+    if (replacement.c2) {
+        result.c2 = _strings[replacement.c2 - 1];
+    }
+    return result;
+}
+
+bool AutocorrectRules::MayRewrite(Part part, std::wstring_view prefix) const {
+    return _rewritesAny[part] || std::any_of(_rewritten[part].begin(), _rewritten[part].end(), [&](const auto& s) {
+               return s.starts_with(prefix);
+           });
+}
+
+} // namespace Telex
+} // namespace VietType
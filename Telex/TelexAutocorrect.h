@@ -0,0 +1,169 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "TelexEngine.h"
+
+namespace VietType {
+namespace Telex {
+
+// what Commit knows about the word besides its parts and tone, a rule may require any of them
+enum AutocorrectConditions {
+    // c1 is not empty
+    AutocorrectHasC1 = 0x1,
+    // some key went through a transition, a tone or the autocorrect instead of being typed as is (HasValidRespos)
+    AutocorrectValidRespos = 0x2,
+    // optimize_multilang is 0 or 1
+    AutocorrectMultilangLow = 0x4,
+};
+
+struct AutocorrectRule {
+    // as a pattern matches any part, as a replacement leaves the part alone
+    static constexpr std::wstring_view Any = L"*";
+    static constexpr uint8_t AllTones = 0x3f;
+
+    static constexpr uint8_t ToneBit(Tones t) {
+        return static_cast<uint8_t>(1 << static_cast<int>(t));
+    }
+
+    std::wstring_view c1 = Any;
+    std::wstring_view v = Any;
+    std::wstring_view c2 = Any;
+    // one ToneBit per tone the word may have
+    uint8_t tones = AllTones;
+    // AutocorrectConditions that must all hold
+    uint8_t conditions = 0;
+    std::wstring_view newV = Any;
+    std::wstring_view newC2 = Any;
+};
+
+/// <summary>
+/// the autocorrect of Commit as a table of rules over (c1, v, c2, tone, conditions), compiled into one matcher:
+/// each part is mapped to the index of the pattern it equals through an open-addressed table, the three indices pick
+/// a cell, and each cell holds what the rules make of every tone and set of conditions, so a lookup is the same few
+/// array reads however many rules there are;
+/// for each of v and c2 the first rule in table order that matches and rewrites it wins, everything is matched
+/// against the word as typed
+/// </summary>
+class AutocorrectRules {
+public:
+    static constexpr std::size_t MaxPartLength = 4;
+    // upper bound on the product of the pattern counts of the three parts
+    static constexpr std::size_t MaxCells = 1 << 16;
+    // every combination of AutocorrectConditions
+    static constexpr std::size_t ConditionSets = 8;
+
+    enum Part {
+        C1,
+        V,
+        C2,
+        PartCount,
+    };
+
+    struct Rewrite {
+        std::optional<std::wstring_view> v;
+        std::optional<std::wstring_view> c2;
+    };
+
+    AutocorrectRules() = default;
+
+    /// <summary>
+    /// rules that cannot be compiled are skipped and described in Issues
+    /// </summary>
+    static AutocorrectRules Compile(std::span<const AutocorrectRule> rules);
+    /// <summary>
+    /// wu -> ưu, wo -> ơ after a consonant, wuo -> ươ, ach/êch and anh/ênh typed with h alone, gn -> ng, and g -> ng
+    /// when optimize_multilang is at most 1; append to these to extend them
+    /// </summary>
+    static std::span<const AutocorrectRule> BuiltinRules();
+    /// <summary>
+    /// BuiltinRules compiled on first use, what Commit applies unless TelexConfig::autocorrect_rules is set
+    /// </summary>
+    static const AutocorrectRules& Default();
+
+    Rewrite Find(std::wstring_view c1, std::wstring_view v, std::wstring_view c2, Tones t, unsigned conditions) const;
+
+    /// <summary>
+    /// whether some rule rewrites the part (V or C2) from a string starting with prefix
+    /// </summary>
+    bool MayRewrite(Part part, std::wstring_view prefix) const;
+
+    std::size_t Count() const {
+        return _count;
+    }
+
+    const std::vector<std::wstring>& Issues() const {
+        return _issues;
+    }
+
+private:
+    // index + 1 in _strings of the new v and c2, 0 to leave the part alone
+    struct Replacement {
+        uint16_t v;
+        uint16_t c2;
+    };
+
+    // 0 if the part cannot be packed; the part goes in the low bits and a marker above the characters keeps the
+    // empty part from packing to 0
+    static constexpr uint64_t Pack(Part part, std::wstring_view s) {
+        if (s.size() > MaxPartLength) {
+            return 0;
+        }
+        uint64_t key = 1;
+        for (auto c : s) {
+            if (!c || c >= 0x8000) {
+                return 0;
+            }
+            key = (key << 15) | c;
+        }
+        return (key << 2) | part;
+    }
+
+    std::size_t Slot(uint64_t key) const {
+        return static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ull) >> _shift);
+    }
+
+    // index of the pattern the part equals, 0 if none
+    std::size_t Id(Part part, std::wstring_view s) const {
+        auto key = Pack(part, s);
+        if (!key) {
+            return 0;
+        }
+        for (auto i = Slot(key);; i = (i + 1) & (_keys.size() - 1)) {
+            if (_keys[i] == key) {
+                return _ids[i];
+            } else if (!_keys[i]) {
+                return 0;
+            }
+        }
+    }
+
+    std::size_t _count = 0;
+    // pattern count + 1 for each part
+    std::array<std::size_t, PartCount> _sizes{1, 1, 1};
+    std::vector<uint64_t> _keys;
+    std::vector<uint16_t> _ids;
+    int _shift = 64;
+    // where the outcomes of each cell start in _outcomes, cells with the same rules share them
+    std::vector<uint32_t> _cells;
+    // index in _replacements for each tone and then each set of conditions
+    std::vector<uint32_t> _outcomes;
+    std::vector<Replacement> _replacements;
+    std::vector<std::wstring> _strings;
+    // patterns of the parts each rule rewrites, and whether one rewrites any string
+    std::array<std::vector<std::wstring>, PartCount> _rewritten;
+    std::array<bool, PartCount> _rewritesAny{};
+    std::vector<std::wstring> _issues;
+};
+
+} // namespace Telex
+} // namespace VietType
@@ -0,0 +1,185 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <bit>
+#include <unordered_map>
+#include "TelexBackconvert.h"
+#include "TelexData.h"
+
+namespace VietType {
+namespace Telex {
+
+const BackconvertTable& BackconvertTable::Get() {
+    static const BackconvertTable table = Generate();
+    return table;
+}
+
+// types c1 and then the nucleus into a new engine the same way Backconvert does
+std::optional<BackconvertNucleus> BackconvertTable::Record(
+    BackconvertC1 c1, std::span<const std::wstring_view> chars, bool oaUyTone1, bool optimizeMultilang3) {
+    TelexConfig config;
+    config.oa_uy_tone1 = oaUyTone1;
+    config.optimize_multilang = optimizeMultilang3 ? 3 : 0;
+    TelexEngine e(config);
+    std::wstring_view c1keys = c1 == BackconvertC1::Q ? L"q" : c1 == BackconvertC1::Gi ? L"gi" : L"";
+    for (auto k : c1keys) {
+        e.PushChar(k);
+    }
+    auto start = e._keyBuffer.size();
+
+    BackconvertNucleus nucleus{};
+    std::array<uint8_t, BackconvertNucleus::MaxKeys> sources{};
+    auto push = [&](wchar_t k, std::size_t source) {
+        auto i = e._keyBuffer.size() - start;
+        if (i >= sources.size()) {
+            return false;
+        }
+        sources[i] = static_cast<uint8_t>(source);
+        e.PushChar(k);
+        return true;
+    };
+    for (std::size_t i = 0; i < chars.size(); i++) {
+        auto keys = chars[i];
+        auto cases = e._cases.size();
+        auto double_flag = !e._c2.size() && (e._v == L"e" || e._v == L"o");
+        if (double_flag && keys[0] == e._v[0] && !push(keys[0], i)) {
+            return std::nullopt;
+        }
+        for (auto k : keys) {
+            if (!push(k, i)) {
+                return std::nullopt;
+            }
+        }
+        for (auto b = cases; b < e._cases.size(); b++) {
+            if (nucleus.caseCount >= nucleus.caseSources.size()) {
+                return std::nullopt;
+            }
+            nucleus.caseSources[nucleus.caseCount++] = static_cast<uint8_t>(i);
+        }
+    }
+    if (e._state != TelexStates::Valid || e._c1 != c1keys || e._v.size() > BackconvertNucleus::MaxVLength) {
+        return std::nullopt;
+    }
+
+    nucleus.keyCount = static_cast<uint8_t>(e._keyBuffer.size() - start);
+    for (std::size_t i = 0; i < nucleus.keyCount; i++) {
+        const auto& cp = e._checkpoints[start + i];
+        if (cp.v.size() > BackconvertNucleus::MaxVLength) {
+            return std::nullopt;
+        }
+        auto& key = nucleus.keys[i];
+        key.v = cp.v;
+        key.casesize = cp.casesize;
+        key.respos_current = cp.respos_current;
+        key.toneCount = cp.toneCount;
+        key.t = cp.t;
+        key.key = e._keyBuffer[start + i];
+        key.source = sources[i];
+        key.respos = e._respos[start + i];
+    }
+    nucleus.v = e._v;
+    nucleus.vc2 = e._v;
+    if (c1 == BackconvertC1::Q) {
+        auto it = transitions_v_c2_q.find(std::wstring_view(e._v));
+        if (it != transitions_v_c2_q.end()) {
+            nucleus.vc2 = it->second;
+        }
+    } else {
+        auto it = transitions_v_c2.find(std::wstring_view(e._v));
+        if (it != transitions_v_c2.end()) {
+            nucleus.vc2 = it->second;
+        }
+    }
+    nucleus.respos_current = static_cast<uint8_t>(e._respos_current);
+    nucleus.toneCount = static_cast<uint8_t>(e._toneCount);
+    nucleus.t = e._t;
+    return nucleus;
+}
+
+BackconvertTable BackconvertTable::Generate() {
+    BackconvertTable table;
+    std::unordered_map<uint64_t, uint32_t> index;
+
+    constexpr std::wstring_view letters = L"abcdefghijklmnopqrstuvwxyz";
+    for (std::size_t i = 0; i < letters.size(); i++) {
+        table._charKeys[GetCharInfo(letters[i]).letter] = letters.substr(i, 1);
+    }
+    for (const auto& [c, keys] : backconversions) {
+        table._charKeys[GetCharInfo(c).letter] = keys;
+    }
+
+    auto add = [&](BackconvertC1 c1, const std::vector<std::wstring_view>& chars) {
+        // most nuclei are typed the same whatever the config, share them
+        auto first = table._nuclei.size();
+        for (bool oaUyTone1 : {false, true}) {
+            for (bool optimizeMultilang3 : {false, true}) {
+                auto key = Pack(c1, chars, oaUyTone1, optimizeMultilang3);
+                if (!key || index.contains(key)) {
+                    continue;
+                }
+                auto nucleus = Record(c1, chars, oaUyTone1, optimizeMultilang3);
+                if (!nucleus) {
+                    continue;
+                }
+                auto same = std::find(table._nuclei.begin() + first, table._nuclei.end(), *nucleus);
+                index.emplace(key, static_cast<uint32_t>(same - table._nuclei.begin()));
+                if (same == table._nuclei.end()) {
+                    table._nuclei.push_back(*nucleus);
+                }
+            }
+        }
+    };
+
+    auto keysOf = [&](wchar_t c) { return table.Decompose(c).keys; };
+    auto addV = [&](BackconvertC1 c1, std::wstring_view v) {
+        std::vector<std::wstring_view> chars;
+        for (auto c : v) {
+            chars.push_back(keysOf(c));
+        }
+        add(c1, chars);
+        for (std::size_t i = 0; i < v.size(); i++) {
+            auto tones = transitions_tones.find(v[i]);
+            if (tones == transitions_tones.end()) {
+                continue;
+            }
+            auto toned = chars;
+            for (std::size_t t = 1; t < tones->second.size(); t++) {
+                toned[i] = keysOf(tones->second[t]);
+                add(c1, toned);
+            }
+        }
+    };
+    for (const auto& [v, vinfo] : valid_v) {
+        addV(BackconvertC1::Other, v);
+    }
+    for (const auto& [v, vinfo] : valid_v_oa_uy) {
+        addV(BackconvertC1::Other, v);
+    }
+    for (const auto& [v, vinfo] : valid_v_q) {
+        addV(BackconvertC1::Q, v);
+    }
+    for (const auto& [v, vinfo] : valid_v_gi) {
+        addV(BackconvertC1::Gi, v);
+    }
+    // words without a vowel, and the tone of a 'gi' without one
+    add(BackconvertC1::Other, {});
+    add(BackconvertC1::Q, {});
+    for (auto t : std::wstring_view(L"fjrsx")) {
+        add(BackconvertC1::Gi, {letters.substr(t - L'a', 1)});
+    }
+
+    table._slots.assign(std::bit_ceil(index.size() * 2), Slot{});
+    auto mask = table._slots.size() - 1;
+    for (const auto& [key, i] : index) {
+        auto slot = Mix(key) & mask;
+        while (table._slots[slot].key) {
+            slot = (slot + 1) & mask;
+        }
+        table._slots[slot] = Slot{key, i};
+    }
+    return table;
+}
+
+} // namespace Telex
+} // namespace VietType
@@ -0,0 +1,179 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "TelexBuffers.h"
+#include "TelexChars.h"
+#include "TelexEngine.h"
+
+namespace VietType {
+namespace Telex {
+
+// what FindTable looks at in c1
+enum class BackconvertC1 : uint8_t {
+    Other,
+    Q,
+    Gi,
+};
+
+struct BackconvertChar {
+    // lowercase, empty if the character is not a letter Backconvert knows
+    std::wstring_view keys;
+    bool upper;
+};
+
+/// <summary>
+/// what pushing the keys of a vowel nucleus leaves in a Valid word, recorded from a real engine;
+/// positions and counts are relative to the c1 the nucleus was recorded after,
+/// which is empty unless c1 decides the vowel table ("q" or "gi")
+/// </summary>
+struct BackconvertNucleus {
+    static constexpr std::size_t MaxChars = 4;
+    static constexpr std::size_t MaxKeys = 8;
+    // longer than any v, transitions undo themselves before v gets there
+    static constexpr std::size_t MaxVLength = 4;
+
+    struct Key {
+        // checkpoint before the key
+        InlineString<MaxVLength> v;
+        uint8_t casesize;
+        uint8_t respos_current;
+        uint8_t toneCount;
+        Tones t;
+        // lowercase
+        wchar_t key;
+        // index of the nucleus character the key was typed for, which gives it its case
+        uint8_t source;
+        uint16_t respos;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    std::array<Key, MaxKeys> keys;
+    uint8_t keyCount;
+    // nucleus character of every case pushed
+    std::array<uint8_t, MaxVLength> caseSources;
+    uint8_t caseCount;
+    InlineString<MaxVLength> v;
+    // v once c2 is started, see transitions_v_c2
+    InlineString<MaxVLength> vc2;
+    uint8_t respos_current;
+    uint8_t toneCount;
+    Tones t;
+
+    bool operator==(const BackconvertNucleus&) const = default;
+};
+
+/// <summary>
+/// the nucleus of every syllable in the valid_v tables, untoned and with each tone on each of its characters,
+/// for each c1 that changes how the nucleus is typed and each config that changes it (oa_uy_tone1, and
+/// optimize_multilang 3 or up);
+/// a nucleus is given as the backconversion keys of its characters, a toned 'i' of "gi" counts as a character
+/// holding only its tone key; generated on first use
+/// </summary>
+class BackconvertTable {
+public:
+    static const BackconvertTable& Get();
+    static BackconvertTable Generate();
+
+    /// <summary>
+    /// the keys Backconvert types for a character, the same as the backconversions table gives
+    /// </summary>
+    BackconvertChar Decompose(wchar_t c) const {
+        auto info = GetCharInfo(c);
+        return {_charKeys[info.letter], info.caseDelta > 0};
+    }
+
+    const BackconvertNucleus* Find(
+        BackconvertC1 c1, std::span<const std::wstring_view> chars, bool oaUyTone1, bool optimizeMultilang3) const {
+        auto key = Pack(c1, chars, oaUyTone1, optimizeMultilang3);
+        if (!key || _slots.empty()) {
+            return nullptr;
+        }
+        auto mask = _slots.size() - 1;
+        for (auto i = Mix(key) & mask;; i = (i + 1) & mask) {
+            if (_slots[i].key == key) {
+                return &_nuclei[_slots[i].index];
+            } else if (!_slots[i].key) {
+                return nullptr;
+            }
+        }
+    }
+
+    /// <summary>
+    /// nuclei looked up by a different key can share an entry
+    /// </summary>
+    std::size_t Count() const {
+        return _nuclei.size();
+    }
+
+private:
+    BackconvertTable() = default;
+
+    static std::optional<BackconvertNucleus> Record(
+        BackconvertC1 c1, std::span<const std::wstring_view> chars, bool oaUyTone1, bool optimizeMultilang3);
+
+    struct Slot {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    static constexpr std::array<uint8_t, 26> keyCodes = [] {
+        std::array<uint8_t, 26> codes{};
+        std::wstring_view alphabet = L"aeiouywfjrsx";
+        for (std::size_t i = 0; i < alphabet.size(); i++) {
+            codes[alphabet[i] - L'a'] = static_cast<uint8_t>(i + 1);
+        }
+        return codes;
+    }();
+
+    // 4 bits per key, 2 bits of key count per character; 0 if the nucleus cannot be in the table
+    static constexpr uint64_t Pack(
+        BackconvertC1 c1, std::span<const std::wstring_view> chars, bool oaUyTone1, bool optimizeMultilang3) {
+        if (chars.size() > BackconvertNucleus::MaxChars) {
+            return 0;
+        }
+        // the top bit keeps every key from packing to 0
+        uint64_t key = 1;
+        uint64_t counts = 0;
+        std::size_t nkeys = 0;
+        for (auto keys : chars) {
+            if (keys.empty() || keys.size() > 3) {
+                return 0;
+            }
+            counts = (counts << 2) | keys.size();
+            for (auto k : keys) {
+                if (k < L'a' || k > L'z' || !keyCodes[k - L'a'] || ++nkeys > BackconvertNucleus::MaxKeys) {
+                    return 0;
+                }
+                key = (key << 4) | keyCodes[k - L'a'];
+            }
+        }
+        key = (key << 8) | counts;
+        return (((key << 2) | static_cast<uint64_t>(c1)) << 2) | (uint64_t(oaUyTone1) << 1) | optimizeMultilang3;
+    }
+
+    static constexpr std::size_t Mix(uint64_t key) {
+        key ^= key >> 31;
+        key *= 0x9e3779b97f4a7c15ull;
+        key ^= key >> 29;
+        return static_cast<std::size_t>(key);
+    }
+
+    // indexed by CharInfo::letter, empty for anything else
+    std::array<std::wstring_view, CharLetterCount> _charKeys;
+    std::vector<BackconvertNucleus> _nuclei;
+    // open addressing, a power of two at most half full
+    std::vector<Slot> _slots;
+};
+
+} // namespace Telex
+} // namespace VietType
@@ -0,0 +1,344 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace VietType {
+namespace Telex {
+
+// fixed-capacity containers used for per-word engine state
+// none of these ever allocate, and all of them are trivially copyable
+
+/// <summary>
+/// fixed-capacity wide string stored inline;
+/// pushing past the capacity is a logic error and is ignored in release builds
+/// </summary>
+template <size_t N>
+class InlineString {
+    static_assert(N > 0 && N <= UINT16_MAX);
+
+public:
+    using value_type = wchar_t;
+    using size_type = size_t;
+    using iterator = wchar_t*;
+    using const_iterator = const wchar_t*;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    constexpr InlineString() = default;
+    constexpr InlineString(std::wstring_view s) {
+        assign(s);
+    }
+    constexpr InlineString& operator=(std::wstring_view s) {
+        assign(s);
+        return *this;
+    }
+
+    constexpr void assign(std::wstring_view s) {
+        assert(s.size() <= N);
+        _size = static_cast<uint16_t>(s.size() < N ? s.size() : N);
+        for (size_t i = 0; i < _size; i++) {
+            _data[i] = s[i];
+        }
+    }
+
+    static constexpr size_type capacity() {
+        return N;
+    }
+    constexpr size_type size() const {
+        return _size;
+    }
+    constexpr size_type length() const {
+        return _size;
+    }
+    constexpr bool empty() const {
+        return !_size;
+    }
+
+    constexpr void clear() {
+        _size = 0;
+    }
+    constexpr void push_back(wchar_t c) {
+        assert(_size < N);
+        if (_size < N) {
+            _data[_size++] = c;
+        }
+    }
+    constexpr void pop_back() {
+        assert(_size > 0);
+        _size--;
+    }
+    constexpr void append(std::wstring_view s) {
+        for (auto c : s) {
+            push_back(c);
+        }
+    }
+    constexpr void resize(size_type size) {
+        assert(size <= _size);
+        _size = static_cast<uint16_t>(size);
+    }
+
+    constexpr wchar_t& operator[](size_type i) {
+        assert(i < _size);
+        return _data[i];
+    }
+    constexpr const wchar_t& operator[](size_type i) const {
+        assert(i < _size);
+        return _data[i];
+    }
+    constexpr wchar_t& back() {
+        return (*this)[_size - 1];
+    }
+    constexpr const wchar_t& back() const {
+        return (*this)[_size - 1];
+    }
+
+    constexpr const wchar_t* data() const {
+        return _data.data();
+    }
+    constexpr iterator begin() {
+        return _data.data();
+    }
+    constexpr iterator end() {
+        return _data.data() + _size;
+    }
+    constexpr const_iterator begin() const {
+        return _data.data();
+    }
+    constexpr const_iterator end() const {
+        return _data.data() + _size;
+    }
+    constexpr const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+    constexpr const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+
+    constexpr operator std::wstring_view() const {
+        return std::wstring_view(_data.data(), _size);
+    }
+
+    friend constexpr bool operator==(const InlineString& lhs, std::wstring_view rhs) {
+        return std::wstring_view(lhs) == rhs;
+    }
+
+private:
+    // only the first _size characters are ever read, so the rest is left uninitialized
+    std::array<wchar_t, N> _data;
+    uint16_t _size = 0;
+};
+
+/// <summary>
+/// fixed-capacity vector of trivially copyable elements stored inline
+/// </summary>
+template <typename T, size_t N>
+class InlineVector {
+    static_assert(std::is_trivially_copyable_v<T>);
+    static_assert(N > 0 && N <= UINT16_MAX);
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static constexpr size_type capacity() {
+        return N;
+    }
+    constexpr size_type size() const {
+        return _size;
+    }
+    constexpr bool empty() const {
+        return !_size;
+    }
+
+    constexpr void clear() {
+        _size = 0;
+    }
+    constexpr void push_back(const T& value) {
+        assert(_size < N);
+        if (_size < N) {
+            _data[_size++] = value;
+        }
+    }
+    constexpr void pop_back() {
+        assert(_size > 0);
+        _size--;
+    }
+    constexpr void resize(size_type size) {
+        assert(size <= _size);
+        _size = static_cast<uint16_t>(size);
+    }
+
+    constexpr T& operator[](size_type i) {
+        assert(i < _size);
+        return _data[i];
+    }
+    constexpr const T& operator[](size_type i) const {
+        assert(i < _size);
+        return _data[i];
+    }
+    constexpr T& back() {
+        return (*this)[_size - 1];
+    }
+    constexpr const T& back() const {
+        return (*this)[_size - 1];
+    }
+
+    constexpr iterator begin() {
+        return _data.data();
+    }
+    constexpr iterator end() {
+        return _data.data() + _size;
+    }
+    constexpr const_iterator begin() const {
+        return _data.data();
+    }
+    constexpr const_iterator end() const {
+        return _data.data() + _size;
+    }
+    constexpr const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+    constexpr const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+
+private:
+    std::array<T, N> _data;
+    uint16_t _size = 0;
+};
+
+/// <summary>
+/// sequence of up to 32 case bits packed into a single word;
+/// 1 = uppercase, 0 = lowercase
+/// </summary>
+class CaseMask {
+public:
+    using size_type = size_t;
+
+    static constexpr size_type capacity() {
+        return 32;
+    }
+    constexpr size_type size() const {
+        return _size;
+    }
+    constexpr bool empty() const {
+        return !_size;
+    }
+    constexpr uint32_t bits() const {
+        return _bits;
+    }
+
+    constexpr void clear() {
+        _bits = 0;
+        _size = 0;
+    }
+    constexpr void push_back(bool upper) {
+        assert(_size < capacity());
+        if (_size < capacity()) {
+            _bits |= static_cast<uint32_t>(upper) << _size;
+            _size++;
+        }
+    }
+    constexpr void resize(size_type size) {
+        assert(size <= _size);
+        _size = static_cast<uint8_t>(size);
+        _bits &= LowMask(_size);
+    }
+    /// <summary>removes the bit at position i, shifting down the bits above it</summary>
+    constexpr void erase(size_type i) {
+        assert(i < _size);
+        auto low = _bits & LowMask(i);
+        auto high = (_bits >> 1) & ~LowMask(i);
+        _bits = low | high;
+        _size--;
+    }
+
+    /// <summary>inserts a bit at position i, shifting up the bits from i</summary>
+    constexpr void insert(size_type i, bool upper) {
+        assert(i <= _size && _size < capacity());
+        if (_size < capacity()) {
+            auto low = _bits & LowMask(i);
+            auto high = (_bits & ~LowMask(i)) << 1;
+            _bits = low | (static_cast<uint32_t>(upper) << i) | high;
+            _size++;
+        }
+    }
+
+    constexpr bool operator[](size_type i) const {
+        assert(i < _size);
+        return (_bits >> i) & 1;
+    }
+    constexpr bool back() const {
+        return (*this)[_size - 1u];
+    }
+
+private:
+    static constexpr uint32_t LowMask(size_type n) {
+        return n >= 32 ? ~uint32_t{0} : (uint32_t{1} << n) - 1;
+    }
+
+    uint32_t _bits = 0;
+    uint8_t _size = 0;
+};
+
+/// <summary>
+/// writes into a buffer owned by the caller, dropping what does not fit but still counting it
+/// </summary>
+class SpanWriter {
+public:
+    constexpr explicit SpanWriter(std::span<wchar_t> buffer) : _buffer(buffer) {
+    }
+
+    /// <summary>the full length, including what did not fit</summary>
+    constexpr size_t size() const {
+        return _size;
+    }
+    /// <summary>the part that fit</summary>
+    constexpr std::span<wchar_t> written() const {
+        return _buffer.first(std::min(_size, _buffer.size()));
+    }
+
+    constexpr void push_back(wchar_t c) {
+        if (_size < _buffer.size()) {
+            _buffer[_size] = c;
+        }
+        _size++;
+    }
+    constexpr void append(std::wstring_view s) {
+        if (_size < _buffer.size()) {
+            std::copy_n(s.begin(), std::min(s.size(), _buffer.size() - _size), _buffer.begin() + _size);
+        }
+        _size += s.size();
+    }
+    /// <summary>overwrites the character at i if it fit</summary>
+    constexpr void overwrite(size_t i, wchar_t c) {
+        assert(i < _size);
+        if (i < _buffer.size()) {
+            _buffer[i] = c;
+        }
+    }
+
+private:
+    std::span<wchar_t> _buffer;
+    size_t _size = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<InlineString<1>>);
+static_assert(std::is_trivially_copyable_v<InlineVector<uint16_t, 1>>);
+static_assert(std::is_trivially_copyable_v<CaseMask>);
+
+} // namespace Telex
+} // namespace VietType
@@ -0,0 +1,251 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include "TelexCase.h"
+#include "TelexChars.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define VIETTYPE_CASE_AVX2
+#define VIETTYPE_CASE_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VIETTYPE_CASE_SSE2
+#endif
+
+namespace VietType {
+namespace Telex {
+
+// each instruction set gives the same handful of 16-bit lane operations, the kernels below are written once on top
+
+#ifdef VIETTYPE_CASE_SSE2
+struct CaseSse2 {
+    using V = __m128i;
+    static constexpr std::size_t Lanes = 8;
+
+    static V Load(const void* p) {
+        return _mm_loadu_si128(static_cast<const __m128i*>(p));
+    }
+    static void Store(void* p, V v) {
+        _mm_storeu_si128(static_cast<__m128i*>(p), v);
+    }
+    static V Set(uint16_t x) {
+        return _mm_set1_epi16(static_cast<short>(x));
+    }
+    static V And(V a, V b) {
+        return _mm_and_si128(a, b);
+    }
+    // ~a & b
+    static V AndNot(V a, V b) {
+        return _mm_andnot_si128(a, b);
+    }
+    static V Or(V a, V b) {
+        return _mm_or_si128(a, b);
+    }
+    // lanes of x between lo and lo + span inclusive
+    static V InRange(V x, uint16_t lo, uint16_t span) {
+        return _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(x, Set(lo)), Set(span)), _mm_setzero_si128());
+    }
+    // lane i is set if bit i of m is
+    static V LaneMask(uint32_t m) {
+        auto lanes = _mm_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128);
+        return _mm_cmpeq_epi16(_mm_and_si128(Set(static_cast<uint16_t>(m)), lanes), lanes);
+    }
+};
+#endif
+
+#ifdef VIETTYPE_CASE_AVX2
+struct CaseAvx2 {
+    using V = __m256i;
+    static constexpr std::size_t Lanes = 16;
+
+    static V Load(const void* p) {
+        return _mm256_loadu_si256(static_cast<const __m256i*>(p));
+    }
+    static void Store(void* p, V v) {
+        _mm256_storeu_si256(static_cast<__m256i*>(p), v);
+    }
+    static V Set(uint16_t x) {
+        return _mm256_set1_epi16(static_cast<short>(x));
+    }
+    static V And(V a, V b) {
+        return _mm256_and_si256(a, b);
+    }
+    static V AndNot(V a, V b) {
+        return _mm256_andnot_si256(a, b);
+    }
+    static V Or(V a, V b) {
+        return _mm256_or_si256(a, b);
+    }
+    static V InRange(V x, uint16_t lo, uint16_t span) {
+        return _mm256_cmpeq_epi16(
+            _mm256_subs_epu16(_mm256_sub_epi16(x, Set(lo)), Set(span)), _mm256_setzero_si256());
+    }
+    static V LaneMask(uint32_t m) {
+        auto lanes = _mm256_setr_epi16(
+            1, 2, 4, 8, 16, 32, 64, 128, 0x100, 0x200, 0x400, 0x800, 0x1000, 0x2000, 0x4000, static_cast<short>(0x8000));
+        return _mm256_cmpeq_epi16(_mm256_and_si256(Set(static_cast<uint16_t>(m)), lanes), lanes);
+    }
+};
+#endif
+
+// the ranges of ToUpperRule and ToLowerRule: Basic Latin and Latin-1 Supplement letters change bit 5,
+// Latin Extended-A/B and Latin Extended Additional letters change bit 0, except for the "uw" pair
+
+template <typename Ops>
+static typename Ops::V UpperLanes(typename Ops::V x) {
+    auto uw = Ops::InRange(x, 0x1af, 1);
+    auto bit5 = Ops::Or(Ops::InRange(Ops::AndNot(Ops::Set(32), x), L'A', 25), Ops::InRange(x, 0xe0, 0xfe - 0xe0));
+    auto bit0 = Ops::Or(
+        Ops::AndNot(uw, Ops::InRange(x, 0x100, 0x1bf - 0x100)), Ops::InRange(x, 0x1ea0, 0x1ef9 - 0x1ea0));
+    auto clear = Ops::Or(Ops::And(bit5, Ops::Set(32)), Ops::And(bit0, Ops::Set(1)));
+    auto result = Ops::AndNot(clear, x);
+    return Ops::Or(Ops::And(uw, Ops::Set(0x1af)), Ops::AndNot(uw, result));
+}
+
+template <typename Ops>
+static typename Ops::V LowerLanes(typename Ops::V x) {
+    auto uw = Ops::InRange(x, 0x1af, 1);
+    auto bit5 = Ops::Or(Ops::InRange(Ops::Or(Ops::Set(32), x), L'a', 25), Ops::InRange(x, 0xc0, 0xde - 0xc0));
+    auto bit0 = Ops::Or(
+        Ops::AndNot(uw, Ops::InRange(x, 0x100, 0x1bf - 0x100)), Ops::InRange(x, 0x1ea0, 0x1ef9 - 0x1ea0));
+    auto set = Ops::Or(Ops::And(bit5, Ops::Set(32)), Ops::And(bit0, Ops::Set(1)));
+    auto result = Ops::Or(set, x);
+    return Ops::Or(Ops::And(uw, Ops::Set(0x1b0)), Ops::AndNot(uw, result));
+}
+
+// the kernels work through whole vectors and return where they stopped
+
+template <typename Ops, typename Char>
+static std::size_t UpperBlocks(Char* s, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + Ops::Lanes <= n; i += Ops::Lanes) {
+        Ops::Store(s + i, UpperLanes<Ops>(Ops::Load(s + i)));
+    }
+    return i;
+}
+
+template <typename Ops, typename Char>
+static std::size_t LowerBlocks(Char* s, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + Ops::Lanes <= n; i += Ops::Lanes) {
+        Ops::Store(s + i, LowerLanes<Ops>(Ops::Load(s + i)));
+    }
+    return i;
+}
+
+// start must be a multiple of Ops::Lanes so that no vector straddles two mask words
+template <typename Ops, typename Char>
+static std::size_t CaseBitsBlocks(Char* s, std::size_t start, std::size_t n, std::span<const uint64_t> bits) {
+    assert(start % Ops::Lanes == 0);
+    constexpr uint64_t laneBits = (uint64_t(1) << Ops::Lanes) - 1;
+    auto i = start;
+    for (; i + Ops::Lanes <= n; i += Ops::Lanes) {
+        auto m = static_cast<uint32_t>((bits[i / 64] >> (i % 64)) & laneBits);
+        // mostly lowercase text skips the vector entirely
+        if (!m) {
+            continue;
+        }
+        auto x = Ops::Load(s + i);
+        auto sel = Ops::LaneMask(m);
+        Ops::Store(s + i, Ops::Or(Ops::And(sel, UpperLanes<Ops>(x)), Ops::AndNot(sel, x)));
+    }
+    return i;
+}
+
+template <typename Char>
+static void UpperRun(Char* s, std::size_t n) {
+    std::size_t i = 0;
+    if constexpr (sizeof(Char) == 2) {
+#ifdef VIETTYPE_CASE_AVX2
+        i = UpperBlocks<CaseAvx2>(s, n);
+#endif
+#ifdef VIETTYPE_CASE_SSE2
+        i += UpperBlocks<CaseSse2>(s + i, n - i);
+#endif
+    }
+    for (; i < n; i++) {
+        s[i] = static_cast<Char>(ToUpper(static_cast<wchar_t>(s[i])));
+    }
+}
+
+template <typename Char>
+static void LowerRun(Char* s, std::size_t n) {
+    std::size_t i = 0;
+    if constexpr (sizeof(Char) == 2) {
+#ifdef VIETTYPE_CASE_AVX2
+        i = LowerBlocks<CaseAvx2>(s, n);
+#endif
+#ifdef VIETTYPE_CASE_SSE2
+        i += LowerBlocks<CaseSse2>(s + i, n - i);
+#endif
+    }
+    for (; i < n; i++) {
+        s[i] = static_cast<Char>(ToLower(static_cast<wchar_t>(s[i])));
+    }
+}
+
+template <typename Char>
+static void CaseBitsRun(Char* s, std::size_t n, std::span<const uint64_t> bits) {
+    assert(bits.size() * 64 >= n);
+    std::size_t i = 0;
+    if constexpr (sizeof(Char) == 2) {
+#ifdef VIETTYPE_CASE_AVX2
+        i = CaseBitsBlocks<CaseAvx2>(s, i, n, bits);
+#endif
+#ifdef VIETTYPE_CASE_SSE2
+        i = CaseBitsBlocks<CaseSse2>(s, i, n, bits);
+#endif
+    }
+    // the tail only visits the set bits
+    for (; i < n; i = (i / 64 + 1) * 64) {
+        auto end = std::min(n, (i / 64 + 1) * 64);
+        for (auto word = bits[i / 64] >> (i % 64); word; word &= word - 1) {
+            auto j = i + std::countr_zero(word);
+            if (j >= end) {
+                break;
+            }
+            s[j] = static_cast<Char>(ToUpper(static_cast<wchar_t>(s[j])));
+        }
+    }
+}
+
+const wchar_t* CaseKernelName() {
+#if defined(VIETTYPE_CASE_AVX2)
+    return L"avx2";
+#elif defined(VIETTYPE_CASE_SSE2)
+    return L"sse2";
+#else
+    return L"scalar";
+#endif
+}
+
+void ToUpperRun(std::span<char16_t> s) {
+    UpperRun(s.data(), s.size());
+}
+
+void ToUpperRun(std::span<wchar_t> s) {
+    UpperRun(s.data(), s.size());
+}
+
+void ToLowerRun(std::span<char16_t> s) {
+    LowerRun(s.data(), s.size());
+}
+
+void ToLowerRun(std::span<wchar_t> s) {
+    LowerRun(s.data(), s.size());
+}
+
+void ApplyCaseBits(std::span<char16_t> s, std::span<const uint64_t> bits) {
+    CaseBitsRun(s.data(), s.size(), bits);
+}
+
+void ApplyCaseBits(std::span<wchar_t> s, std::span<const uint64_t> bits) {
+    CaseBitsRun(s.data(), s.size(), bits);
+}
+
+} // namespace Telex
+} // namespace VietType
@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace VietType {
+namespace Telex {
+
+// Case mapping of whole runs of text, giving exactly what ToUpper and ToLower give for every character.
+// The UTF-16 kernels use AVX2 when the compiler targets it, SSE2 on any other x86 target and plain loops elsewhere;
+// runs of 32-bit wchar_t always take the plain loops.
+
+/// <summary>
+/// name of the instruction set the UTF-16 kernels were built for: "avx2", "sse2" or "scalar"
+/// </summary>
+const wchar_t* CaseKernelName();
+
+/// <summary>
+/// ToUpper every character in place
+/// </summary>
+void ToUpperRun(std::span<char16_t> s);
+void ToUpperRun(std::span<wchar_t> s);
+
+/// <summary>
+/// ToLower every character in place
+/// </summary>
+void ToLowerRun(std::span<char16_t> s);
+void ToLowerRun(std::span<wchar_t> s);
+
+/// <summary>
+/// ToUpper the characters whose bit is set, s[i] goes with bit i % 64 of bits[i / 64]; the rest are left alone
+/// </summary>
+/// <param name="bits">at least (s.size() + 63) / 64 words</param>
+void ApplyCaseBits(std::span<char16_t> s, std::span<const uint64_t> bits);
+void ApplyCaseBits(std::span<wchar_t> s, std::span<const uint64_t> bits);
+
+} // namespace Telex
+} // namespace VietType
@@ -0,0 +1,218 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace VietType {
+namespace Telex {
+
+enum class CharTypes : unsigned int {
+    Uncategorized = 0,
+    Vowel = 1 << 3,
+    VowelW = 1 << 4,
+    Conso = 1 << 5,
+    ConsoC1 = 1 << 5 | 1 << 6,
+    ConsoC2 = 1 << 5 | 1 << 7,
+    ConsoContinue = 1 << 5 | 1 << 8,
+    Tone = 1 << 9,
+};
+
+constexpr CharTypes operator|(CharTypes lhs, CharTypes rhs) {
+    return static_cast<CharTypes>(static_cast<unsigned int>(lhs) | static_cast<unsigned int>(rhs));
+}
+
+constexpr CharTypes operator&(CharTypes lhs, CharTypes rhs) {
+    return static_cast<CharTypes>(static_cast<unsigned int>(lhs) & static_cast<unsigned int>(rhs));
+}
+
+constexpr CharTypes letterClasses[26] = {
+    CharTypes::Vowel,                                                // a
+    CharTypes::ConsoC1,                                              // b
+    CharTypes::ConsoC1 | CharTypes::ConsoC2,                         // c
+    CharTypes::ConsoC1 | CharTypes::ConsoContinue,                   // d
+    CharTypes::Vowel,                                                // e
+    CharTypes::Tone,                                                 // f
+    CharTypes::ConsoC1 | CharTypes::ConsoContinue,                   // g
+    CharTypes::ConsoC1 | CharTypes::ConsoContinue,                   // h
+    CharTypes::Vowel,                                                // i
+    CharTypes::Tone,                                                 // j
+    CharTypes::ConsoC1,                                              // k
+    CharTypes::ConsoC1,                                              // l
+    CharTypes::ConsoC1 | CharTypes::ConsoC2,                         // m
+    CharTypes::ConsoC1 | CharTypes::ConsoC2,                         // n
+    CharTypes::Vowel,                                                // o
+    CharTypes::ConsoC1 | CharTypes::ConsoC2,                         // p
+    CharTypes::ConsoC1,                                              // q
+    CharTypes::Tone | CharTypes::ConsoC1 | CharTypes::ConsoContinue, // r
+    CharTypes::Tone | CharTypes::ConsoC1 | CharTypes::ConsoContinue, // s
+    CharTypes::ConsoC1 | CharTypes::ConsoC2,                         // t
+    CharTypes::Vowel,                                                // u
+    CharTypes::ConsoC1,                                              // v
+    CharTypes::VowelW,                                               // w
+    CharTypes::Tone | CharTypes::ConsoC1,                            // x
+    CharTypes::Vowel,                                                // y
+    CharTypes::Tone,                                                 // z
+};
+
+// the lowercase Vietnamese letters outside a-z, in code order
+constexpr std::array<wchar_t, 67> vietnameseLetters = [] {
+    std::array<wchar_t, 67> letters{
+        L'\xe0',  L'\xe1',  L'\xe2',  L'\xe3',  L'\xe8',  L'\xe9',  L'\xea',  L'\xec',  L'\xed',  L'\xf2',  L'\xf3',
+        L'\xf4',  L'\xf5',  L'\xf9',  L'\xfa',  L'\xfd',  L'\x103', L'\x111', L'\x129', L'\x169', L'\x1a1', L'\x1b0',
+    };
+    // Latin Extended Additional alternates upper and lower
+    for (std::size_t i = 22; i < letters.size(); i++) {
+        letters[i] = static_cast<wchar_t>(L'\x1ea1' + 2 * (i - 22));
+    }
+    return letters;
+}();
+
+// case rules the character table is built from, they hardcode ranges of Vietnamese characters
+// the rest can be correctly transformed or not, doesn't matter
+
+constexpr wchar_t ToUpperRule(wchar_t c) {
+    wchar_t uc = c & ~32;
+    // Basic Latin
+    if (uc >= L'A' && uc <= L'Z') {
+        return uc;
+    }
+    // Latin-1 Supplement
+    if (c >= L'\xe0' && c <= L'\xfe') {
+        return uc;
+    }
+    // "uw" exception
+    if (c >= L'\x1af' && c <= L'\x1b0') {
+        return L'\x1af';
+    }
+    uc = c & ~1;
+    // Latin Extended-A/B
+    if (c >= L'\x100' && c <= L'\x1bf') {
+        return uc;
+    }
+    // Latin Extended Additional
+    if (c >= L'\x1ea0' && c <= L'\x1ef9') {
+        return uc;
+    }
+    return c;
+}
+
+constexpr wchar_t ToLowerRule(wchar_t c) {
+    wchar_t lc = c | 32;
+    // Basic Latin
+    if (lc >= L'a' && lc <= L'z') {
+        return lc;
+    }
+    // Latin-1 Supplement
+    if (c >= L'\xc0' && c <= L'\xde') {
+        return lc;
+    }
+    // "uw" exception
+    if (c >= L'\x1af' && c <= L'\x1b0') {
+        return L'\x1b0';
+    }
+    lc = c | 1;
+    // Latin Extended-A/B
+    if (c >= L'\x100' && c <= L'\x1bf') {
+        return lc;
+    }
+    // Latin Extended Additional
+    if (c >= L'\x1ea0' && c <= L'\x1ef9') {
+        return lc;
+    }
+    return c;
+}
+
+struct CharInfo {
+    // CharTypes of a lowercase a-z key, Uncategorized for anything else
+    uint16_t types;
+    // added to the character to change its case: negative if it is lowercase, positive if it is uppercase
+    int8_t caseDelta;
+    // 1-26 for a-z then 27 onwards for vietnameseLetters, the same in both cases; 0 if not a Vietnamese letter
+    uint8_t letter;
+};
+static_assert(sizeof(CharInfo) == 4);
+
+constexpr std::size_t CharLetterCount = 27 + vietnameseLetters.size();
+
+/// <summary>
+/// classification of every BMP code unit, a page index then a 256-entry block;
+/// the pages outside charTablePages share the empty block 0
+/// </summary>
+struct CharTable {
+    static constexpr std::array<uint16_t, 3> charTablePages = {0x00, 0x01, 0x1e};
+
+    std::array<uint8_t, 256> pages;
+    std::array<std::array<CharInfo, 256>, 1 + charTablePages.size()> blocks;
+};
+
+constexpr CharTable charTable = [] {
+    CharTable table{};
+    for (std::size_t b = 0; b < CharTable::charTablePages.size(); b++) {
+        auto page = CharTable::charTablePages[b];
+        table.pages[page] = static_cast<uint8_t>(b + 1);
+        for (unsigned int low = 0; low < 256; low++) {
+            auto c = static_cast<wchar_t>(page << 8 | low);
+            auto& info = table.blocks[b + 1][low];
+            auto uc = ToUpperRule(c);
+            auto lc = ToLowerRule(c);
+            if (uc != c && lc != c) {
+                throw "a character cannot change case both ways";
+            }
+            info.caseDelta = static_cast<int8_t>(uc != c ? uc - c : lc - c);
+            if (c >= L'a' && c <= L'z') {
+                info.types = static_cast<uint16_t>(letterClasses[c - L'a']);
+            }
+        }
+    }
+    auto setLetter = [&](wchar_t lc, std::size_t letter) {
+        for (auto c : {lc, ToUpperRule(lc)}) {
+            table.blocks[table.pages[c >> 8]][c & 0xff].letter = static_cast<uint8_t>(letter);
+        }
+    };
+    for (wchar_t c = L'a'; c <= L'z'; c++) {
+        setLetter(c, c - L'a' + 1);
+    }
+    for (std::size_t i = 0; i < vietnameseLetters.size(); i++) {
+        setLetter(vietnameseLetters[i], 27 + i);
+    }
+    return table;
+}();
+
+inline CharInfo GetCharInfo(_In_ wchar_t c) {
+    if constexpr (sizeof(wchar_t) > 2) {
+        if (static_cast<uint32_t>(c) > 0xffff) {
+            return CharInfo{};
+        }
+    }
+    auto u = static_cast<uint16_t>(c);
+    return charTable.blocks[charTable.pages[u >> 8]][u & 0xff];
+}
+
+// case functions only cover the Vietnamese ranges
+inline wchar_t ToUpper(_In_ wchar_t c) {
+    auto delta = GetCharInfo(c).caseDelta;
+    return delta < 0 ? static_cast<wchar_t>(c + delta) : c;
+}
+
+inline wchar_t ToLower(_In_ wchar_t c) {
+    auto delta = GetCharInfo(c).caseDelta;
+    return delta > 0 ? static_cast<wchar_t>(c + delta) : c;
+}
+
+inline CharTypes ClassifyCharacter(_In_ wchar_t lc) {
+    return static_cast<CharTypes>(GetCharInfo(lc).types);
+}
+
+/// <summary>
+/// a-z, A-Z and every precomposed Vietnamese letter in either case
+/// </summary>
+inline bool IsVietnameseLetter(_In_ wchar_t c) {
+    return GetCharInfo(c).letter != 0;
+}
+
+} // namespace Telex
+} // namespace VietType
@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "TelexConvert.h"
+
+namespace VietType {
+namespace Telex {
+
+TextConverter::TextConverter(const TelexConfig& config) : _engine(config) {
+}
+
+void TextConverter::EndWord(std::wstring& output) {
+    if (_inWord && !_passthrough) {
+        _engine.Commit();
+        std::array<wchar_t, MaxOutputLength> buf;
+        output.append(buf.data(), _engine.Retrieve(buf));
+    }
+    _inWord = false;
+    _passthrough = false;
+}
+
+void TextConverter::Push(std::wstring_view input, std::wstring& output) {
+    for (auto c : input) {
+        if (IsSeparatorCharacter(c)) {
+            EndWord(output);
+            output.push_back(c);
+        } else if (_passthrough) {
+            output.push_back(c);
+        } else {
+            if (!_inWord) {
+                _engine.Reset();
+                _inWord = true;
+            }
+            // once the word is Invalid the rest of the keys would only be appended to it
+            if (_engine.PushChar(c) != TelexStates::Valid) {
+                EndWord(output);
+                _inWord = true;
+                _passthrough = true;
+            }
+        }
+    }
+}
+
+void TextConverter::Flush(std::wstring& output) {
+    EndWord(output);
+}
+
+std::wstring ConvertText(const TelexConfig& config, std::wstring_view input, unsigned int threads, size_t chunkLength) {
+    // cut the input into chunks ending right before a separator
+    std::vector<std::wstring_view> chunks;
+    for (size_t start = 0; start < input.size();) {
+        auto end = std::min(start + std::max(chunkLength, size_t{1}), input.size());
+        while (end < input.size() && !IsSeparatorCharacter(input[end])) {
+            end++;
+        }
+        chunks.push_back(input.substr(start, end - start));
+        start = end;
+    }
+
+    if (!threads) {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    threads = static_cast<unsigned int>(std::min(size_t{threads}, chunks.size()));
+
+    std::wstring result;
+    result.reserve(input.size());
+    if (threads <= 1) {
+        TextConverter converter(config);
+        for (auto chunk : chunks) {
+            converter.Push(chunk, result);
+        }
+        converter.Flush(result);
+        return result;
+    }
+
+    // workers pull chunks in order and this thread appends each output once the ones before it are in;
+    // a worker does not start a chunk more than window chunks past the next one to append, so behind a slow chunk
+    // at most window outputs are held besides the result
+    std::vector<std::wstring> outputs(chunks.size());
+    std::vector<std::atomic<bool>> done(chunks.size());
+    std::atomic<size_t> next = 0;
+    std::atomic<size_t> appended = 0;
+    const size_t window = size_t{2} * threads;
+    auto worker = [&]() {
+        TextConverter converter(config);
+        for (auto i = next.fetch_add(1); i < chunks.size(); i = next.fetch_add(1)) {
+            for (auto a = appended.load(std::memory_order_acquire); i >= a + window;
+                 a = appended.load(std::memory_order_acquire)) {
+                appended.wait(a, std::memory_order_acquire);
+            }
+            outputs[i].reserve(chunks[i].size());
+            converter.Push(chunks[i], outputs[i]);
+            converter.Flush(outputs[i]);
+            done[i].store(true, std::memory_order_release);
+            done[i].notify_one();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < threads; i++) {
+        workers.emplace_back(worker);
+    }
+
+    for (size_t i = 0; i < chunks.size(); i++) {
+        done[i].wait(false, std::memory_order_acquire);
+        result.append(outputs[i]);
+        std::wstring().swap(outputs[i]);
+        appended.store(i + 1, std::memory_order_release);
+        appended.notify_all();
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    return result;
+}
+
+} // namespace Telex
+} // namespace VietType
@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "Telex.h"
+#include "TelexEngine.h"
+
+namespace VietType {
+namespace Telex {
+
+/// <summary>
+/// characters that end a word: ASCII punctuation, digits and whitespace
+/// </summary>
+constexpr bool IsSeparatorCharacter(wchar_t c) {
+    if (c >= L' ' && c <= L'@') {
+        return true;
+    } else if (c >= L'[' && c <= L'`') {
+        return true;
+    } else if (c >= L'{' && c <= L'~') {
+        return true;
+    } else if (c == L'\t' || c == L'\n' || c == L'\r') {
+        return true;
+    }
+    return false;
+}
+
+// inputs shorter than this are converted on the calling thread
+constexpr std::size_t DefaultConvertChunkLength = 1 << 16;
+
+/// <summary>
+/// convert Telex keystroke text into Vietnamese text,
+/// every run of non-separator characters is typed into a fresh engine and committed, separators are copied as-is
+/// </summary>
+/// <param name="threads">number of worker threads, 0 to use every core</param>
+/// <param name="chunkLength">approximate number of characters handed to a worker at a time</param>
+std::wstring ConvertText(
+    const TelexConfig& config,
+    std::wstring_view input,
+    unsigned int threads = 0,
+    std::size_t chunkLength = DefaultConvertChunkLength);
+
+/// <summary>
+/// incremental form of ConvertText, words may continue from one Push to the next;
+/// only the unfinished word is kept, so memory stays bounded however long the input is
+/// </summary>
+class TextConverter {
+public:
+    explicit TextConverter(const TelexConfig& config);
+
+    /// <summary>
+    /// convert the next piece of input, appending whatever is final to output
+    /// </summary>
+    void Push(std::wstring_view input, std::wstring& output);
+    /// <summary>
+    /// end of input, append the unfinished word if any
+    /// </summary>
+    void Flush(std::wstring& output);
+
+private:
+    void EndWord(std::wstring& output);
+
+    TelexEngine _engine;
+    bool _inWord = false;
+    // the word went Invalid, the rest of it is copied as-is
+    bool _passthrough = false;
+};
+
+} // namespace Telex
+} // namespace VietType
@@ -18,6 +18,13 @@
 #define MAKE_SORTED_SET(n, K, ...)                                                                                     \
     static constexpr const ArraySet<K, std::initializer_list<K>{__VA_ARGS__}.size(), true> n = {__VA_ARGS__};          \
     static_assert(std::is_sorted(n.begin(), n.end()))
+#define MAKE_HASH_MAP(n, K, V, ...)                                                                                    \
+    static constexpr const HashMap<K, V, std::initializer_list<std::pair<K, V>>{__VA_ARGS__}.size()> n = {             \
+        __VA_ARGS__};                                                                                                  \
+    static_assert(std::all_of(n.begin(), n.end(), [](const auto& x) { return &*n.find(x.first) == &x; }))
+#define MAKE_HASH_SET(n, K, ...)                                                                                       \
+    static constexpr const HashSet<K, std::initializer_list<K>{__VA_ARGS__}.size()> n = {__VA_ARGS__};                \
+    static_assert(std::all_of(n.begin(), n.end(), [](const auto& x) { return &*n.find(x) == &x; }))
 #define P(a, b) std::make_pair(std::wstring_view(a), std::wstring_view(b))
 #define P1(a, b) std::make_pair(std::wstring_view(a), b)
 #define P2(a, b) std::make_pair(a, std::wstring_view(b))
@@ -27,8 +34,9 @@ namespace VietType {
 namespace Telex {
 
 // maps that are too short are kept as generic
+// maps looked up on every keystroke use a perfect hash
 
-MAKE_SORTED_MAP(
+MAKE_HASH_MAP(
     transitions,
     std::wstring_view,
     std::wstring_view,
@@ -88,7 +96,7 @@ static_assert(std::all_of(respos.begin(), respos.end(), [](const auto& x) {
     return std::cmp_less_equal(x.second, x.first.length());
 }));
 
-MAKE_SORTED_MAP(
+MAKE_HASH_MAP(
     transitions_w,
     std::wstring_view,
     std::wstring_view,
@@ -163,7 +171,7 @@ static_assert(std::all_of(transitions_v_c2_q.begin(), transitions_v_c2_q.end(),
     return x.second.length() == x.first.length();
 }));
 
-MAKE_SORTED_MAP(
+MAKE_HASH_MAP(
     transitions_tones,
     wchar_t,
     std::wstring_view,
@@ -184,7 +192,7 @@ static_assert(std::all_of(transitions_tones.begin(), transitions_tones.end(), []
     return x.second.length() == transitions_tones[0].second.length();
 }));
 
-MAKE_SORTED_SET(
+MAKE_HASH_SET(
     valid_c1,
     std::wstring_view,
     L"",    //
@@ -218,7 +226,7 @@ MAKE_SORTED_SET(
     L"\x111", //
 );
 
-MAKE_SORTED_MAP(
+MAKE_HASH_MAP(
     valid_v,
     std::wstring_view,
     VInfo,
@@ -286,7 +294,7 @@ static_assert(std::all_of(valid_v.begin(), valid_v.end(), [](const auto& x) {
     return std::cmp_less_equal(x.second.tonepos, x.first.length());
 }));
 
-MAKE_SORTED_MAP(
+MAKE_HASH_MAP(
     valid_v_q,
     std::wstring_view,
     VInfo,
@@ -315,7 +323,7 @@ static_assert(std::all_of(valid_v_q.begin(), valid_v_q.end(), [](const auto& x)
     return std::cmp_less_equal(x.second.tonepos, x.first.length());
 }));
 
-MAKE_SORTED_MAP(
+MAKE_HASH_MAP(
     valid_v_gi,
     std::wstring_view,
     VInfo,
@@ -355,7 +363,7 @@ static_assert(std::all_of(valid_v_gi.begin(), valid_v_gi.end(), [](const auto& x
 // bool is whether tones are restricted to s/j or not
 // note: all the c2 that share a prefix must have the same restrict value
 // i.e. valid_c2["c"]->second == valid_c2["ch"]->second
-MAKE_SORTED_MAP(
+MAKE_HASH_MAP(
     valid_c2,
     std::wstring_view,
     bool,
@@ -371,7 +379,7 @@ MAKE_SORTED_MAP(
     P1(L"t", true),   //
 );
 
-MAKE_MAP(
+MAKE_HASH_MAP(
     valid_v_oa_uy,
     std::wstring_view,
     VInfo,
@@ -383,7 +391,7 @@ static_assert(std::all_of(valid_v_oa_uy.begin(), valid_v_oa_uy.end(), [](const a
     return std::cmp_less_equal(x.second.tonepos, x.first.length());
 }));
 
-MAKE_SORTED_MAP(
+MAKE_HASH_MAP(
     backconversions,
     wchar_t,
     std::wstring_view,
@@ -898,6 +906,8 @@ MAKE_SORTED_SET(
 #undef MAKE_SET
 #undef MAKE_SORTED_MAP
 #undef MAKE_SORTED_SET
+#undef MAKE_HASH_MAP
+#undef MAKE_HASH_SET
 #undef P
 #undef P1
 #undef P2
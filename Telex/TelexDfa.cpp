@@ -0,0 +1,718 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include "TelexAutocorrect.h"
+#include "TelexDfa.h"
+#include "TelexData.h"
+#include "TelexWordFilter.h"
+
+namespace VietType {
+namespace Telex {
+
+static constexpr size_t DfaAlphabet = 26;
+
+struct TelexEngineImpl {
+    static bool IsWordListPrefix(const TelexEngine& e, std::wstring_view lower) {
+        auto isPrefix = [&](const auto& list) {
+            return std::any_of(list.begin(), list.end(), [&](std::wstring_view w) { return w.starts_with(lower); });
+        };
+        if (e._config.optimize_multilang < 1) {
+            return false;
+        }
+        return isPrefix(wlist_en) || (e._config.autocorrect && isPrefix(wlist_en_ac)) ||
+               (e._config.optimize_multilang >= 2 && isPrefix(wlist_en_2));
+    }
+
+    template <typename... Lists>
+    static bool StartsAny(std::wstring_view part, const Lists&... lists) {
+        auto starts = [&](const auto& list) {
+            return std::any_of(list.begin(), list.end(), [&](const auto& entry) {
+                if constexpr (requires { entry.first; }) {
+                    return entry.first.starts_with(part);
+                } else {
+                    return std::wstring_view(entry).starts_with(part);
+                }
+            });
+        };
+        return (starts(lists) || ...);
+    }
+
+    static const AutocorrectRules& GetAutocorrectRules(const TelexEngine& e) {
+        return e._config.autocorrect_rules ? *e._config.autocorrect_rules : AutocorrectRules::Default();
+    }
+
+    // v only changes by appending, through the transition tables or by the autocorrect in Commit, so once no entry
+    // starts with it, it can neither transition again nor become a valid vowel
+    static bool IsDeadV(const TelexEngine& e) {
+        return !StartsAny(
+                   e._v,
+                   valid_v,
+                   valid_v_q,
+                   valid_v_gi,
+                   valid_v_oa_uy,
+                   transitions,
+                   transitions_w,
+                   transitions_w_q,
+                   transitions_v_c2,
+                   transitions_v_c2_q) &&
+               !GetAutocorrectRules(e).MayRewrite(AutocorrectRules::V, e._v);
+    }
+
+    // c1 and c2 only ever grow (besides 'd' -> '\x111', which is a valid onset either way)
+    static bool IsDeadC1(const TelexEngine& e) {
+        return !StartsAny(e._c1, valid_c1);
+    }
+
+    static bool IsDeadC2(const TelexEngine& e) {
+        return !StartsAny(e._c2, valid_c2) && !GetAutocorrectRules(e).MayRewrite(AutocorrectRules::C2, e._c2);
+    }
+
+    static void AppendPart(std::wstring& key, std::wstring_view part, bool dead) {
+        if (dead) {
+            key.push_back(static_cast<wchar_t>(L'0' + part.size()));
+        } else {
+            key.append(part);
+        }
+        key.push_back(L'|');
+    }
+
+    // everything about a Valid word that decides what later keys and Commit do;
+    // the word length is left out since the table engine checks MaxLength by itself
+    static std::wstring StateKey(const TelexEngine& e, bool outputs) {
+        std::wstring key;
+        auto deadC1 = !outputs && IsDeadC1(e);
+        auto deadV = !outputs && IsDeadV(e);
+        auto deadC2 = !outputs && IsDeadC2(e);
+        // once Commit can no longer succeed, only the lengths of the dead parts matter:
+        // PushChar compares c1 and v against table entries that a dead part never matches,
+        // and only checks whether c2 is empty
+        auto dead = deadC1 || deadV || deadC2;
+        AppendPart(key, e._c1, deadC1);
+        AppendPart(key, e._v, deadV);
+        AppendPart(key, e._c2, dead);
+        key.push_back(static_cast<wchar_t>(L'0' + static_cast<int>(e._t)));
+        key.push_back(static_cast<wchar_t>(L'0' + std::min(e._toneCount, 2)));
+        auto last = e._keyBuffer.empty() ? L'-' : ToLower(e._keyBuffer.back());
+        if (!outputs && std::wstring_view(L"aeiouywdfjrsxz").find(last) == std::wstring_view::npos) {
+            // only a repeated vowel, 'w', 'd' or tone key looks at the key before it
+            last = L'*';
+        }
+        key.push_back(last);
+        key.push_back(static_cast<wchar_t>(e._respos.empty() ? 0 : (e._respos.back() & ~ResposMask)));
+        key.push_back(e.HasValidRespos() ? L'V' : L'-');
+        // case bits erased by the autocorrect in Commit
+        for (auto rp : e._respos) {
+            if (rp & ResposAutocorrect) {
+                key.push_back(static_cast<wchar_t>(L'0' + (rp & ResposMask)));
+            }
+        }
+        key.push_back(L'|');
+        // Commit looks up the whole word in the English word lists
+        std::wstring lower;
+        for (auto c : e._keyBuffer) {
+            lower.push_back(ToLower(c));
+        }
+        if (IsWordListPrefix(e, lower)) {
+            key.append(lower);
+        }
+        return key;
+    }
+
+    static bool IsPeekRaw(const TelexEngine& e) {
+        VInfo vinfo;
+        return !e.GetTonePos(false, &vinfo) && e._t != Tones::Z;
+    }
+
+    static size_t CaseCount(const TelexEngine& e) {
+        return e._cases.size();
+    }
+
+    static bool LastIsDoubleUndo(const TelexEngine& e) {
+        // keys past the stored respos are never double undos
+        return e._respos.size() == e._keyBuffer.size() && !e._respos.empty() && (e._respos.back() & ResposDoubleUndo);
+    }
+};
+
+std::wstring TelexStateKey(const TelexEngine& e, bool outputs) {
+    return TelexEngineImpl::StateKey(e, outputs);
+}
+
+namespace {
+
+struct StateInfo {
+    std::wstring keys;
+    std::wstring peek;
+    std::wstring retrieve;
+    std::wstring commit;
+    TelexStates commitState = TelexStates::Committed;
+    uint8_t flags = 0;
+    std::array<uint8_t, MaxWordPartLength> commitCases{};
+    std::array<uint32_t, DfaAlphabet> next{};
+};
+
+TelexEngine Replay(const TelexConfig& config, std::wstring_view keys) {
+    TelexEngine e(config);
+    for (auto c : keys) {
+        e.PushChar(c);
+    }
+    return e;
+}
+
+void FillOutputs(const TelexConfig& config, StateInfo& info) {
+    auto e = Replay(config, info.keys);
+    info.peek = e.Peek();
+    info.retrieve = e.Retrieve();
+    if (TelexEngineImpl::IsPeekRaw(e)) {
+        info.flags |= DfaPeekRaw;
+    }
+
+    // which key pushed each case bit
+    std::vector<size_t> caseKeys;
+    TelexEngine walk(config);
+    for (size_t i = 0; i < info.keys.size(); i++) {
+        auto before = TelexEngineImpl::CaseCount(walk);
+        walk.PushChar(info.keys[i]);
+        if (TelexEngineImpl::CaseCount(walk) > before) {
+            caseKeys.push_back(i);
+        }
+    }
+
+    auto committed = e;
+    info.commitState = committed.Commit();
+    info.commit = committed.Retrieve();
+    info.commitCases.fill(DfaLowercase);
+    auto committedPeek = committed.Peek();
+    if (committedPeek != info.commit) {
+        info.flags |= committedPeek == committed.RetrieveRaw() ? DfaCommitPeekRaw : DfaCommitFallback;
+    }
+    if (info.commitState != TelexStates::Committed) {
+        return;
+    }
+    for (size_t j = 0; j < caseKeys.size(); j++) {
+        auto keys = info.keys;
+        keys[caseKeys[j]] = ToUpper(keys[caseKeys[j]]);
+        auto upper = Replay(config, keys);
+        upper.Commit();
+        auto result = upper.Retrieve();
+        for (size_t k = 0; k < result.size() && k < info.commit.size(); k++) {
+            if (result[k] != info.commit[k]) {
+                info.commitCases[k] = static_cast<uint8_t>(j);
+            }
+        }
+    }
+}
+
+struct Label {
+    const StateInfo* info;
+    bool operator<(const Label& other) const {
+        auto tie = [](const StateInfo* s) {
+            return std::tie(s->peek, s->retrieve, s->commit, s->commitState, s->flags, s->commitCases);
+        };
+        return tie(info) < tie(other.info);
+    }
+};
+
+} // namespace
+
+TelexDfa TelexDfa::Build(
+    const TelexConfig& tableConfig, std::span<const std::wstring> seeds, _Out_ size_t* unminimized) {
+    // the English filter is checked by TelexDfaEngine::Commit instead
+    auto config = tableConfig;
+    config.english_filter = nullptr;
+    std::vector<StateInfo> infos;
+    std::unordered_map<std::wstring, uint32_t> ids;
+
+    TelexEngine empty(config);
+    ids.emplace(TelexEngineImpl::StateKey(empty, true), 0);
+    infos.emplace_back();
+
+    // admit every Valid prefix of the seeds, keeping the shortest key sequence for each state
+    for (const auto& seed : seeds) {
+        TelexEngine e(config);
+        std::wstring keys;
+        for (auto c : seed) {
+            if (keys.size() >= MaxLength) {
+                break;
+            }
+            auto lc = ToLower(c);
+            if (lc < L'a' || lc > L'z' || e.PushChar(lc) != TelexStates::Valid) {
+                break;
+            }
+            keys.push_back(lc);
+            auto [it, added] = ids.emplace(TelexEngineImpl::StateKey(e, true), static_cast<uint32_t>(infos.size()));
+            if (added) {
+                infos.emplace_back().keys = keys;
+            } else if (infos[it->second].keys.size() > keys.size()) {
+                infos[it->second].keys = keys;
+            }
+        }
+    }
+
+    for (auto& info : infos) {
+        FillOutputs(config, info);
+        auto e = Replay(config, info.keys);
+        for (size_t k = 0; k < DfaAlphabet; k++) {
+            if (info.keys.size() >= MaxLength) {
+                // the replay would hit MaxLength, which says nothing about the state itself
+                info.next[k] = DfaFallback;
+                continue;
+            }
+            auto n = e;
+            auto state = n.PushChar(static_cast<wchar_t>(L'a' + k));
+            auto before = TelexEngineImpl::CaseCount(e);
+            uint32_t flags = TelexEngineImpl::LastIsDoubleUndo(n) ? DfaDoubleUndo : 0;
+            if (state != TelexStates::Valid) {
+                info.next[k] = DfaInvalid | flags;
+            } else {
+                if (TelexEngineImpl::CaseCount(n) > before) {
+                    flags |= DfaPushCase;
+                }
+                auto it = ids.find(TelexEngineImpl::StateKey(n, true));
+                info.next[k] = (it == ids.end() ? DfaFallback : it->second) | flags;
+            }
+        }
+    }
+    *unminimized = infos.size();
+
+    // Moore minimization: split states by their outputs, then by where their transitions lead
+    std::vector<uint32_t> cls(infos.size());
+    {
+        std::map<Label, uint32_t> labels;
+        for (size_t i = 0; i < infos.size(); i++) {
+            cls[i] = labels.emplace(Label{&infos[i]}, static_cast<uint32_t>(labels.size())).first->second;
+        }
+    }
+    size_t classCount = 0;
+    while (true) {
+        std::map<std::vector<uint32_t>, uint32_t> signatures;
+        std::vector<uint32_t> next(infos.size());
+        for (size_t i = 0; i < infos.size(); i++) {
+            std::vector<uint32_t> sig{cls[i]};
+            for (auto t : infos[i].next) {
+                auto target = t & DfaStateMask;
+                sig.push_back(
+                    (target == DfaInvalid || target == DfaFallback) ? t : ((t & ~DfaStateMask) | cls[target]));
+            }
+            next[i] = signatures.emplace(std::move(sig), static_cast<uint32_t>(signatures.size())).first->second;
+        }
+        cls = std::move(next);
+        if (signatures.size() == classCount) {
+            break;
+        }
+        classCount = signatures.size();
+    }
+
+    // renumber so that the empty word is state 0
+    std::vector<uint32_t> order(classCount, UINT32_MAX);
+    uint32_t count = 0;
+    order[cls[0]] = count++;
+    for (size_t i = 1; i < infos.size(); i++) {
+        if (order[cls[i]] == UINT32_MAX) {
+            order[cls[i]] = count++;
+        }
+    }
+
+    TelexDfa dfa;
+    dfa.config = tableConfig;
+    dfa.states.resize(classCount);
+    dfa.transitions.resize(classCount * DfaAlphabet);
+    std::vector<bool> done(classCount);
+    for (size_t i = 0; i < infos.size(); i++) {
+        auto id = order[cls[i]];
+        if (done[id]) {
+            continue;
+        }
+        done[id] = true;
+        const auto& info = infos[i];
+        auto& s = dfa.states[id];
+        auto addString = [&](const std::wstring& str, uint32_t* offset, uint8_t* length) {
+            auto pos = dfa.strings.find(str);
+            if (pos == std::wstring::npos) {
+                pos = dfa.strings.size();
+                dfa.strings.append(str);
+            }
+            *offset = static_cast<uint32_t>(pos);
+            *length = static_cast<uint8_t>(str.size());
+        };
+        addString(info.peek, &s.peekOffset, &s.peekLength);
+        addString(info.retrieve, &s.retrieveOffset, &s.retrieveLength);
+        addString(info.commit, &s.commitOffset, &s.commitLength);
+        s.commitState = static_cast<uint8_t>(info.commitState);
+        s.flags = info.flags;
+        s.commitCases = info.commitCases;
+        for (size_t k = 0; k < DfaAlphabet; k++) {
+            auto t = info.next[k];
+            auto target = t & DfaStateMask;
+            if (target != DfaInvalid && target != DfaFallback) {
+                t = (t & ~DfaStateMask) | order[cls[target]];
+            }
+            dfa.transitions[id * DfaAlphabet + k] = t;
+        }
+    }
+    return dfa;
+}
+
+static constexpr uint32_t DfaMagic = 0x41464456; // "VDFA"
+
+template <typename T>
+static bool WriteVector(FILE* f, const T* data, size_t count) {
+    uint64_t n = count;
+    return fwrite(&n, sizeof(n), 1, f) == 1 && (!count || fwrite(data, sizeof(T), count, f) == count);
+}
+
+// n comes from the file, so the data is read a chunk at a time and a short file fails before much is allocated
+template <typename T>
+static bool ReadVector(FILE* f, std::vector<T>& out) {
+    uint64_t n;
+    if (fread(&n, sizeof(n), 1, f) != 1 || n > (1ull << 32)) {
+        return false;
+    }
+    constexpr size_t chunk = 4096 / sizeof(T) + 1;
+    out.clear();
+    while (out.size() < n) {
+        auto old = out.size();
+        out.resize(old + static_cast<size_t>(std::min<uint64_t>(chunk, n - old)));
+        if (fread(out.data() + old, sizeof(T), out.size() - old, f) != out.size() - old) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TelexDfa::Save(_In_ FILE* f) const {
+    auto saved = config;
+    saved.english_filter = nullptr;
+    saved.autocorrect_rules = nullptr;
+    return fwrite(&DfaMagic, sizeof(DfaMagic), 1, f) == 1 && fwrite(&saved, sizeof(saved), 1, f) == 1 &&
+           WriteVector(f, transitions.data(), transitions.size()) && WriteVector(f, states.data(), states.size()) &&
+           WriteVector(f, strings.data(), strings.size());
+}
+
+bool TelexDfa::Load(_In_ FILE* f) {
+    uint32_t magic;
+    std::vector<wchar_t> chars;
+    if (fread(&magic, sizeof(magic), 1, f) != 1 || magic != DfaMagic || fread(&config, sizeof(config), 1, f) != 1 ||
+        !ReadVector(f, transitions) || !ReadVector(f, states) || !ReadVector(f, chars)) {
+        return false;
+    }
+    config.english_filter = nullptr;
+    config.autocorrect_rules = nullptr;
+    strings.assign(chars.begin(), chars.end());
+    if (states.empty() || transitions.size() != states.size() * DfaAlphabet) {
+        return false;
+    }
+    for (auto t : transitions) {
+        auto target = t & DfaStateMask;
+        if (target != DfaInvalid && target != DfaFallback && target >= states.size()) {
+            return false;
+        }
+    }
+    for (const auto& s : states) {
+        if (size_t{s.peekOffset} + s.peekLength > strings.size() ||
+            size_t{s.retrieveOffset} + s.retrieveLength > strings.size() ||
+            size_t{s.commitOffset} + s.commitLength > strings.size()) {
+            return false;
+        }
+        // the outputs are cased through the case bits and commitCases, which only go as far as a word part
+        if (s.peekLength > MaxWordPartLength || s.retrieveLength > MaxWordPartLength ||
+            s.commitLength > MaxWordPartLength) {
+            return false;
+        }
+        for (size_t i = 0; i < s.commitLength; i++) {
+            if (s.commitCases[i] != DfaLowercase && s.commitCases[i] >= MaxWordPartLength) {
+                return false;
+            }
+        }
+        if (s.commitState != static_cast<uint8_t>(TelexStates::Committed) &&
+            s.commitState != static_cast<uint8_t>(TelexStates::CommittedInvalid)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool SameConfig(const TelexConfig& a, const TelexConfig& b) {
+    return a.oa_uy_tone1 == b.oa_uy_tone1 && a.accept_separate_dd == b.accept_separate_dd &&
+           a.backspaced_word_stays_invalid == b.backspaced_word_stays_invalid &&
+           a.optimize_multilang == b.optimize_multilang && a.autocorrect == b.autocorrect &&
+           a.autocorrect_rules == b.autocorrect_rules;
+}
+
+TelexDfaEngine::TelexDfaEngine(const TelexDfa& dfa) : _dfa(&dfa), _engine(dfa.config) {
+}
+
+const TelexConfig& TelexDfaEngine::GetConfig() const {
+    return _engine.GetConfig();
+}
+
+bool TelexDfaEngine::SetConfig(const TelexConfig& config) {
+    if (!_fallback) {
+        StartFallback();
+    }
+    return _engine.SetConfig(config);
+}
+
+void TelexDfaEngine::Reset() {
+    if (_fallback) {
+        _engine.Reset();
+        if (!SameConfig(_engine.GetConfig(), _dfa->config)) {
+            // the table no longer matches the config
+            return;
+        }
+        _fallback = false;
+    }
+    _state = TelexStates::Valid;
+    _current = 0;
+    _keyBuffer.clear();
+    _cases.clear();
+    _doubleUndo = 0;
+}
+
+void TelexDfaEngine::StartFallback() {
+    _engine.Reset();
+    for (auto c : _keyBuffer) {
+        _engine.PushChar(c);
+    }
+    if (_state == TelexStates::Committed || _state == TelexStates::CommittedInvalid) {
+        _engine.Commit();
+    }
+    _fallback = true;
+}
+
+TelexStates TelexDfaEngine::PushChar(_In_ wchar_t c) {
+    if (_fallback) {
+        return _engine.PushChar(c);
+    }
+    if (_state != TelexStates::Valid && _state != TelexStates::Invalid) {
+        return _state;
+    }
+    if (_keyBuffer.size() >= MaxPushedKeys) {
+        _state = TelexStates::Invalid;
+        return _state;
+    }
+    _keyBuffer.push_back(c);
+    if (_state == TelexStates::Invalid || _keyBuffer.size() > MaxLength) {
+        _state = TelexStates::Invalid;
+        return _state;
+    }
+
+    auto lc = ToLower(c);
+    if (lc < L'a' || lc > L'z') {
+        _state = TelexStates::Invalid;
+        return _state;
+    }
+    auto t = _dfa->transitions[_current * DfaAlphabet + (lc - L'a')];
+    auto next = t & DfaStateMask;
+    if (next == DfaFallback) {
+        _keyBuffer.pop_back();
+        StartFallback();
+        return _engine.PushChar(c);
+    }
+    if (t & DfaDoubleUndo) {
+        _doubleUndo |= 1u << (_keyBuffer.size() - 1);
+    }
+    if (next == DfaInvalid) {
+        _state = TelexStates::Invalid;
+        return _state;
+    }
+    if (t & DfaPushCase) {
+        _cases.push_back(lc != c);
+    }
+    _current = next;
+    return _state;
+}
+
+TelexStates TelexDfaEngine::Backspace() {
+    if (!_fallback) {
+        StartFallback();
+    }
+    return _engine.Backspace();
+}
+
+TelexStates TelexDfaEngine::Commit() {
+    if (_fallback) {
+        return _engine.Commit();
+    }
+    if (_state == TelexStates::Invalid) {
+        _state = TelexStates::CommittedInvalid;
+    } else if (_state == TelexStates::Valid) {
+        const auto& s = _dfa->states[_current];
+        if (s.flags & DfaCommitFallback) {
+            StartFallback();
+            return _engine.Commit();
+        }
+        _state = static_cast<TelexStates>(s.commitState);
+        auto filter = _engine.GetConfig().english_filter;
+        if (_state == TelexStates::Committed && filter && _engine.GetConfig().optimize_multilang >= 1 &&
+            filter->Contains(_keyBuffer)) {
+            _state = TelexStates::CommittedInvalid;
+        }
+    }
+    return _state;
+}
+
+TelexStates TelexDfaEngine::ForceCommit() {
+    if (!_fallback) {
+        StartFallback();
+    }
+    return _engine.ForceCommit();
+}
+
+TelexStates TelexDfaEngine::Cancel() {
+    if (!_fallback) {
+        StartFallback();
+    }
+    return _engine.Cancel();
+}
+
+TelexStates TelexDfaEngine::Backconvert(_In_ std::wstring_view s) {
+    if (!_fallback) {
+        StartFallback();
+    }
+    return _engine.Backconvert(s);
+}
+
+TelexStates TelexDfaEngine::GetState() const {
+    return _fallback ? _engine.GetState() : _state;
+}
+
+std::wstring::size_type TelexDfaEngine::Count() const {
+    return _fallback ? _engine.Count() : _keyBuffer.size();
+}
+
+bool TelexDfaEngine::SaveSnapshot(_Out_ TelexSnapshot& snapshot) const {
+    if (_fallback) {
+        return _engine.SaveSnapshot(snapshot);
+    }
+    if (_keyBuffer.size() > TelexSnapshot::MaxKeys) {
+        return false;
+    }
+    TelexEngine e(_engine.GetConfig());
+    for (auto c : _keyBuffer) {
+        e.PushChar(c);
+    }
+    if (_state == TelexStates::Committed || _state == TelexStates::CommittedInvalid) {
+        e.Commit();
+    }
+    return e.SaveSnapshot(snapshot);
+}
+
+void TelexDfaEngine::RestoreSnapshot(_In_ const TelexSnapshot& snapshot) {
+    _engine.RestoreSnapshot(snapshot);
+    _fallback = true;
+}
+
+void TelexDfaEngine::RestoreSnapshotUnderNewConfig(_In_ const TelexSnapshot& snapshot) {
+    _engine.RestoreSnapshotUnderNewConfig(snapshot);
+    _fallback = true;
+}
+
+void TelexDfaEngine::RetrieveRawTo(SpanWriter& out) const {
+    for (size_t i = 0; i < _keyBuffer.size(); i++) {
+        if (i >= 32 || !(_doubleUndo & (1u << i))) {
+            out.push_back(_keyBuffer[i]);
+        }
+    }
+}
+
+void TelexDfaEngine::RetrieveTo(SpanWriter& out) const {
+    const auto& s = _dfa->states[_current];
+    if (_state == TelexStates::Valid) {
+        out.append(std::wstring_view(_dfa->strings).substr(s.retrieveOffset, s.retrieveLength));
+        auto result = out.written();
+        for (size_t i = 0; i < result.size(); i++) {
+            if (_cases[i]) {
+                result[i] = ToUpper(result[i]);
+            }
+        }
+    } else if (_state == TelexStates::Committed) {
+        out.append(std::wstring_view(_dfa->strings).substr(s.commitOffset, s.commitLength));
+        auto result = out.written();
+        for (size_t i = 0; i < result.size(); i++) {
+            auto src = s.commitCases[i];
+            if (src != DfaLowercase && _cases[src]) {
+                result[i] = ToUpper(result[i]);
+            }
+        }
+    } else {
+        RetrieveRawTo(out);
+    }
+}
+
+void TelexDfaEngine::PeekTo(SpanWriter& out) const {
+    const auto& s = _dfa->states[_current];
+    if (_state == TelexStates::Committed && !(s.flags & DfaCommitPeekRaw)) {
+        RetrieveTo(out);
+        return;
+    }
+    if (_state != TelexStates::Valid || (s.flags & DfaPeekRaw)) {
+        RetrieveRawTo(out);
+        return;
+    }
+    out.append(std::wstring_view(_dfa->strings).substr(s.peekOffset, s.peekLength));
+    auto result = out.written();
+    for (size_t i = 0; i < result.size(); i++) {
+        if (_cases[i]) {
+            result[i] = ToUpper(result[i]);
+        }
+    }
+}
+
+std::wstring TelexDfaEngine::Retrieve() const {
+    if (_fallback) {
+        return _engine.Retrieve();
+    }
+    std::array<wchar_t, MaxOutputLength> buffer;
+    return std::wstring(buffer.data(), Retrieve(buffer));
+}
+
+std::wstring TelexDfaEngine::RetrieveRaw() const {
+    if (_fallback) {
+        return _engine.RetrieveRaw();
+    }
+    std::array<wchar_t, MaxOutputLength> buffer;
+    return std::wstring(buffer.data(), RetrieveRaw(buffer));
+}
+
+std::wstring TelexDfaEngine::Peek() const {
+    if (_fallback) {
+        return _engine.Peek();
+    }
+    std::array<wchar_t, MaxOutputLength> buffer;
+    return std::wstring(buffer.data(), Peek(buffer));
+}
+
+std::size_t TelexDfaEngine::Retrieve(_Out_ std::span<wchar_t> buffer) const {
+    if (_fallback) {
+        return _engine.Retrieve(buffer);
+    }
+    SpanWriter out(buffer);
+    RetrieveTo(out);
+    return out.size();
+}
+
+std::size_t TelexDfaEngine::RetrieveRaw(_Out_ std::span<wchar_t> buffer) const {
+    if (_fallback) {
+        return _engine.RetrieveRaw(buffer);
+    }
+    SpanWriter out(buffer);
+    RetrieveRawTo(out);
+    return out.size();
+}
+
+std::size_t TelexDfaEngine::Peek(_Out_ std::span<wchar_t> buffer) const {
+    if (_fallback) {
+        return _engine.Peek(buffer);
+    }
+    SpanWriter out(buffer);
+    PeekTo(out);
+    return out.size();
+}
+
+} // namespace Telex
+} // namespace VietType
@@ -0,0 +1,151 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Telex.h"
+#include "TelexEngine.h"
+
+namespace VietType {
+namespace Telex {
+
+// transition entries: low 24 bits are the next state, the high bits are flags
+constexpr uint32_t DfaStateMask = 0xffffff;
+// the key pushes its case bit
+constexpr uint32_t DfaPushCase = 1u << 24;
+// the key is a double undo and is dropped from RetrieveRaw
+constexpr uint32_t DfaDoubleUndo = 1u << 25;
+constexpr uint32_t DfaInvalid = 0xfffffe;
+// the table does not cover this key, continue on the reference engine
+constexpr uint32_t DfaFallback = 0xffffff;
+constexpr uint8_t DfaLowercase = 0xff;
+
+// state flags
+// Peek shows the raw keys (tone set but the vowel is not known yet)
+constexpr uint8_t DfaPeekRaw = 1;
+// Peek after Commit shows the raw keys (the tone is already placed)
+constexpr uint8_t DfaCommitPeekRaw = 2;
+// Peek after Commit matches neither, Commit goes to the reference engine
+constexpr uint8_t DfaCommitFallback = 4;
+
+struct TelexDfaState {
+    uint32_t peekOffset;
+    uint32_t retrieveOffset;
+    uint32_t commitOffset;
+    uint8_t peekLength;
+    uint8_t retrieveLength;
+    uint8_t commitLength;
+    // Committed or CommittedInvalid
+    uint8_t commitState;
+    uint8_t flags;
+    // for each committed character, the index of the case bit it takes, or DfaLowercase
+    std::array<uint8_t, MaxWordPartLength> commitCases;
+};
+
+/// <summary>
+/// precompiled transition table of TelexEngine for one config;
+/// each state has 26 transitions, one per letter, and any other key invalidates the word
+/// </summary>
+struct TelexDfa {
+    TelexConfig config;
+    std::vector<uint32_t> transitions;
+    std::vector<TelexDfaState> states;
+    std::wstring strings;
+
+    size_t StateCount() const {
+        return states.size();
+    }
+
+    /// <summary>
+    /// walks the state space of TelexEngine reachable by the prefixes of the seed key sequences
+    /// and returns the minimized table; keys leaving that space are marked DfaFallback;
+    /// english_filter is not compiled into the table, TelexDfaEngine looks it up on Commit;
+    /// autocorrect_rules is, but is not saved, so a loaded table only matches its config with the built-in rules
+    /// </summary>
+    static TelexDfa Build(const TelexConfig& config, std::span<const std::wstring> seeds, _Out_ size_t* unminimized);
+
+    bool Save(_In_ FILE* f) const;
+    bool Load(_In_ FILE* f);
+};
+
+/// <summary>
+/// everything about a Valid word that decides what later keys and Commit do, except its length;
+/// two words with the same key react the same way to the same keys until either reaches MaxLength;
+/// without outputs, words that can no longer commit keep only the lengths of c1 and c2, so the key still decides
+/// the states and buffer sizes of later keys but not what Peek and Retrieve return
+/// </summary>
+std::wstring TelexStateKey(const TelexEngine& e, bool outputs = true);
+
+/// <summary>
+/// ITelexEngine running on a TelexDfa, one table lookup per key;
+/// operations the table does not cover (Backspace, Backconvert, Cancel, ForceCommit, SetConfig and keys outside the
+/// table) replay the word into a TelexEngine and continue on it until the next Reset
+/// </summary>
+class TelexDfaEngine : public ITelexEngine {
+public:
+    explicit TelexDfaEngine(const TelexDfa& dfa);
+    TelexDfaEngine(const TelexDfaEngine&) = default;
+    TelexDfaEngine& operator=(const TelexDfaEngine&) = default;
+    virtual ~TelexDfaEngine() {
+    }
+
+    const TelexConfig& GetConfig() const override;
+    bool SetConfig(const TelexConfig& config) override;
+
+    void Reset() override;
+    TelexStates PushChar(_In_ wchar_t c) override;
+    TelexStates Backspace() override;
+    TelexStates Commit() override;
+    TelexStates ForceCommit() override;
+    TelexStates Cancel() override;
+    TelexStates Backconvert(_In_ std::wstring_view s) override;
+
+    TelexStates GetState() const override;
+    std::wstring Retrieve() const override;
+    std::wstring RetrieveRaw() const override;
+    std::wstring Peek() const override;
+    std::size_t Retrieve(_Out_ std::span<wchar_t> buffer) const override;
+    std::size_t RetrieveRaw(_Out_ std::span<wchar_t> buffer) const override;
+    std::size_t Peek(_Out_ std::span<wchar_t> buffer) const override;
+    std::wstring::size_type Count() const override;
+
+    /// <summary>
+    /// snapshots are those of TelexEngine, a word still on the table is replayed to take one
+    /// </summary>
+    bool SaveSnapshot(_Out_ TelexSnapshot& snapshot) const override;
+    /// <summary>
+    /// continues on the fallback engine until the next Reset
+    /// </summary>
+    void RestoreSnapshot(_In_ const TelexSnapshot& snapshot) override;
+    void RestoreSnapshotUnderNewConfig(_In_ const TelexSnapshot& snapshot) override;
+
+    constexpr bool IsFallback() const {
+        return _fallback;
+    }
+
+private:
+    void StartFallback();
+    void RetrieveTo(SpanWriter& out) const;
+    void RetrieveRawTo(SpanWriter& out) const;
+    void PeekTo(SpanWriter& out) const;
+
+    const TelexDfa* _dfa;
+    TelexStates _state = TelexStates::Valid;
+    uint32_t _current = 0;
+    KeyBuffer _keyBuffer;
+    CaseMask _cases;
+    // keys dropped from RetrieveRaw, DoubleUndo can only happen within the first MaxLength + 1 keys
+    uint32_t _doubleUndo = 0;
+    bool _fallback = false;
+    TelexEngine _engine;
+};
+
+} // namespace Telex
+} // namespace VietType
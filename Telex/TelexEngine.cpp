@@ -1,34 +1,32 @@
 // SPDX-FileCopyrightText: Copyright (c) 2018 Dinh Ngoc Tu
 // SPDX-License-Identifier: GPL-3.0-only
 
+#include <algorithm>
+#include <array>
 #include <utility>
 #include <cassert>
+#include <bit>
+#include <memory>
+#include <stdexcept>
 #include "Telex.h"
+#include "TelexAutocorrect.h"
+#include "TelexBackconvert.h"
+#include "TelexCase.h"
 #include "TelexData.h"
 #include "TelexEngine.h"
+#include "TelexLatency.h"
+#include "TelexSyllables.h"
+#include "TelexWordFilter.h"
 
 #define IS(cat, type) (static_cast<bool>((cat) & (type)))
 
 namespace VietType {
 namespace Telex {
 
-ITelexEngine* TelexNew(const TelexConfig& config) {
-    return new TelexEngine(config);
-}
-
 void TelexDelete(ITelexEngine* engine) {
     delete engine;
 }
 
-constexpr size_t MaxLength = 10; // enough for "nghieengsz" and "nhuwowngxf"
-
-static CharTypes ClassifyCharacter(_In_ wchar_t lc) {
-    if (lc >= L'a' && lc <= L'z') {
-        return letterClasses[lc - L'a'];
-    }
-    return CharTypes::Uncategorized;
-}
-
 static Tones GetCharTone(_In_ wchar_t c) {
     switch (c) {
     case L'z':
@@ -48,61 +46,6 @@ static Tones GetCharTone(_In_ wchar_t c) {
     }
 }
 
-// case functions hardcode ranges of Vietnamese characters
-// the rest can be correctly transformed or not, doesn't matter
-
-static wchar_t ToUpper(_In_ wchar_t c) {
-    wchar_t uc = c & ~32;
-    // Basic Latin
-    if (uc >= L'A' && uc <= L'Z') {
-        return uc;
-    }
-    // Latin-1 Supplement
-    if (c >= L'\xe0' && c <= L'\xfe') {
-        return uc;
-    }
-    // "uw" exception
-    if (c >= L'\x1af' && c <= L'\x1b0') {
-        return L'\x1af';
-    }
-    uc = c & ~1;
-    // Latin Extended-A/B
-    if (c >= L'\x100' && c <= L'\x1bf') {
-        return uc;
-    }
-    // Latin Extended Additional
-    if (c >= L'\x1ea0' && c <= L'\x1ef9') {
-        return uc;
-    }
-    return c;
-}
-
-static wchar_t ToLower(_In_ wchar_t c) {
-    wchar_t lc = c | 32;
-    // Basic Latin
-    if (lc >= L'a' && lc <= L'z') {
-        return lc;
-    }
-    // Latin-1 Supplement
-    if (c >= L'\xc0' && c <= L'\xde') {
-        return lc;
-    }
-    // "uw" exception
-    if (c >= L'\x1af' && c <= L'\x1b0') {
-        return L'\x1b0';
-    }
-    lc = c | 1;
-    // Latin Extended-A/B
-    if (c >= L'\x100' && c <= L'\x1bf') {
-        return lc;
-    }
-    // Latin Extended Additional
-    if (c >= L'\x1ea0' && c <= L'\x1ef9') {
-        return lc;
-    }
-    return c;
-}
-
 static wchar_t TranslateTone(_In_ wchar_t c, _In_ Tones t) {
     auto it = transitions_tones.find(c);
     // don't fail here since tone position prediction might give invalid v
@@ -113,38 +56,65 @@ static wchar_t TranslateTone(_In_ wchar_t c, _In_ Tones t) {
     }
 }
 
-/// <summary>destructive</summary>
-static void ApplyCases(_In_ std::wstring& str, _In_ const std::vector<int>& cases) {
-    assert(str.length() == cases.size());
-    for (size_t i = 0; i < cases.size(); i++) {
-        if (cases[i]) {
-            str[i] = ToUpper(str[i]);
+/// <summary>destructive, to the part of the word that fit</summary>
+static void ApplyCases(_In_ SpanWriter& out, _In_ const CaseMask& cases) {
+    assert(out.size() == cases.size());
+    uint64_t bits = cases.bits();
+    ApplyCaseBits(out.written(), std::span<const uint64_t>(&bits, 1));
+}
+
+/// <summary>
+/// the commit cache key of a word: five bits per case-folded letter under a leading 1, then one case bit per key;
+/// 0 for words that are longer than MaxLength or have anything other than ASCII letters
+/// </summary>
+static uint64_t PackCommitKey(_In_ std::wstring_view keys) {
+    static_assert(1 + MaxLength * 6 <= 64);
+    if (keys.size() > MaxLength) {
+        return 0;
+    }
+    uint64_t letters = 1;
+    uint64_t cases = 0;
+    for (size_t i = 0; i < keys.size(); i++) {
+        auto c = keys[i];
+        if (c >= L'A' && c <= L'Z') {
+            cases |= uint64_t{1} << i;
+            c += L'a' - L'A';
+        } else if (c < L'a' || c > L'z') {
+            return 0;
         }
+        letters = letters << 5 | static_cast<uint64_t>(c - L'a');
     }
+    return letters << MaxLength | cases;
 }
 
-void TelexEngine::Invalidate() {
-    _respos.push_back(_respos_current++ | ResposInvalidate);
+template <typename Config>
+void TelexEngineT<Config>::Invalidate() {
+    if (_respos.size() < MaxResposLength) {
+        PushRespos(_respos_current | ResposInvalidate);
+    }
+    _respos_current++;
     _state = TelexStates::Invalid;
 }
 
-void TelexEngine::InvalidateAndPopBack(wchar_t c) {
+template <typename Config>
+void TelexEngineT<Config>::InvalidateAndPopBack(wchar_t c) {
     assert(_keyBuffer.length() > 1);
     // pop back only if same char entered twice in a row
     if (c == ToLower(_keyBuffer.rbegin()[1]))
-        _respos.push_back(_respos_current++ | ResposDoubleUndo);
+        PushRespos(_respos_current++ | ResposDoubleUndo);
     else
-        _respos.push_back(_respos_current++ | ResposInvalidate);
+        PushRespos(_respos_current++ | ResposInvalidate);
     _state = TelexStates::Invalid;
 }
 
-std::optional<std::pair<std::wstring_view, VInfo>> TelexEngine::FindTable() const {
+template <typename Config>
+std::optional<std::pair<std::wstring_view, VInfo>> TelexEngineT<Config>::FindTable() const {
     if (_c1 == L"q") {
         return valid_v_q.find_opt(_v);
     } else if (_c1 == L"gi") {
         return valid_v_gi.find_opt(_v);
     } else {
-        if (!_c2.size() && !_config.oa_uy_tone1) {
+        if (!_c2.size() && !OaUyTone1()) {
             auto it = valid_v_oa_uy.find(_v);
             if (it != valid_v_oa_uy.end())
                 return *it;
@@ -153,7 +123,8 @@ std::optional<std::pair<std::wstring_view, VInfo>> TelexEngine::FindTable() cons
     }
 }
 
-bool TelexEngine::GetTonePos(_In_ bool predict, _Out_ VInfo* vinfo) const {
+template <typename Config>
+bool TelexEngineT<Config>::GetTonePos(_In_ bool predict, _Out_ VInfo* vinfo) const {
     auto found = FindTable();
     VInfo retinfo = {0, C2Mode::Either};
     if (found) {
@@ -185,7 +156,8 @@ bool TelexEngine::GetTonePos(_In_ bool predict, _Out_ VInfo* vinfo) const {
     return found.has_value();
 }
 
-void TelexEngine::ReapplyTone() {
+template <typename Config>
+void TelexEngineT<Config>::ReapplyTone() {
     _toneCount++;
     int found = -1;
     for (int i = static_cast<int>(_respos.size() - 1); i >= 0; i--) {
@@ -195,40 +167,98 @@ void TelexEngine::ReapplyTone() {
         }
     }
     if (found >= 0) {
-        _respos.push_back(found | ResposTone);
+        PushRespos(found | ResposTone);
     } else {
         VInfo vinfo;
         if (GetTonePos(false, &vinfo))
-            _respos.push_back(static_cast<int>(_c1.size() + vinfo.tonepos) | ResposTone);
+            PushRespos(static_cast<int>(_c1.size() + vinfo.tonepos) | ResposTone);
         else
-            _respos.push_back(static_cast<int>(_c1.size() + _v.size() - 1) | ResposTone);
+            PushRespos(static_cast<int>(_c1.size() + _v.size() - 1) | ResposTone);
     }
 }
 
-bool TelexEngine::HasValidRespos() const {
+template <typename Config>
+bool TelexEngineT<Config>::HasValidRespos() const {
     return std::any_of(_respos.begin(), _respos.end(), [](auto rp) { return rp & ResposValidMask; });
 }
 
-TelexEngine::TelexEngine(const TelexConfig& config) {
+// fit the case bits of the part at [start, start + from) to its new length: the keys that the autocorrect let into the
+// part go first, then its last characters; added characters take the case of its first one
+template <typename Config>
+void TelexEngineT<Config>::ResizeCases(size_t start, size_t from, size_t to) {
+    for (auto i = _respos.size(); from > to && i-- > 0;) {
+        auto pos = static_cast<size_t>(_respos[i] & ResposMask);
+        if ((_respos[i] & ResposAutocorrect) && pos >= start && pos < start + from) {
+            _cases.erase(pos);
+            from--;
+        }
+    }
+    for (; from > to; from--) {
+        _cases.erase(start + from - 1);
+    }
+    auto upper = from ? _cases[start] : start && _cases[start - 1];
+    for (; from < to; from++) {
+        _cases.insert(start + from, upper);
+    }
+}
+
+template <typename Config>
+ResposBuffer TelexEngineT<Config>::GetRespos() const {
+    ResposBuffer result;
+    for (auto rp : _respos) {
+        result.push_back(rp);
+    }
+    if (_respos.size() == MaxResposLength && _state != TelexStates::BackconvertFailed) {
+        // the rest of the keys took one position each, up to _respos_current
+        auto pos = _respos_current - static_cast<int>(_keyBuffer.size() - _respos.size());
+        for (auto i = _respos.size(); i < _keyBuffer.size(); i++) {
+            result.push_back(static_cast<uint16_t>(pos++ | ResposInvalidate));
+        }
+    }
+    return result;
+}
+
+template <typename Config>
+TelexEngineT<Config>::TelexEngineT(const TelexConfig& config) {
+    if constexpr (Config::IsFixed) {
+        if (!Config::Matches(config)) {
+            throw std::invalid_argument("config does not match the engine");
+        }
+    }
     _config = config;
-    _keyBuffer.reserve(MaxLength);
-    _c1.reserve(MaxLength);
-    _v.reserve(MaxLength);
-    _c2.reserve(MaxLength);
-    _cases.reserve(MaxLength);
-    _respos.reserve(MaxLength);
+    ResetCommitCache();
     Reset();
 }
 
-const TelexConfig& TelexEngine::GetConfig() const {
+template <typename Config>
+const TelexConfig& TelexEngineT<Config>::GetConfig() const {
     return _config;
 }
 
-void TelexEngine::SetConfig(const TelexConfig& config) {
+template <typename Config>
+bool TelexEngineT<Config>::SetConfig(const TelexConfig& config) {
+    if constexpr (Config::IsFixed) {
+        if (!Config::Matches(config)) {
+            return false;
+        }
+    }
     _config = config;
+    // the current word was typed under the old config
+    _checkpointsValid = false;
+    ResetCommitCache();
+    return true;
+}
+
+template <typename Config>
+void TelexEngineT<Config>::ResetCommitCache() {
+    auto size = (_config.commit_cache_size + CommitCacheWays - 1) / CommitCacheWays * CommitCacheWays;
+    _commitCache.assign(size, CommitCacheEntry{});
+    _commitCacheSeen.assign(size / CommitCacheWays, 0);
+    _commitCacheClock = 0;
 }
 
-void TelexEngine::Reset() {
+template <typename Config>
+void TelexEngineT<Config>::Reset() {
     _state = TelexStates::Valid;
     _keyBuffer.clear();
     _c1.clear();
@@ -241,21 +271,119 @@ void TelexEngine::Reset() {
     _respos_current = 0;
     _backconverted = false;
     _autocorrected = false;
+    _checkpoints.clear();
+    _checkpointsValid = true;
+    assert(CheckInvariants());
+}
+
+template <typename Config>
+bool TelexEngineT<Config>::SaveSnapshot(_Out_ TelexSnapshot& snapshot) const {
+    if (_keyBuffer.size() > TelexSnapshot::MaxKeys) {
+        return false;
+    }
+    snapshot.keys = std::wstring_view(_keyBuffer);
+    snapshot.respos = _respos;
+    snapshot.c1 = _c1;
+    snapshot.v = _v;
+    snapshot.c2 = _c2;
+    snapshot.cases = _cases;
+    snapshot.checkpoints = _checkpoints;
+    snapshot.state = _state;
+    snapshot.t = _t;
+    snapshot.toneCount = static_cast<uint8_t>(_toneCount);
+    snapshot.respos_current = static_cast<uint8_t>(_respos_current);
+    snapshot.backconverted = _backconverted;
+    snapshot.autocorrected = _autocorrected;
+    snapshot.checkpointsValid = _checkpointsValid;
+    return true;
+}
+
+template <typename Config>
+void TelexEngineT<Config>::RestoreSnapshot(_In_ const TelexSnapshot& snapshot) {
+    _keyBuffer = std::wstring_view(snapshot.keys);
+    _respos = snapshot.respos;
+    _c1 = snapshot.c1;
+    _v = snapshot.v;
+    _c2 = snapshot.c2;
+    _cases = snapshot.cases;
+    _checkpoints = snapshot.checkpoints;
+    _state = snapshot.state;
+    _t = snapshot.t;
+    _toneCount = snapshot.toneCount;
+    _respos_current = snapshot.respos_current;
+    _backconverted = snapshot.backconverted;
+    _autocorrected = snapshot.autocorrected;
+    _checkpointsValid = snapshot.checkpointsValid;
     assert(CheckInvariants());
 }
 
+template <typename Config>
+void TelexEngineT<Config>::RestoreSnapshotUnderNewConfig(_In_ const TelexSnapshot& snapshot) {
+    RestoreSnapshot(snapshot);
+    // the word was typed under the old config
+    _checkpointsValid = false;
+}
+
+template <typename Config>
+void TelexEngineT<Config>::SaveCheckpoint() {
+    // filled in place, copying a checkpoint just put together field by field stalls on the partial writes
+    _checkpoints.push_back(Checkpoint{});
+    auto& cp = _checkpoints.back();
+    cp.v = std::wstring_view(_v);
+    cp.c1front = _c1.empty() ? L'\0' : _c1[0];
+    cp.c1size = static_cast<uint8_t>(_c1.size());
+    cp.c2size = static_cast<uint8_t>(_c2.size());
+    cp.casesize = static_cast<uint8_t>(_cases.size());
+    cp.respos_current = static_cast<uint8_t>(_respos_current);
+    cp.toneCount = static_cast<uint8_t>(_toneCount);
+    cp.t = _t;
+    cp.state = _state;
+}
+
+// rewind the word to the state it was in before key number `count` was pushed
+template <typename Config>
+void TelexEngineT<Config>::RestoreCheckpoint(size_t count) {
+    if (count >= _checkpoints.size()) {
+        // past MaxLength, keys only append to an Invalid word
+        assert(_state == TelexStates::Invalid);
+        _respos_current -= static_cast<int>(_keyBuffer.size() - count);
+        _keyBuffer.resize(count);
+        _respos.resize(std::min(count, MaxResposLength));
+        return;
+    }
+    const auto& cp = _checkpoints[count];
+    _keyBuffer.resize(count);
+    _respos.resize(count);
+    _c1.resize(cp.c1size);
+    if (cp.c1size) {
+        _c1[0] = cp.c1front;
+    }
+    _v = cp.v;
+    _c2.resize(cp.c2size);
+    _cases.resize(cp.casesize);
+    _respos_current = cp.respos_current;
+    _toneCount = cp.toneCount;
+    _t = cp.t;
+    _state = cp.state;
+    _checkpoints.resize(count);
+}
+
 // remember to push into _cases when adding a new character
-TelexStates TelexEngine::PushChar(_In_ wchar_t corig) {
+template <typename Config>
+TelexStates TelexEngineT<Config>::PushChar(_In_ wchar_t corig) {
     // PushChar at any committed/error state is illegal, but fail softly anyway
     if (_state != TelexStates::Valid && _state != TelexStates::Invalid) {
         return _state;
     }
-    if (_keyBuffer.size() > 250) {
+    if (_keyBuffer.size() >= MaxPushedKeys) {
         _state = TelexStates::Invalid;
         assert(CheckInvariants());
         return _state;
     }
 
+    if (_keyBuffer.size() <= MaxLength) {
+        SaveCheckpoint();
+    }
     _keyBuffer.push_back(corig);
 
     if (_state == TelexStates::Invalid || _keyBuffer.size() > MaxLength) {
@@ -274,33 +402,33 @@ TelexStates TelexEngine::PushChar(_In_ wchar_t corig) {
         // ConsoContinue is a subset of ConsoC1, no need to check
         _c1.push_back(c);
         _cases.push_back(ccase);
-        _respos.push_back(_respos_current++);
+        PushRespos(_respos_current++);
 
     } else if (_v.empty() && _c1 == L"g" && c == L'i') {
         // special treatment for 'gi'
         _c1.push_back(c);
         _cases.push_back(ccase);
-        _respos.push_back(_respos_current++);
+        PushRespos(_respos_current++);
 
-    } else if (_c1 == L"d" && c == L'd' && (_config.accept_separate_dd || (_v.empty() && _c2.empty()))) {
+    } else if (_c1 == L"d" && c == L'd' && (AcceptSeparateDd() || (_v.empty() && _c2.empty()))) {
         // only used for 'dd'
         // relaxed constraint: _v.empty()
         _c1 = L"\x111";
-        _respos.push_back(0 | ResposTransitionC1);
+        PushRespos(0 | ResposTransitionC1);
 
     } else if (_c1 == L"\x111" && c == L'd') {
         // only used for 'dd'
         // relaxed constraint: _v.empty()
         if (_keyBuffer.size() > 1 && ToLower(_keyBuffer.rbegin()[1]) == L'd')
-            _respos.push_back(_respos_current++ | ResposDoubleUndo);
+            PushRespos(_respos_current++ | ResposDoubleUndo);
         else
-            _respos.push_back(_respos_current++ | ResposInvalidate);
+            PushRespos(_respos_current++ | ResposInvalidate);
         _state = TelexStates::Invalid;
 
     } else if (_v.empty() && _c2.empty() && _c1 != L"gi" && IS(cat, CharTypes::ConsoContinue)) {
         _c1.push_back(c);
         _cases.push_back(ccase);
-        _respos.push_back(_respos_current++);
+        PushRespos(_respos_current++);
 
     } else if (IS(cat, CharTypes::Vowel)) {
         // relaxed vowel position constraint: _c2.empty()
@@ -309,29 +437,29 @@ TelexStates TelexEngine::PushChar(_In_ wchar_t corig) {
         auto before = _v.size();
         if (TransitionV(transitions)) {
             auto after = _v.size();
-            if (_config.optimize_multilang >= 3 && _toneCount) {
+            if (OptimizeMultilang() >= 3 && _toneCount) {
                 Invalidate();
             } else if (
                 _keyBuffer.size() > 1 && _respos.back() & ResposTransitionV && c == ToLower(_keyBuffer.rbegin()[1])) {
                 _cases.push_back(ccase);
-                _respos.push_back(_respos_current++ | ResposDoubleUndo);
+                PushRespos(_respos_current++ | ResposDoubleUndo);
             } else if (after < before) {
-                _respos.push_back(static_cast<int>(_c1.size() + _v.size() - 1) | ResposTransitionV);
+                PushRespos(static_cast<int>(_c1.size() + _v.size() - 1) | ResposTransitionV);
             } else if (after == before) {
                 // in case of 'uơi' -> 'ươi', the transition char itself is a normal character
                 // so it must be recorded as such rather than just a transition
                 _cases.push_back(ccase);
-                _respos.push_back(_respos_current++ | ResposTransitionV);
+                PushRespos(_respos_current++ | ResposTransitionV);
             }
         } else {
             // if there is no transition, there must be a new character -> must push case
             _cases.push_back(ccase);
             // invalidate if same char entered twice in a row in order to undo transition
             if (_keyBuffer.size() > 1 && _respos.back() & ResposTransitionV && c == ToLower(_keyBuffer.rbegin()[1])) {
-                _respos.push_back(_respos_current++ | ResposDoubleUndo);
+                PushRespos(_respos_current++ | ResposDoubleUndo);
                 _state = TelexStates::Invalid;
             } else {
-                _respos.push_back(_respos_current++);
+                PushRespos(_respos_current++);
             }
             if (!_c2.empty()) {
                 // in case there exists no transition when _c2 is already typed
@@ -356,15 +484,15 @@ TelexStates TelexEngine::PushChar(_In_ wchar_t corig) {
                         TransitionV(transitions_v_c2);
                     }
                 }
-                _respos.push_back(static_cast<int>(_c1.size() + _v.size() - 1) | ResposTransitionW);
+                PushRespos(static_cast<int>(_c1.size() + _v.size() - 1) | ResposTransitionW);
             } else {
                 InvalidateAndPopBack(c);
             }
             // 'w' always keeps V size constant, don't push case
-        } else if (_config.autocorrect && !_toneCount && (!_c1.empty() || _config.optimize_multilang == 0)) {
+        } else if (Autocorrect() && !_toneCount && (!_c1.empty() || OptimizeMultilang() == 0)) {
             _v.push_back(c);
             _cases.push_back(ccase);
-            _respos.push_back(_respos_current++ | ResposAutocorrect);
+            PushRespos(_respos_current++ | ResposAutocorrect);
         } else {
             Invalidate();
         }
@@ -373,7 +501,7 @@ TelexStates TelexEngine::PushChar(_In_ wchar_t corig) {
         // tones
         auto newtone = GetCharTone(c);
         if (newtone != _t) {
-            if (_config.optimize_multilang >= 3 && _toneCount) {
+            if (OptimizeMultilang() >= 3 && _toneCount) {
                 Invalidate();
             } else {
                 _t = newtone;
@@ -403,7 +531,7 @@ TelexStates TelexEngine::PushChar(_In_ wchar_t corig) {
             }
             _c2.push_back(c);
             _cases.push_back(ccase);
-            _respos.push_back(_respos_current++);
+            PushRespos(_respos_current++);
         } else {
             Invalidate();
         }
@@ -412,7 +540,7 @@ TelexStates TelexEngine::PushChar(_In_ wchar_t corig) {
         // consonant continuation (dgh)
         _c2.push_back(c);
         _cases.push_back(ccase);
-        _respos.push_back(_respos_current++);
+        PushRespos(_respos_current++);
 
     } else {
         Invalidate();
@@ -422,19 +550,136 @@ TelexStates TelexEngine::PushChar(_In_ wchar_t corig) {
     return _state;
 }
 
-TelexStates TelexEngine::Backspace() {
+template <typename Config>
+TelexStates TelexEngineT<Config>::Backspace() {
+    if (_state == TelexStates::Invalid && _config.backspaced_word_stays_invalid) {
+        return BackspaceInvalid();
+    }
+    if (!_checkpointsValid || (_state != TelexStates::Valid && _state != TelexStates::Invalid) || _keyBuffer.empty()) {
+        return BackspaceReplay();
+    }
+
+    [[maybe_unused]] auto prevState = _state;
+    auto n = _keyBuffer.size();
+
+    if (_state == TelexStates::Valid) {
+        // replay would only skip the last key unless expunging tones or double undos drops earlier keys too
+        VInfo vinfo;
+        if (GetTonePos(false, &vinfo) || _t == Tones::Z) {
+            auto toDelete = static_cast<int>(_c1.size() + _v.size() + _c2.size()) - 1;
+            int lastTone = -1;
+            for (size_t i = 0; i < n; i++) {
+                if (_respos[i] & ResposTone) {
+                    lastTone = static_cast<int>(i);
+                }
+            }
+            for (size_t i = 0; i < n; i++) {
+                auto rp = _respos[i];
+                bool kept = (rp & ResposMask) < toDelete && (!(rp & ResposTone) || static_cast<int>(i) == lastTone);
+                if (i + 1 < n && _respos[i + 1] & ResposDoubleUndo && (_respos[i + 1] & ResposMask) >= toDelete) {
+                    kept = false;
+                }
+                if (kept != (i + 1 < n)) {
+                    return BackspaceReplay();
+                }
+            }
+            bool oldBackconverted = _backconverted;
+            RestoreCheckpoint(n - 1);
+            _backconverted = n > 1 && oldBackconverted;
+        } else {
+            RestoreCheckpoint(n - 1);
+            _backconverted = false;
+        }
+    } else {
+        RestoreCheckpoint(n - 1);
+        _backconverted = false;
+    }
+    _autocorrected = false;
+
+    assert(CheckInvariantsBackspace(prevState));
+    return _state;
+}
+
+// with backspaced_word_stays_invalid, replaying an Invalid word only drops the DoubleUndo keys,
+// so the replayed respos are just sequential positions
+template <typename Config>
+TelexStates TelexEngineT<Config>::BackspaceInvalid() {
+    [[maybe_unused]] auto prevState = _state;
+    auto n = _keyBuffer.size();
+    if (n <= 1) {
+        Reset();
+        assert(CheckInvariantsBackspace(prevState));
+        return _state;
+    }
+
+    // keys past the stored respos are always sequential Invalidate positions,
+    // so if the stored head of the word is already in replayed form then so is the rest
+    bool replayed = true;
+    for (size_t i = 0; i < n - 1 && i < _respos.size(); i++) {
+        if (_respos[i] != (i | ResposInvalidate)) {
+            replayed = false;
+            break;
+        }
+    }
+    if (replayed) {
+        _keyBuffer.pop_back();
+        _respos.resize(std::min(_keyBuffer.size(), MaxResposLength));
+    } else {
+        // double undos only happen while the word is still Valid, so they are all in the stored head
+        size_t j = 0;
+        for (size_t i = 0; i < n - 1; i++) {
+            if (i >= _respos.size() || !(_respos[i] & ResposDoubleUndo)) {
+                _keyBuffer[j++] = _keyBuffer[i];
+            }
+        }
+        _keyBuffer.resize(j);
+        _respos.resize(std::min(j, MaxResposLength));
+        for (size_t i = 0; i < _respos.size(); i++) {
+            _respos[i] = static_cast<uint16_t>(i | ResposInvalidate);
+        }
+    }
+    _c1.clear();
+    _v.clear();
+    _c2.clear();
+    _t = Tones::Z;
+    _toneCount = 0;
+    _cases.clear();
+    _respos_current = static_cast<int>(_keyBuffer.size());
+    _backconverted = false;
+    _autocorrected = false;
+    _state = TelexStates::Invalid;
+    // the word no longer matches what its keys would produce
+    _checkpoints.clear();
+    _checkpointsValid = false;
+
+    assert(CheckInvariantsBackspace(prevState));
+    return _state;
+}
+
+template <typename Config>
+TelexStates TelexEngineT<Config>::BackspaceReplay() {
     if (_state != TelexStates::Valid && _state != TelexStates::Invalid && _state != TelexStates::BackconvertFailed) {
         return _state;
     }
 
     [[maybe_unused]] auto prevState = _state;
-    std::wstring buf(_keyBuffer);
-    std::vector<int> rp(_respos);
+    KeyBuffer buf(_keyBuffer);
+    // only the stored head: the keys past it are sequential Invalidate positions, never double undos,
+    // and a Valid word has every key stored
+    ResposHead rp(_respos);
 
     if (_state == TelexStates::BackconvertFailed) {
         _keyBuffer.pop_back();
-        TelexEngine emulate(GetConfig());
+        // the replay engine has no commit cache so that nothing is allocated, only its word is taken
+        auto config = _config;
+        config.commit_cache_size = 0;
+        TelexEngineT emulate(config);
         if (emulate.Backconvert(_keyBuffer) == TelexStates::Valid) {
+            emulate._config = _config;
+            emulate._commitCache.swap(_commitCache);
+            emulate._commitCacheSeen.swap(_commitCacheSeen);
+            emulate._commitCacheClock = _commitCacheClock;
+            emulate._commitCacheStats = _commitCacheStats;
             *this = std::move(emulate);
         }
         return _state;
@@ -447,7 +692,7 @@ TelexStates TelexEngine::Backspace() {
             _state = TelexStates::Invalid;
         }
         for (size_t i = 0; i < buf.size(); i++)
-            if (!_config.backspaced_word_stays_invalid || !(rp[i] & ResposDoubleUndo))
+            if (!_config.backspaced_word_stays_invalid || i >= rp.size() || !(rp[i] & ResposDoubleUndo))
                 // if backspaced_word_stays_invalid=1, we need to push all chars in order to reproduce the
                 // ResposDoubleUndo, thus the check
                 PushChar(buf[i]);
@@ -473,9 +718,6 @@ TelexStates TelexEngine::Backspace() {
     }
 
     assert(_keyBuffer.size() == _respos.size());
-    rp = _respos;
-    std::wstring oldc1(_c1);
-    std::wstring oldv(_v);
     bool oldBackconverted = _backconverted;
 
     auto toDelete = static_cast<int>(_c1.size() + _v.size() + _c2.size()) - 1;
@@ -487,18 +729,18 @@ TelexStates TelexEngine::Backspace() {
     for (size_t i = 0; i < buf.size(); i++) {
         if (rp[i] & ResposTone) {
             lastTone = static_cast<int>(i);
-            rp[i] = (rp[i] & ResposMask) | ResposExpunged;
+            rp[i] = static_cast<uint16_t>((rp[i] & ResposMask) | ResposExpunged);
         }
     }
     if (lastTone >= 0) {
-        rp[lastTone] = (rp[lastTone] & ResposMask) | ResposTone;
+        rp[lastTone] = static_cast<uint16_t>((rp[lastTone] & ResposMask) | ResposTone);
     }
 
     for (size_t i = 0; i < buf.size(); i++) {
         if (rp[i] & ResposDoubleUndo && (rp[i] & ResposMask) >= toDelete) {
             assert(i > 0);
             assert(rp[i - 1] & ~ResposMask);
-            rp[i - 1] = (rp[i - 1] & ResposMask) | ResposExpunged;
+            rp[i - 1] = static_cast<uint16_t>((rp[i - 1] & ResposMask) | ResposExpunged);
         }
     }
 
@@ -514,7 +756,88 @@ TelexStates TelexEngine::Backspace() {
     return _state;
 }
 
-TelexStates TelexEngine::Commit() {
+template <typename Config>
+TelexStates TelexEngineT<Config>::Commit() {
+    // only words typed from Reset under the current config are fully decided by their keys
+    if (_commitCache.empty() || _state != TelexStates::Valid || !_checkpointsValid || _backconverted ||
+        _keyBuffer.empty()) {
+        return CommitUncached();
+    }
+    auto key = PackCommitKey(_keyBuffer);
+    if (!key) {
+        return CommitUncached();
+    }
+
+    auto setIndex = ((key * 0x9e3779b97f4a7c15) >> 32) % _commitCacheSeen.size();
+    auto set = _commitCache.begin() + setIndex * CommitCacheWays;
+    _commitCacheClock++;
+    auto victim = set;
+    for (auto entry = set; entry != set + CommitCacheWays; entry++) {
+        if (entry->key == key) {
+            auto parts = entry->parts.begin();
+            _cases.clear();
+            for (auto [part, size] :
+                 {std::pair{&_c1, entry->c1Size}, std::pair{&_v, entry->vSize}, std::pair{&_c2, entry->c2Size}}) {
+                part->clear();
+                for (size_t i = 0; i < size; i++) {
+                    part->push_back(static_cast<wchar_t>(*parts++));
+                    _cases.push_back((entry->cases >> _cases.size()) & 1);
+                }
+            }
+            _autocorrected = entry->autocorrected;
+            _state = entry->committedInvalid ? TelexStates::CommittedInvalid : TelexStates::Committed;
+            entry->lastUse = _commitCacheClock;
+            _commitCacheStats.hits++;
+            assert(CheckInvariants());
+            return _state;
+        }
+        if (victim->key &&
+            (!entry->key || static_cast<uint16_t>(_commitCacheClock - entry->lastUse) >
+                                static_cast<uint16_t>(_commitCacheClock - victim->lastUse))) {
+            victim = entry;
+        }
+    }
+
+    _commitCacheStats.misses++;
+    CommitUncached();
+    // a first miss only remembers the word
+    auto& seen = _commitCacheSeen[setIndex];
+    if (seen != key) {
+        seen = key;
+        return _state;
+    }
+    seen = 0;
+    auto size = _c1.size() + _v.size() + _c2.size();
+    if (size > CommitCacheMaxParts || _cases.size() != size) {
+        return _state;
+    }
+    decltype(victim->parts) parts{};
+    auto out = parts.begin();
+    for (const auto* part : {&_c1, &_v, &_c2}) {
+        for (auto c : *part) {
+            if (static_cast<uint32_t>(c) > 0xffff) {
+                return _state;
+            }
+            *out++ = static_cast<char16_t>(c);
+        }
+    }
+    if (victim->key) {
+        _commitCacheStats.evictions++;
+    }
+    victim->key = key;
+    victim->parts = parts;
+    victim->c1Size = static_cast<uint8_t>(_c1.size());
+    victim->vSize = static_cast<uint8_t>(_v.size());
+    victim->c2Size = static_cast<uint8_t>(_c2.size());
+    victim->cases = static_cast<uint8_t>(_cases.bits());
+    victim->committedInvalid = _state == TelexStates::CommittedInvalid;
+    victim->autocorrected = _autocorrected;
+    victim->lastUse = _commitCacheClock;
+    return _state;
+}
+
+template <typename Config>
+TelexStates TelexEngineT<Config>::CommitUncached() {
     if (_state == TelexStates::Committed || _state == TelexStates::CommittedInvalid ||
         _state == TelexStates::BackconvertFailed) {
         return _state;
@@ -530,94 +853,60 @@ TelexStates TelexEngine::Commit() {
         return _state;
     }
 
-    if (_state == TelexStates::Valid && _config.optimize_multilang >= 1) {
+    if (_state == TelexStates::Valid && OptimizeMultilang() >= 1) {
         auto wordBuffer = _keyBuffer;
-        for (auto& c : wordBuffer) {
-            c = ToLower(c);
-        }
+        ToLowerRun(std::span<wchar_t>(wordBuffer.begin(), wordBuffer.size()));
         if (wlist_en.find(wordBuffer) != wlist_en.end()) {
             _state = TelexStates::CommittedInvalid;
             assert(CheckInvariants());
             return _state;
         }
-        if (_config.autocorrect && wlist_en_ac.find(wordBuffer) != wlist_en_ac.end()) {
+        if (Autocorrect() && wlist_en_ac.find(wordBuffer) != wlist_en_ac.end()) {
             _state = TelexStates::CommittedInvalid;
             assert(CheckInvariants());
             return _state;
         }
-        if (_config.optimize_multilang >= 2 && wlist_en_2.find(wordBuffer) != wlist_en_2.end()) {
+        if (OptimizeMultilang() >= 2 && wlist_en_2.find(wordBuffer) != wlist_en_2.end()) {
+            _state = TelexStates::CommittedInvalid;
+            assert(CheckInvariants());
+            return _state;
+        }
+        if (_config.english_filter && _config.english_filter->Contains(wordBuffer)) {
             _state = TelexStates::CommittedInvalid;
             assert(CheckInvariants());
             return _state;
         }
     }
 
-    if (_config.autocorrect && _state == TelexStates::Valid && !_backconverted && _toneCount < 2) {
+    if (Autocorrect() && _state == TelexStates::Valid && !_backconverted && _toneCount < 2) {
+        const auto& rules = _config.autocorrect_rules ? *_config.autocorrect_rules : AutocorrectRules::Default();
+        unsigned conditions = 0;
+        if (!_c1.empty()) {
+            conditions |= AutocorrectHasC1;
+        }
+        if (HasValidRespos()) {
+            conditions |= AutocorrectValidRespos;
+        }
+        if (OptimizeMultilang() <= 1) {
+            conditions |= AutocorrectMultilangLow;
+        }
+        auto rewrite = rules.Find(_c1, _v, _c2, _t, conditions);
         // fixing respos might not be necessary here but fixing cases is
-        if (_v == L"wu") {
-            _v = L"\x1b0u";
-            _autocorrected = true;
-        } else if (!_c1.empty() && _v == L"wo") {
-            _v = L"\x1a1";
-            for (auto& rp : _respos)
-                if (rp & ResposAutocorrect)
-                    _cases.erase(_cases.begin() + (rp & ResposMask));
-            _autocorrected = true;
-        } else if (_v == L"wuo") {
-            _v = L"\x1b0\x1a1";
-            for (auto& rp : _respos)
-                if (rp & ResposAutocorrect)
-                    _cases.erase(_cases.begin() + (rp & ResposMask));
+        if (rewrite.v) {
+            ResizeCases(_c1.size(), _v.size(), rewrite.v->size());
+            _v = *rewrite.v;
             _autocorrected = true;
         }
-        if (_c2 == L"h" && (_v == L"a" || _v == L"\xea")) {
-            if (_t == Tones::S || _t == Tones::J) {
-                _c2 = L"ch";
-                _cases.push_back(_cases[_c1.length() + _v.length()]);
-                _autocorrected = true;
-            } else if (_config.optimize_multilang <= 1 || HasValidRespos()) {
-                _c2 = L"nh";
-                _cases.push_back(_cases[_c1.length() + _v.length()]);
-                _autocorrected = true;
-            }
-        }
-        if (HasValidRespos()) {
-            if (_c2 == L"gn") {
-                _c2 = L"ng";
-                _autocorrected = true;
-            } else if (_config.optimize_multilang <= 1 && _c2 == L"g") {
-                _c2 = L"ng";
-                _cases.push_back(_cases.back());
-                _autocorrected = true;
-            }
+        if (rewrite.c2) {
+            ResizeCases(_c1.size() + _v.size(), _c2.size(), rewrite.c2->size());
+            _c2 = *rewrite.c2;
+            _autocorrected = true;
         }
     }
 
-    // validate c1
-    auto c1_it = valid_c1.find(_c1);
-    if (c1_it == valid_c1.end()) {
-        _state = TelexStates::CommittedInvalid;
-        assert(CheckInvariants());
-        return _state;
-    }
-
-    // validate c2
-    auto c2_it = valid_c2.find(_c2);
-    if (c2_it == valid_c2.end()) {
-        _state = TelexStates::CommittedInvalid;
-        assert(CheckInvariants());
-        return _state;
-    }
-    if (c2_it->second && !(_t == Tones::S || _t == Tones::J)) {
-        _state = TelexStates::CommittedInvalid;
-        assert(CheckInvariants());
-        return _state;
-    }
-
-    // validate v and get tone position
-    VInfo vinfo;
-    auto found = GetTonePos(false, &vinfo);
-    if (!found) {
+    // c1, v, c2 and the tone are validated together by the enumerated syllable table
+    auto syllable = SyllableTable::Get().Find(_c1, _v, _c2, OaUyTone1());
+    if (!syllable || !syllable->toned[static_cast<int>(_t)]) {
         _state = TelexStates::CommittedInvalid;
         assert(CheckInvariants());
         return _state;
@@ -625,29 +914,20 @@ TelexStates TelexEngine::Commit() {
 
     // routine changes buffers from this point
 
-    if (vinfo.tonepos < 0 && _c1 == L"gi" && _v.empty()) {
+    if (syllable->moveGi) {
         // fixup 'gi' by moving 'i' to _v
         _c1.pop_back();
         _v.push_back(L'i');
-        vinfo.tonepos = 0;
-    } else if (vinfo.c2mode == C2Mode::MustC2 && !_c2.size()) {
-        _state = TelexStates::CommittedInvalid;
-        assert(CheckInvariants());
-        return _state;
-    } else if (vinfo.c2mode == C2Mode::NoC2 && _c2.size()) {
-        _state = TelexStates::CommittedInvalid;
-        assert(CheckInvariants());
-        return _state;
     }
-
-    _v[vinfo.tonepos] = TranslateTone(_v[vinfo.tonepos], _t);
+    _v[syllable->tonepos] = syllable->toned[static_cast<int>(_t)];
     _state = TelexStates::Committed;
 
     assert(CheckInvariants());
     return _state;
 }
 
-TelexStates TelexEngine::ForceCommit() {
+template <typename Config>
+TelexStates TelexEngineT<Config>::ForceCommit() {
     if (_state == TelexStates::Committed || _state == TelexStates::CommittedInvalid ||
         _state == TelexStates::BackconvertFailed) {
         return _state;
@@ -670,6 +950,12 @@ TelexStates TelexEngine::ForceCommit() {
         assert(CheckInvariants());
         return _state;
     }
+    if (vinfo.tonepos < 0 && _c1 == L"gi" && _v.empty()) {
+        // fixup 'gi' by moving 'i' to _v, same as Commit
+        _c1.pop_back();
+        _v.push_back(L'i');
+        vinfo.tonepos = 0;
+    }
     _v[vinfo.tonepos] = TranslateTone(_v[vinfo.tonepos], _t);
 
     _state = TelexStates::Committed;
@@ -677,10 +963,13 @@ TelexStates TelexEngine::ForceCommit() {
     return _state;
 }
 
-TelexStates TelexEngine::Cancel() {
+template <typename Config>
+TelexStates TelexEngineT<Config>::Cancel() {
     if (_backconverted && _c1.size() + _v.size() + _c2.size() != _keyBuffer.size()) {
-        auto s = Peek();
-        _keyBuffer = s;
+        std::array<wchar_t, MaxKeyBufferLength> buffer;
+        SpanWriter out(buffer);
+        PeekTo(out);
+        _keyBuffer = std::wstring_view(buffer.data(), out.written().size());
         _state = TelexStates::BackconvertFailed;
     } else {
         _state = TelexStates::CommittedInvalid;
@@ -689,7 +978,177 @@ TelexStates TelexEngine::Cancel() {
     return _state;
 }
 
-TelexStates TelexEngine::Backconvert(_In_ const std::wstring& s) {
+template <typename Config>
+TelexStates TelexEngineT<Config>::Backconvert(_In_ std::wstring_view s) {
+    assert(!_keyBuffer.size());
+    if (_keyBuffer.size())
+        return _state;
+    if (!BackconvertDirect(s)) {
+        return BackconvertReplay(s);
+    }
+    return _state;
+}
+
+// builds the word from its parts instead of pushing every key: c1 and c2 are copied in key by key and the vowel
+// nucleus comes out of BackconvertTable
+// returns false without touching the engine for anything else, which is left to BackconvertReplay
+template <typename Config>
+bool TelexEngineT<Config>::BackconvertDirect(std::wstring_view s) {
+    // every character is at least one key
+    if (_state != TelexStates::Valid || s.size() > MaxLength) {
+        return false;
+    }
+    const auto& table = BackconvertTable::Get();
+    std::array<BackconvertChar, MaxLength> parts;
+    bool found_backconversion = false;
+    for (size_t i = 0; i < s.size(); i++) {
+        parts[i] = table.Decompose(s[i]);
+        if (parts[i].keys.empty()) {
+            return false;
+        }
+        found_backconversion |= s[i] > L'z';
+    }
+
+    // 'đ' is the only character whose keys start with a consonant
+    auto isDd = [](std::wstring_view keys) { return keys.size() == 2 && keys[0] == L'd'; };
+
+    // c1, only the letters that PushChar would append to it as they are
+    size_t i = 0;
+    size_t nkeys = 0;
+    for (; i < s.size(); i++) {
+        auto keys = parts[i].keys;
+        if (i == 0 && isDd(keys)) {
+            nkeys += 2;
+            continue;
+        }
+        auto cat = ClassifyCharacter(keys[0]);
+        if (keys.size() != 1 || IS(cat, CharTypes::Vowel) || IS(cat, CharTypes::VowelW)) {
+            break;
+        }
+        if (i == 0 ? !IS(cat, CharTypes::ConsoC1) : keys[0] == L'd' || !IS(cat, CharTypes::ConsoContinue)) {
+            return false;
+        }
+        nkeys++;
+    }
+    auto c1end = i;
+    auto c1kind = BackconvertC1::Other;
+    // the nucleus, with the tone of a 'gi' as a character of its own
+    std::array<std::wstring_view, BackconvertNucleus::MaxChars> nucleus;
+    std::array<bool, BackconvertNucleus::MaxChars> nucleusUpper;
+    size_t nchars = 0;
+    if (c1end == 1 && parts[0].keys[0] == L'q') {
+        c1kind = BackconvertC1::Q;
+    } else if (c1end == 1 && parts[0].keys[0] == L'g' && i < s.size() && parts[i].keys[0] == L'i') {
+        c1kind = BackconvertC1::Gi;
+        nkeys++;
+        if (parts[i].keys.size() > 1) {
+            nucleus[nchars] = parts[i].keys.substr(1);
+            nucleusUpper[nchars++] = parts[i].upper;
+        }
+        c1end = ++i;
+    }
+    for (; i < s.size() && IS(ClassifyCharacter(parts[i].keys[0]), CharTypes::Vowel); i++) {
+        if (nchars >= nucleus.size()) {
+            return false;
+        }
+        nucleus[nchars] = parts[i].keys;
+        nucleusUpper[nchars++] = parts[i].upper;
+    }
+    auto found = table.Find(
+        c1kind, std::span(nucleus.data(), nchars), OaUyTone1(), OptimizeMultilang() >= 3);
+    if (!found) {
+        return false;
+    }
+    nkeys += found->keyCount;
+
+    // c2, a word-ending consonant and maybe one continuation
+    auto c2begin = i;
+    for (; i < s.size(); i++) {
+        auto keys = parts[i].keys;
+        if (keys.size() != 1) {
+            return false;
+        }
+        if (i == c2begin) {
+            // only a c2 after a vowel or "gi"; ConsoC2 includes the Conso bit, so every bit of it must be set
+            if ((ClassifyCharacter(keys[0]) & CharTypes::ConsoC2) != CharTypes::ConsoC2 ||
+                (found->v.empty() && c1kind != BackconvertC1::Gi)) {
+                return false;
+            }
+        } else if (i > c2begin + 1 || (keys[0] != L'g' && keys[0] != L'h')) {
+            return false;
+        }
+        nkeys++;
+    }
+    if (nkeys > MaxLength) {
+        return false;
+    }
+    auto c1dd = c1end == 1 && isDd(parts[0].keys);
+    if (c2begin < s.size() && !c1dd && found->t != Tones::Z && found->t != Tones::S &&
+        found->t != Tones::J) {
+        // special teencode exception, see PushChar
+        wchar_t tmpc2[2] = {parts[c2begin].keys[0], 0};
+        auto testtone = valid_c2.find(tmpc2);
+        if (testtone != valid_c2.end() && testtone->second) {
+            return false;
+        }
+    }
+
+    // the word checks out, build it
+    auto pushPart = [&](WordPartBuffer& part, wchar_t c, bool upper) {
+        SaveCheckpoint();
+        _keyBuffer.push_back(upper ? ToUpper(c) : c);
+        part.push_back(c);
+        _cases.push_back(upper);
+        PushRespos(_respos_current++);
+    };
+    for (i = 0; i < c1end; i++) {
+        pushPart(_c1, parts[i].keys[0], parts[i].upper);
+        if (isDd(parts[i].keys)) {
+            SaveCheckpoint();
+            _keyBuffer.push_back(parts[i].upper ? L'D' : L'd');
+            _c1[0] = L'\x111';
+            PushRespos(0 | ResposTransitionC1);
+        }
+    }
+
+    // the nucleus was recorded after an empty c1 unless c1 is "q" or "gi"
+    auto shift = c1kind == BackconvertC1::Other ? static_cast<int>(_c1.size()) : 0;
+    for (size_t k = 0; k < found->keyCount; k++) {
+        const auto& key = found->keys[k];
+        _checkpoints.push_back(Checkpoint{});
+        auto& cp = _checkpoints.back();
+        cp.v = std::wstring_view(key.v);
+        cp.c1front = _c1.empty() ? L'\0' : _c1[0];
+        cp.c1size = static_cast<uint8_t>(_c1.size());
+        cp.casesize = static_cast<uint8_t>(key.casesize + shift);
+        cp.respos_current = static_cast<uint8_t>(key.respos_current + shift);
+        cp.toneCount = key.toneCount;
+        cp.t = key.t;
+        cp.state = TelexStates::Valid;
+        _keyBuffer.push_back(nucleusUpper[key.source] ? ToUpper(key.key) : key.key);
+        PushRespos(key.respos + shift);
+    }
+    _v = std::wstring_view(found->v);
+    _t = found->t;
+    _toneCount = found->toneCount;
+    _respos_current = found->respos_current + shift;
+    for (size_t b = 0; b < found->caseCount; b++) {
+        _cases.push_back(nucleusUpper[found->caseSources[b]]);
+    }
+
+    for (i = c2begin; i < s.size(); i++) {
+        pushPart(_c2, parts[i].keys[0], parts[i].upper);
+        if (i == c2begin) {
+            _v = std::wstring_view(found->vc2);
+        }
+    }
+
+    FinishBackconvert(s, found_backconversion);
+    return true;
+}
+
+template <typename Config>
+TelexStates TelexEngineT<Config>::BackconvertReplay(_In_ std::wstring_view s) {
     assert(!_keyBuffer.size());
     if (_keyBuffer.size())
         return _state;
@@ -707,7 +1166,11 @@ TelexStates TelexEngine::Backconvert(_In_ const std::wstring& s) {
         } else {
             auto clow = ToLower(c);
             auto it = backconversions.find(clow);
-            assert(it != backconversions.end());
+            if (it == backconversions.end()) {
+                // not a letter at all, e.g. a digit the user typed after a failed backconversion
+                PushChar(c);
+                continue;
+            }
             if (double_flag && it->second[0] == _v[0]) {
                 if (c != clow) {
                     // c is upper
@@ -727,9 +1190,17 @@ TelexStates TelexEngine::Backconvert(_In_ const std::wstring& s) {
             found_backconversion = true;
         }
     }
+    FinishBackconvert(s, found_backconversion);
+    return _state;
+}
+
+template <typename Config>
+void TelexEngineT<Config>::FinishBackconvert(std::wstring_view s, bool found_backconversion) {
     if (_c1.size() + _v.size() + _c2.size() != s.size()) {
+        // the word is kept as given rather than as its keys type it, so the checkpoints no longer replay it
+        _checkpointsValid = false;
         if (found_backconversion) {
-            _keyBuffer = s;
+            _keyBuffer = s.substr(0, KeyBuffer::capacity());
             _state = TelexStates::BackconvertFailed;
         } else {
             _state = TelexStates::Invalid;
@@ -739,71 +1210,107 @@ TelexStates TelexEngine::Backconvert(_In_ const std::wstring& s) {
         _backconverted = true;
     }
     assert(CheckInvariants());
-    return _state;
 }
 
-std::wstring TelexEngine::Retrieve() const {
+// every output fits in MaxOutputLength, so the string overloads go through the span ones
+template <typename Config>
+std::wstring TelexEngineT<Config>::Retrieve() const {
+    std::array<wchar_t, MaxOutputLength> buffer;
+    return std::wstring(buffer.data(), Retrieve(buffer));
+}
+
+template <typename Config>
+std::wstring TelexEngineT<Config>::RetrieveRaw() const {
+    std::array<wchar_t, MaxOutputLength> buffer;
+    return std::wstring(buffer.data(), RetrieveRaw(buffer));
+}
+
+template <typename Config>
+std::wstring TelexEngineT<Config>::Peek() const {
+    std::array<wchar_t, MaxOutputLength> buffer;
+    return std::wstring(buffer.data(), Peek(buffer));
+}
+
+template <typename Config>
+std::size_t TelexEngineT<Config>::Retrieve(_Out_ std::span<wchar_t> buffer) const {
+    SpanWriter out(buffer);
+    RetrieveTo(out);
+    return out.size();
+}
+
+template <typename Config>
+std::size_t TelexEngineT<Config>::RetrieveRaw(_Out_ std::span<wchar_t> buffer) const {
+    SpanWriter out(buffer);
+    RetrieveRawTo(out);
+    return out.size();
+}
+
+template <typename Config>
+std::size_t TelexEngineT<Config>::Peek(_Out_ std::span<wchar_t> buffer) const {
+    SpanWriter out(buffer);
+    PeekTo(out);
+    return out.size();
+}
+
+template <typename Config>
+void TelexEngineT<Config>::RetrieveTo(SpanWriter& out) const {
     if (_state == TelexStates::Invalid || _state == TelexStates::CommittedInvalid ||
         _state == TelexStates::BackconvertFailed) {
-        return RetrieveRaw();
+        RetrieveRawTo(out);
+        return;
     }
-    std::wstring result(_c1);
-    result.append(_v);
-    result.append(_c2);
-    ApplyCases(result, _cases);
-    return result;
+    out.append(_c1);
+    out.append(_v);
+    out.append(_c2);
+    ApplyCases(out, _cases);
 }
 
-std::wstring TelexEngine::RetrieveRaw() const {
-    std::wstring result;
+template <typename Config>
+void TelexEngineT<Config>::RetrieveRawTo(SpanWriter& out) const {
     if (_state != TelexStates::BackconvertFailed) {
-        for (size_t i = 0; i < _keyBuffer.size(); i++)
+        auto head = std::min(_keyBuffer.size(), _respos.size());
+        for (size_t i = 0; i < head; i++)
             if (!(_respos[i] & ResposDoubleUndo))
-                result.push_back(_keyBuffer[i]);
+                out.push_back(_keyBuffer[i]);
+        // the rest of a long Invalid word is passed through as typed
+        out.append(std::wstring_view(_keyBuffer).substr(head));
     } else {
-        result = _keyBuffer;
+        out.append(_keyBuffer);
     }
-    return result;
 }
 
-std::wstring TelexEngine::Peek() const {
+template <typename Config>
+void TelexEngineT<Config>::PeekTo(SpanWriter& out) const {
     if (_state == TelexStates::Invalid || _state == TelexStates::CommittedInvalid ||
         _state == TelexStates::BackconvertFailed) {
-        return RetrieveRaw();
+        RetrieveRawTo(out);
+        return;
     }
 
-    std::wstring result(_c1);
-    result.append(_v);
-
     VInfo vinfo;
     auto found = GetTonePos(false, &vinfo);
-    if (!found) {
-        if (_t == Tones::Z) {
-            result.append(_c2);
-            ApplyCases(result, _cases);
-            return result;
-        } else {
-            return RetrieveRaw();
-        }
+    if (!found && _t != Tones::Z) {
+        RetrieveRawTo(out);
+        return;
     }
 
+    out.append(_c1);
+    out.append(_v);
+
     // fixup 'gi' then apply tone
-    if (vinfo.tonepos < 0 && _c1 == L"gi" && _v.empty()) {
+    if (found && vinfo.tonepos < 0 && _c1 == L"gi" && _v.empty()) {
         vinfo.tonepos = (int)_c1.size() - 1;
-        wchar_t vatpos = TranslateTone(_c1[vinfo.tonepos], _t);
-        result[vinfo.tonepos] = vatpos;
-    } else if (vinfo.tonepos >= 0) {
-        wchar_t vatpos = TranslateTone(_v[vinfo.tonepos], _t);
-        result[_c1.size() + vinfo.tonepos] = vatpos;
+        out.overwrite(vinfo.tonepos, TranslateTone(_c1[vinfo.tonepos], _t));
+    } else if (found && vinfo.tonepos >= 0) {
+        out.overwrite(_c1.size() + vinfo.tonepos, TranslateTone(_v[vinfo.tonepos], _t));
     }
 
-    result.append(_c2);
-    ApplyCases(result, _cases);
-
-    return result;
+    out.append(_c2);
+    ApplyCases(out, _cases);
 }
 
-bool TelexEngine::CheckInvariants() const {
+template <typename Config>
+bool TelexEngineT<Config>::CheckInvariants() const {
     if (_state == TelexStates::TxError) {
         return false;
     }
@@ -828,6 +1335,10 @@ bool TelexEngine::CheckInvariants() const {
         if (_keyBuffer.size() != _respos.size())
             return false;
     }
+    if (_state == TelexStates::Invalid) {
+        if (_respos.size() != std::min(_keyBuffer.size(), MaxResposLength))
+            return false;
+    }
     if (_state == TelexStates::Valid || _state == TelexStates::Committed) {
         if (_c1.size() + _v.size() + _c2.size() != _cases.size())
             return false;
@@ -835,12 +1346,64 @@ bool TelexEngine::CheckInvariants() const {
     return true;
 }
 
-bool TelexEngine::CheckInvariantsBackspace(TelexStates prevState) const {
+template <typename Config>
+bool TelexEngineT<Config>::CheckInvariantsBackspace(TelexStates prevState) const {
     if (prevState == TelexStates::Valid && _state != TelexStates::Valid) {
         return false;
     }
     return CheckInvariants();
 }
 
+template class TelexEngineT<TelexDynamicConfig>;
+
+template <bool OaUyTone1, bool AcceptSeparateDd, unsigned long OptimizeMultilang, bool Autocorrect>
+static ITelexEngine* NewFixedEngine(const TelexConfig& config) {
+    return new TelexEngineT<TelexFixedConfig<OaUyTone1, AcceptSeparateDd, OptimizeMultilang, Autocorrect>>(config);
+}
+
+template <size_t... I>
+static constexpr auto MakeEngineFactories(std::index_sequence<I...>) {
+    return std::array<ITelexEngine* (*)(const TelexConfig&), sizeof...(I)>{
+        &NewFixedEngine<!!(I & 1), !!(I & 2), (I >> 2) & 3, !!(I & 16)>...};
+}
+
+#ifdef VIETTYPE_LATENCY
+static ITelexEngine* WithLatency(ITelexEngine* engine) {
+    return new TelexLatencyEngine(std::unique_ptr<ITelexEngine>(engine), GlobalLatencyRecorder());
+}
+#else
+static constexpr ITelexEngine* WithLatency(ITelexEngine* engine) {
+    return engine;
+}
+#endif
+
+ITelexEngine* TelexNewDynamic(const TelexConfig& config) {
+    return WithLatency(new TelexEngine(config));
+}
+
+ITelexEngine* TelexNew(const TelexConfig& config) {
+    static constexpr auto factories = MakeEngineFactories(std::make_index_sequence<32>());
+    auto index = (config.oa_uy_tone1 ? 1 : 0) | (config.accept_separate_dd ? 2 : 0) |
+                 (std::min(config.optimize_multilang, 3ul) << 2) | (config.autocorrect ? 16 : 0);
+    return WithLatency(factories[index](config));
+}
+
+ITelexEngine* TelexNewFrom(const ITelexEngine& engine, const TelexConfig& config) {
+    std::unique_ptr<ITelexEngine> result(TelexNew(config));
+    TelexSnapshot snapshot;
+    if (engine.SaveSnapshot(snapshot)) {
+        result->RestoreSnapshotUnderNewConfig(snapshot);
+    } else {
+        // too long for a snapshot, such a word is typed again from its keys
+        for (auto c : engine.RetrieveRaw()) {
+            result->PushChar(c);
+        }
+        if (engine.GetState() == TelexStates::Committed || engine.GetState() == TelexStates::CommittedInvalid) {
+            result->Commit();
+        }
+    }
+    return result.release();
+}
+
 } // namespace Telex
 } // namespace VietType
@@ -3,13 +3,30 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <optional>
 #include <utility>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <cstdint>
+#include <vector>
+#include "Telex.h"
+#include "TelexBuffers.h"
+#include "TelexChars.h"
 
 namespace VietType {
 namespace Telex {
 
+constexpr size_t MaxLength = 10; // enough for "nghieengsz" and "nhuwowngxf"
+constexpr size_t MaxKeyBufferLength = MaxOutputLength;
+// PushChar stops accepting keys once this many are in the key buffer
+constexpr size_t MaxPushedKeys = 251;
+static_assert(MaxPushedKeys <= MaxKeyBufferLength);
+// c1/v/c2 only grow while the word is Valid, so they stay within MaxLength plus Commit fixups
+constexpr size_t MaxWordPartLength = 16;
+
 enum class Tones {
     Z,
     F,
@@ -30,89 +47,152 @@ struct VInfo {
     C2Mode c2mode;
 };
 
+// respos entries are packed into 16 bits: 8 bits of position and 8 flag bits
 enum ResposTransitions {
-    ResposExpunged = 0x40000000,
-    ResposDoubleUndo = 0x20000000,
-    ResposInvalidate = 0x10000000,
+    ResposExpunged = 0x8000,
+    ResposDoubleUndo = 0x4000,
+    ResposInvalidate = 0x2000,
     //
-    ResposTransitionC1 = 0x800000,
-    ResposTransitionV = 0x400000,
-    ResposTransitionW = 0x200000,
-    ResposTone = 0x100000,
-    ResposAutocorrect = 0x80000,
+    ResposTransitionC1 = 0x1000,
+    ResposTransitionV = 0x800,
+    ResposTransitionW = 0x400,
+    ResposTone = 0x200,
+    ResposAutocorrect = 0x100,
     //
     ResposMask = 0xff,
-    ResposValidMask = 0xff0000,
+    ResposValidMask = 0x1f00,
+};
+
+// respos are only stored for as many keys as there are checkpoints,
+// every key after that is pushed into an Invalid word and just takes the next position
+constexpr size_t MaxResposLength = MaxLength + 1;
+
+using KeyBuffer = InlineString<MaxKeyBufferLength>;
+using WordPartBuffer = InlineString<MaxWordPartLength>;
+using ResposBuffer = InlineVector<uint16_t, MaxKeyBufferLength>;
+using ResposHead = InlineVector<uint16_t, MaxResposLength>;
+static_assert(MaxKeyBufferLength - 1 <= ResposMask);
+static_assert(MaxLength + 2 <= MaxWordPartLength);
+static_assert(MaxLength + 2 <= CaseMask::capacity());
+
+/// <summary>
+/// config policy of TelexEngineT that reads every option from the TelexConfig, so SetConfig can change anything
+/// </summary>
+struct TelexDynamicConfig {
+    static constexpr bool IsFixed = false;
+};
+
+/// <summary>
+/// config policy of TelexEngineT that fixes the options checked while typing at compile time;
+/// backspaced_word_stays_invalid is only checked on Backspace and stays a runtime option
+/// </summary>
+template <bool OaUyTone1, bool AcceptSeparateDd, unsigned long OptimizeMultilang, bool Autocorrect>
+struct TelexFixedConfig {
+    static constexpr bool IsFixed = true;
+    static constexpr bool oa_uy_tone1 = OaUyTone1;
+    static constexpr bool accept_separate_dd = AcceptSeparateDd;
+    static constexpr unsigned long optimize_multilang = OptimizeMultilang;
+    static constexpr bool autocorrect = Autocorrect;
+
+    static constexpr bool Matches(const TelexConfig& config) {
+        // every level above 3 types the same as 3
+        return config.oa_uy_tone1 == oa_uy_tone1 && config.accept_separate_dd == accept_separate_dd &&
+               std::min(config.optimize_multilang, 3ul) == optimize_multilang && config.autocorrect == autocorrect;
+    }
 };
 
-enum class CharTypes : unsigned int {
-    Uncategorized = 0,
-    Vowel = 1 << 3,
-    VowelW = 1 << 4,
-    Conso = 1 << 5,
-    ConsoC1 = 1 << 5 | 1 << 6,
-    ConsoC2 = 1 << 5 | 1 << 7,
-    ConsoContinue = 1 << 5 | 1 << 8,
-    Tone = 1 << 9,
+// the commit cache is split into sets of this many entries, a word can only be kept in the set its keys hash to
+constexpr size_t CommitCacheWays = 4;
+// room for c1, v and c2 in a commit cache entry, as many as the longest syllable has
+constexpr size_t CommitCacheMaxParts = 8;
+
+struct CommitCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // entries dropped to make room, always the least recently used of their set
+    uint64_t evictions = 0;
 };
 
-constexpr CharTypes operator|(CharTypes lhs, CharTypes rhs) {
-    return static_cast<CharTypes>(static_cast<unsigned int>(lhs) | static_cast<unsigned int>(rhs));
-}
-
-constexpr CharTypes operator&(CharTypes lhs, CharTypes rhs) {
-    return static_cast<CharTypes>(static_cast<unsigned int>(lhs) & static_cast<unsigned int>(rhs));
-}
-
-static const CharTypes letterClasses[26] = {
-    CharTypes::Vowel,                                                // a
-    CharTypes::ConsoC1,                                              // b
-    CharTypes::ConsoC1 | CharTypes::ConsoC2,                         // c
-    CharTypes::ConsoC1 | CharTypes::ConsoContinue,                   // d
-    CharTypes::Vowel,                                                // e
-    CharTypes::Tone,                                                 // f
-    CharTypes::ConsoC1 | CharTypes::ConsoContinue,                   // g
-    CharTypes::ConsoC1 | CharTypes::ConsoContinue,                   // h
-    CharTypes::Vowel,                                                // i
-    CharTypes::Tone,                                                 // j
-    CharTypes::ConsoC1,                                              // k
-    CharTypes::ConsoC1,                                              // l
-    CharTypes::ConsoC1 | CharTypes::ConsoC2,                         // m
-    CharTypes::ConsoC1 | CharTypes::ConsoC2,                         // n
-    CharTypes::Vowel,                                                // o
-    CharTypes::ConsoC1 | CharTypes::ConsoC2,                         // p
-    CharTypes::ConsoC1,                                              // q
-    CharTypes::Tone | CharTypes::ConsoC1 | CharTypes::ConsoContinue, // r
-    CharTypes::Tone | CharTypes::ConsoC1 | CharTypes::ConsoContinue, // s
-    CharTypes::ConsoC1 | CharTypes::ConsoC2,                         // t
-    CharTypes::Vowel,                                                // u
-    CharTypes::ConsoC1,                                              // v
-    CharTypes::VowelW,                                               // w
-    CharTypes::Tone | CharTypes::ConsoC1,                            // x
-    CharTypes::Vowel,                                                // y
-    CharTypes::Tone,                                                 // z
+/// <summary>
+/// the part of the word state that a single PushChar can change, saved before the key is processed;
+/// _c1 is only ever appended to or rewritten from 'd' to '\x111', so its first character is enough
+/// </summary>
+struct TelexCheckpoint {
+    WordPartBuffer v;
+    wchar_t c1front;
+    uint8_t c1size;
+    uint8_t c2size;
+    uint8_t casesize;
+    uint8_t respos_current;
+    uint8_t toneCount;
+    Tones t;
+    TelexStates state;
 };
 
-class TelexEngine : public ITelexEngine {
+/// <summary>
+/// the word a TelexEngineT is in the middle of, without its config and commit cache;
+/// trivially copyable so that it can be kept in flat storage, words of more than MaxKeys keys are not saved
+/// </summary>
+struct TelexSnapshot {
+    static constexpr std::size_t MaxKeys = 32;
+
+    InlineString<MaxKeys> keys;
+    ResposHead respos;
+    WordPartBuffer c1;
+    WordPartBuffer v;
+    WordPartBuffer c2;
+    CaseMask cases;
+    InlineVector<TelexCheckpoint, MaxLength + 1> checkpoints;
+    TelexStates state;
+    Tones t;
+    uint8_t toneCount;
+    uint8_t respos_current;
+    bool backconverted;
+    bool autocorrected;
+    bool checkpointsValid;
+};
+static_assert(std::is_trivially_copyable_v<TelexSnapshot>);
+
+template <typename Config>
+class TelexEngineT : public ITelexEngine {
 public:
-    explicit TelexEngine(const TelexConfig& config);
-    TelexEngine(const TelexEngine&) = delete;
-    TelexEngine& operator=(const TelexEngine&) = delete;
-    TelexEngine(TelexEngine&&) = default;
-    TelexEngine& operator=(TelexEngine&&) = default;
-    virtual ~TelexEngine() {
+    /// <summary>
+    /// throws std::invalid_argument if the config does not match a fixed Config
+    /// </summary>
+    explicit TelexEngineT(const TelexConfig& config);
+    TelexEngineT(const TelexEngineT&) = default;
+    TelexEngineT& operator=(const TelexEngineT&) = default;
+    TelexEngineT(TelexEngineT&&) = default;
+    TelexEngineT& operator=(TelexEngineT&&) = default;
+    virtual ~TelexEngineT() {
     }
 
     const TelexConfig& GetConfig() const override;
-    void SetConfig(const TelexConfig& config) override;
+    /// <summary>
+    /// false and nothing changed if the config does not match a fixed Config
+    /// </summary>
+    bool SetConfig(const TelexConfig& config) override;
 
     void Reset() override;
     TelexStates PushChar(_In_ wchar_t c) override;
     TelexStates Backspace() override;
+    /// <summary>
+    /// reference implementation of Backspace that rebuilds the word by replaying the remaining keys;
+    /// Backspace must always give the same result
+    /// </summary>
+    TelexStates BackspaceReplay();
     TelexStates Commit() override;
     TelexStates ForceCommit() override;
     TelexStates Cancel() override;
-    TelexStates Backconvert(_In_ const std::wstring& s) override;
+    TelexStates Backconvert(_In_ std::wstring_view s) override;
+    /// <summary>
+    /// reference implementation of Backconvert that pushes the keys of every character one by one;
+    /// Backconvert must always give the same result
+    /// </summary>
+    TelexStates BackconvertReplay(_In_ std::wstring_view s);
+    bool SaveSnapshot(_Out_ TelexSnapshot& snapshot) const override;
+    void RestoreSnapshot(_In_ const TelexSnapshot& snapshot) override;
+    void RestoreSnapshotUnderNewConfig(_In_ const TelexSnapshot& snapshot) override;
 
     constexpr TelexStates GetState() const override {
         return _state;
@@ -120,6 +200,9 @@ public:
     std::wstring Retrieve() const override;
     std::wstring RetrieveRaw() const override;
     std::wstring Peek() const override;
+    std::size_t Retrieve(_Out_ std::span<wchar_t> buffer) const override;
+    std::size_t RetrieveRaw(_Out_ std::span<wchar_t> buffer) const override;
+    std::size_t Peek(_Out_ std::span<wchar_t> buffer) const override;
     constexpr std::wstring::size_type Count() const override {
         return _keyBuffer.size();
     }
@@ -127,8 +210,15 @@ public:
     constexpr Tones GetTone() const {
         return _t;
     }
-    constexpr const std::vector<int>& GetRespos() const {
-        return _respos;
+    /// <summary>
+    /// respos of every key, including the ones past MaxResposLength that are not stored
+    /// </summary>
+    ResposBuffer GetRespos() const;
+    /// <summary>
+    /// case bits of c1, v and c2 in order, only meaningful when Valid or Committed
+    /// </summary>
+    constexpr const CaseMask& GetCases() const {
+        return _cases;
     }
     constexpr bool IsBackconverted() const {
         return _backconverted;
@@ -136,6 +226,12 @@ public:
     constexpr bool IsAutocorrected() const {
         return _autocorrected;
     }
+    /// <summary>
+    /// counted since the engine was created, SetConfig empties the cache but keeps the counts
+    /// </summary>
+    constexpr const CommitCacheStats& GetCommitCacheStats() const {
+        return _commitCacheStats;
+    }
 
     bool CheckInvariants() const;
 
@@ -144,32 +240,106 @@ private:
 
     TelexStates _state = TelexStates::Valid;
 
-    std::wstring _keyBuffer;
-    std::wstring _c1;
-    std::wstring _v;
-    std::wstring _c2;
+    KeyBuffer _keyBuffer;
+    WordPartBuffer _c1;
+    WordPartBuffer _v;
+    WordPartBuffer _c2;
     Tones _t = Tones::Z;
     int _toneCount = 0;
-    // don't use bool vector since that's special cased in the STL
     /// <summary>
     /// only use when valid;
     /// 1 = uppercase, 0 = lowercase
     /// </summary>
-    std::vector<int> _cases;
+    CaseMask _cases;
     /// <summary>
     /// for each character in the _keyBuffer, record which output character it's responsible for,
     /// e.g. 'đuống' (dduoongs) _respos = 00122342 (T = tone, C = transition _c1, V = transition _v)
     ///                                    C  V  T
-    /// note that respos position masks are only valid if state is Valid
+    /// note that respos position masks are only valid if state is Valid;
+    /// only the first MaxResposLength keys are stored, see GetRespos()
     /// </summary>
-    std::vector<int> _respos;
+    ResposHead _respos;
     int _respos_current = 0;
     bool _backconverted = false;
     bool _autocorrected = false;
 
+    using Checkpoint = TelexCheckpoint;
+    /// <summary>
+    /// one checkpoint per key for the first MaxLength + 1 keys;
+    /// every key after that is pushed into an Invalid word and only appends to _keyBuffer
+    /// </summary>
+    InlineVector<Checkpoint, MaxLength + 1> _checkpoints;
+    /// <summary>
+    /// false if the current word is not the result of pushing _keyBuffer from Reset (e.g. after SetConfig),
+    /// in which case Backspace falls back to replaying
+    /// </summary>
+    bool _checkpointsValid = true;
+
+    /// <summary>
+    /// the state Commit leaves behind for a word typed from Reset, keyed by PackCommitKey of its raw keys;
+    /// c1, v and c2 are kept one after the other as UTF-16 code units, and words whose parts do not fit are not cached
+    /// </summary>
+    struct CommitCacheEntry {
+        // 0 if the entry is free
+        uint64_t key;
+        std::array<char16_t, CommitCacheMaxParts> parts;
+        uint8_t c1Size;
+        uint8_t vSize;
+        uint8_t c2Size;
+        uint8_t cases;
+        bool committedInvalid;
+        bool autocorrected;
+        // low bits of _commitCacheClock, compared by distance so that wrapping around only ages the entry
+        uint16_t lastUse;
+    };
+    static_assert(sizeof(CommitCacheEntry) == 32);
+    /// <summary>
+    /// empty if the cache is disabled
+    /// </summary>
+    std::vector<CommitCacheEntry> _commitCache;
+    /// <summary>
+    /// per set, the key of the last word that missed without being inserted; a word is only inserted when it misses
+    /// again before another word misses in the same set, so words typed once do not evict the ones typed often
+    /// </summary>
+    std::vector<uint64_t> _commitCacheSeen;
+    uint16_t _commitCacheClock = 0;
+    CommitCacheStats _commitCacheStats;
+
 private:
     friend struct TelexEngineImpl;
+    friend class BackconvertTable;
     bool CheckInvariantsBackspace(TelexStates prevState) const;
+    void ResetCommitCache();
+    TelexStates CommitUncached();
+
+    constexpr bool OaUyTone1() const {
+        if constexpr (Config::IsFixed) {
+            return Config::oa_uy_tone1;
+        } else {
+            return _config.oa_uy_tone1;
+        }
+    }
+    constexpr bool AcceptSeparateDd() const {
+        if constexpr (Config::IsFixed) {
+            return Config::accept_separate_dd;
+        } else {
+            return _config.accept_separate_dd;
+        }
+    }
+    constexpr unsigned long OptimizeMultilang() const {
+        if constexpr (Config::IsFixed) {
+            return Config::optimize_multilang;
+        } else {
+            return _config.optimize_multilang;
+        }
+    }
+    constexpr bool Autocorrect() const {
+        if constexpr (Config::IsFixed) {
+            return Config::autocorrect;
+        } else {
+            return _config.autocorrect;
+        }
+    }
 
     template <typename T>
     bool TransitionV(const T& source, bool w_mode = false) {
@@ -183,13 +353,31 @@ private:
         }
     }
 
+    void PushRespos(int rp) {
+        _respos.push_back(static_cast<uint16_t>(rp));
+    }
     void Invalidate();
     void InvalidateAndPopBack(wchar_t c);
     std::optional<std::pair<std::wstring_view, VInfo>> FindTable() const;
     bool GetTonePos(_In_ bool predict, _Out_ VInfo* vinfo) const;
     void ReapplyTone();
     bool HasValidRespos() const;
+    void ResizeCases(size_t start, size_t from, size_t to);
+    void SaveCheckpoint();
+    void RestoreCheckpoint(size_t count);
+    TelexStates BackspaceInvalid();
+    bool BackconvertDirect(std::wstring_view s);
+    void FinishBackconvert(std::wstring_view s, bool found_backconversion);
+    void RetrieveTo(SpanWriter& out) const;
+    void RetrieveRawTo(SpanWriter& out) const;
+    void PeekTo(SpanWriter& out) const;
 };
 
+extern template class TelexEngineT<TelexDynamicConfig>;
+/// <summary>
+/// the engine that takes any config; TelexNew returns an engine with the config fixed instead
+/// </summary>
+using TelexEngine = TelexEngineT<TelexDynamicConfig>;
+
 } // namespace Telex
 } // namespace VietType
@@ -0,0 +1,247 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <chrono>
+#include "TelexLatency.h"
+
+namespace VietType {
+namespace Telex {
+
+const wchar_t* LatencyOpName(LatencyOp op) {
+    switch (op) {
+    case LatencyOp::PushChar:
+        return L"PushChar";
+    case LatencyOp::Backspace:
+        return L"Backspace";
+    case LatencyOp::Commit:
+        return L"Commit";
+    case LatencyOp::ForceCommit:
+        return L"ForceCommit";
+    case LatencyOp::Cancel:
+        return L"Cancel";
+    case LatencyOp::Backconvert:
+        return L"Backconvert";
+    case LatencyOp::Reset:
+        return L"Reset";
+    case LatencyOp::Peek:
+        return L"Peek";
+    case LatencyOp::Retrieve:
+        return L"Retrieve";
+    }
+    return L"?";
+}
+
+const wchar_t* LatencyStateName(TelexStates state) {
+    switch (state) {
+    case TelexStates::Valid:
+        return L"Valid";
+    case TelexStates::Invalid:
+        return L"Invalid";
+    case TelexStates::Committed:
+        return L"Committed";
+    case TelexStates::CommittedInvalid:
+        return L"CommittedInvalid";
+    case TelexStates::BackconvertFailed:
+        return L"BackconvertFailed";
+    case TelexStates::TxError:
+        return L"TxError";
+    }
+    return L"?";
+}
+
+uint64_t LatencyHistogram::AddTo(std::span<uint64_t> counts) const {
+    for (std::size_t i = 0; i < BucketCount; i++) {
+        counts[i] += _buckets[i].load(std::memory_order_relaxed);
+    }
+    return _max.load(std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Clear() {
+    for (auto& b : _buckets) {
+        b.store(0, std::memory_order_relaxed);
+    }
+    _max.store(0, std::memory_order_relaxed);
+}
+
+// the percentiles are the highest latency of the bucket they fall in, but never above the real maximum
+static LatencySummary Summarize(
+    LatencyOp op, TelexStates from, TelexStates to, std::span<const uint64_t> counts, uint64_t max) {
+    LatencySummary summary{op, from, to, 0, 0, 0, 0, max};
+    for (auto c : counts) {
+        summary.count += c;
+    }
+    auto percentile = [&](uint64_t permille) {
+        // the rank of the sample at the percentile, rounded up
+        auto rank = std::max<uint64_t>((summary.count * permille + 999) / 1000, 1);
+        uint64_t seen = 0;
+        for (std::size_t i = 0; i < counts.size(); i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return std::min(LatencyHistogram::BucketLimit(i), max);
+            }
+        }
+        return max;
+    };
+    if (summary.count) {
+        summary.p50 = percentile(500);
+        summary.p99 = percentile(990);
+        summary.p999 = percentile(999);
+    }
+    return summary;
+}
+
+static constexpr std::array<TelexStates, LatencyStateCount> latencyStates{
+    TelexStates::TxError,
+    TelexStates::Valid,
+    TelexStates::Invalid,
+    TelexStates::Committed,
+    TelexStates::CommittedInvalid,
+    TelexStates::BackconvertFailed,
+};
+
+LatencySnapshot LatencyRecorder::Snapshot() const {
+    LatencySnapshot snapshot;
+    std::vector<uint64_t> opCounts(LatencyHistogram::BucketCount);
+    std::vector<uint64_t> counts(LatencyHistogram::BucketCount);
+    for (std::size_t o = 0; o < LatencyOpCount; o++) {
+        auto op = static_cast<LatencyOp>(o);
+        std::fill(opCounts.begin(), opCounts.end(), 0);
+        uint64_t opMax = 0;
+        for (auto from : latencyStates) {
+            for (auto to : latencyStates) {
+                std::fill(counts.begin(), counts.end(), 0);
+                auto max = _histograms[Index(op, from, to)].AddTo(counts);
+                auto summary = Summarize(op, from, to, counts, max);
+                if (!summary.count) {
+                    continue;
+                }
+                snapshot.transitions.push_back(summary);
+                for (std::size_t i = 0; i < counts.size(); i++) {
+                    opCounts[i] += counts[i];
+                }
+                opMax = std::max(opMax, max);
+            }
+        }
+        auto summary = Summarize(op, TelexStates::TxError, TelexStates::TxError, opCounts, opMax);
+        if (summary.count) {
+            snapshot.operations.push_back(summary);
+        }
+    }
+    return snapshot;
+}
+
+void LatencyRecorder::Clear() {
+    for (auto& h : _histograms) {
+        h.Clear();
+    }
+}
+
+LatencyRecorder& GlobalLatencyRecorder() {
+    static LatencyRecorder recorder;
+    return recorder;
+}
+
+TelexLatencyEngine::TelexLatencyEngine(std::unique_ptr<ITelexEngine> engine, LatencyRecorder& recorder)
+    : _engine(std::move(engine)), _recorder(&recorder) {
+}
+
+template <typename F>
+auto TelexLatencyEngine::Timed(LatencyOp op, F f) const {
+    auto from = _engine->GetState();
+    auto t1 = std::chrono::steady_clock::now();
+    auto result = f();
+    auto t2 = std::chrono::steady_clock::now();
+    _recorder->Record(
+        op,
+        from,
+        _engine->GetState(),
+        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count()));
+    return result;
+}
+
+const TelexConfig& TelexLatencyEngine::GetConfig() const {
+    return _engine->GetConfig();
+}
+
+bool TelexLatencyEngine::SetConfig(const TelexConfig& config) {
+    return _engine->SetConfig(config);
+}
+
+void TelexLatencyEngine::Reset() {
+    Timed(LatencyOp::Reset, [this] {
+        _engine->Reset();
+        return 0;
+    });
+}
+
+TelexStates TelexLatencyEngine::PushChar(_In_ wchar_t c) {
+    return Timed(LatencyOp::PushChar, [&] { return _engine->PushChar(c); });
+}
+
+TelexStates TelexLatencyEngine::Backspace() {
+    return Timed(LatencyOp::Backspace, [this] { return _engine->Backspace(); });
+}
+
+TelexStates TelexLatencyEngine::Commit() {
+    return Timed(LatencyOp::Commit, [this] { return _engine->Commit(); });
+}
+
+TelexStates TelexLatencyEngine::ForceCommit() {
+    return Timed(LatencyOp::ForceCommit, [this] { return _engine->ForceCommit(); });
+}
+
+TelexStates TelexLatencyEngine::Cancel() {
+    return Timed(LatencyOp::Cancel, [this] { return _engine->Cancel(); });
+}
+
+TelexStates TelexLatencyEngine::Backconvert(_In_ std::wstring_view s) {
+    return Timed(LatencyOp::Backconvert, [&] { return _engine->Backconvert(s); });
+}
+
+TelexStates TelexLatencyEngine::GetState() const {
+    return _engine->GetState();
+}
+
+std::wstring TelexLatencyEngine::Retrieve() const {
+    return Timed(LatencyOp::Retrieve, [this] { return _engine->Retrieve(); });
+}
+
+std::wstring TelexLatencyEngine::RetrieveRaw() const {
+    return _engine->RetrieveRaw();
+}
+
+std::wstring TelexLatencyEngine::Peek() const {
+    return Timed(LatencyOp::Peek, [this] { return _engine->Peek(); });
+}
+
+std::size_t TelexLatencyEngine::Retrieve(_Out_ std::span<wchar_t> buffer) const {
+    return Timed(LatencyOp::Retrieve, [&] { return _engine->Retrieve(buffer); });
+}
+
+std::size_t TelexLatencyEngine::RetrieveRaw(_Out_ std::span<wchar_t> buffer) const {
+    return _engine->RetrieveRaw(buffer);
+}
+
+std::size_t TelexLatencyEngine::Peek(_Out_ std::span<wchar_t> buffer) const {
+    return Timed(LatencyOp::Peek, [&] { return _engine->Peek(buffer); });
+}
+
+std::wstring::size_type TelexLatencyEngine::Count() const {
+    return _engine->Count();
+}
+
+bool TelexLatencyEngine::SaveSnapshot(_Out_ TelexSnapshot& snapshot) const {
+    return _engine->SaveSnapshot(snapshot);
+}
+
+void TelexLatencyEngine::RestoreSnapshot(_In_ const TelexSnapshot& snapshot) {
+    _engine->RestoreSnapshot(snapshot);
+}
+
+void TelexLatencyEngine::RestoreSnapshotUnderNewConfig(_In_ const TelexSnapshot& snapshot) {
+    _engine->RestoreSnapshotUnderNewConfig(snapshot);
+}
+
+} // namespace Telex
+} // namespace VietType
@@ -0,0 +1,197 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Telex.h"
+
+namespace VietType {
+namespace Telex {
+
+// Define VIETTYPE_LATENCY to have TelexNew and TelexNewDynamic wrap every engine in a TelexLatencyEngine reporting
+// to GlobalLatencyRecorder. Without it the engines are returned as they are and nothing is measured.
+#ifdef VIETTYPE_LATENCY
+constexpr bool LatencyEnabled = true;
+#else
+constexpr bool LatencyEnabled = false;
+#endif
+
+enum class LatencyOp {
+    PushChar,
+    Backspace,
+    Commit,
+    ForceCommit,
+    Cancel,
+    Backconvert,
+    Reset,
+    Peek,
+    Retrieve,
+};
+
+constexpr std::size_t LatencyOpCount = static_cast<std::size_t>(LatencyOp::Retrieve) + 1;
+// TxError and every TelexStates value
+constexpr std::size_t LatencyStateCount = 6;
+
+const wchar_t* LatencyOpName(LatencyOp op);
+const wchar_t* LatencyStateName(TelexStates state);
+
+/// <summary>
+/// log-linear histogram of nanosecond latencies: every power of two is split into 2^LatencySubBits buckets,
+/// so a percentile is never more than 1/2^LatencySubBits above the real value;
+/// Record is lock-free and can be called from any thread
+/// </summary>
+class LatencyHistogram {
+public:
+    static constexpr unsigned int SubBits = 4;
+    static constexpr uint64_t SubCount = 1 << SubBits;
+    // everything from about 4.3 s up lands in the last bucket
+    static constexpr unsigned int MaxExponent = 31;
+    static constexpr std::size_t BucketCount = (MaxExponent - SubBits + 2) * SubCount;
+
+    static constexpr std::size_t BucketOf(uint64_t ns) {
+        if (ns < SubCount) {
+            return static_cast<std::size_t>(ns);
+        }
+        unsigned int exponent = 0;
+        for (auto v = ns; v >>= 1;) {
+            exponent++;
+        }
+        if (exponent > MaxExponent) {
+            return BucketCount - 1;
+        }
+        auto shift = exponent - SubBits;
+        return static_cast<std::size_t>((shift + 1) * SubCount + ((ns >> shift) - SubCount));
+    }
+
+    /// <summary>
+    /// highest latency that falls in the bucket
+    /// </summary>
+    static constexpr uint64_t BucketLimit(std::size_t bucket) {
+        if (bucket < SubCount) {
+            return bucket;
+        }
+        auto shift = bucket / SubCount - 1;
+        return ((bucket % SubCount + SubCount + 1) << shift) - 1;
+    }
+
+    void Record(uint64_t ns) {
+        _buckets[BucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        auto max = _max.load(std::memory_order_relaxed);
+        while (ns > max && !_max.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    /// <summary>
+    /// add the bucket counts to counts, which must hold BucketCount entries; returns the highest latency seen
+    /// </summary>
+    uint64_t AddTo(std::span<uint64_t> counts) const;
+    /// <summary>
+    /// not atomic with respect to concurrent Record calls
+    /// </summary>
+    void Clear();
+
+private:
+    std::array<std::atomic<uint64_t>, BucketCount> _buckets{};
+    std::atomic<uint64_t> _max = 0;
+};
+
+struct LatencySummary {
+    LatencyOp op;
+    // state before and after the call, both TxError in the per-operation summaries
+    TelexStates from;
+    TelexStates to;
+    uint64_t count;
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t p999;
+    uint64_t max;
+};
+
+struct LatencySnapshot {
+    // one entry per operation that was called
+    std::vector<LatencySummary> operations;
+    // one entry per operation and state transition that happened
+    std::vector<LatencySummary> transitions;
+};
+
+/// <summary>
+/// latency histograms of every operation and state transition, shared by any number of engines
+/// </summary>
+class LatencyRecorder {
+public:
+    void Record(LatencyOp op, TelexStates from, TelexStates to, uint64_t ns) {
+        _histograms[Index(op, from, to)].Record(ns);
+    }
+
+    LatencySnapshot Snapshot() const;
+    void Clear();
+
+private:
+    static constexpr std::size_t StateIndex(TelexStates state) {
+        return static_cast<std::size_t>(static_cast<int>(state) + 1) % LatencyStateCount;
+    }
+    static constexpr std::size_t Index(LatencyOp op, TelexStates from, TelexStates to) {
+        return (static_cast<std::size_t>(op) * LatencyStateCount + StateIndex(from)) * LatencyStateCount +
+               StateIndex(to);
+    }
+
+    std::array<LatencyHistogram, LatencyOpCount * LatencyStateCount * LatencyStateCount> _histograms;
+};
+
+/// <summary>
+/// the recorder of the engines made by TelexNew and TelexNewDynamic when VIETTYPE_LATENCY is defined
+/// </summary>
+LatencyRecorder& GlobalLatencyRecorder();
+
+/// <summary>
+/// forwards every call to another engine and records how long the calls that change or read out the word take
+/// </summary>
+class TelexLatencyEngine : public ITelexEngine {
+public:
+    TelexLatencyEngine(std::unique_ptr<ITelexEngine> engine, LatencyRecorder& recorder);
+    virtual ~TelexLatencyEngine() {
+    }
+
+    const TelexConfig& GetConfig() const override;
+    bool SetConfig(const TelexConfig& config) override;
+
+    void Reset() override;
+    TelexStates PushChar(_In_ wchar_t c) override;
+    TelexStates Backspace() override;
+    TelexStates Commit() override;
+    TelexStates ForceCommit() override;
+    TelexStates Cancel() override;
+    TelexStates Backconvert(_In_ std::wstring_view s) override;
+
+    TelexStates GetState() const override;
+    std::wstring Retrieve() const override;
+    std::wstring RetrieveRaw() const override;
+    std::wstring Peek() const override;
+    std::size_t Retrieve(_Out_ std::span<wchar_t> buffer) const override;
+    std::size_t RetrieveRaw(_Out_ std::span<wchar_t> buffer) const override;
+    std::size_t Peek(_Out_ std::span<wchar_t> buffer) const override;
+    std::wstring::size_type Count() const override;
+
+    bool SaveSnapshot(_Out_ TelexSnapshot& snapshot) const override;
+    void RestoreSnapshot(_In_ const TelexSnapshot& snapshot) override;
+    void RestoreSnapshotUnderNewConfig(_In_ const TelexSnapshot& snapshot) override;
+
+private:
+    template <typename F>
+    auto Timed(LatencyOp op, F f) const;
+
+    std::unique_ptr<ITelexEngine> _engine;
+    LatencyRecorder* _recorder;
+};
+
+} // namespace Telex
+} // namespace VietType
@@ -6,7 +6,12 @@
 #include <algorithm>
 #include <utility>
 #include <array>
+#include <bit>
+#include <cstdint>
+#include <initializer_list>
 #include <optional>
+#include <stdexcept>
+#include <string_view>
 
 namespace VietType {
 namespace Telex {
@@ -79,5 +84,191 @@ struct ArraySet : public std::array<K, N> {
     }
 };
 
+// FNV-1a over the UTF-16 code units of the key
+constexpr uint32_t HashKey(std::wstring_view s) {
+    uint32_t h = 2166136261u;
+    for (auto c : s) {
+        h ^= static_cast<uint16_t>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+constexpr uint32_t HashKey(wchar_t c) {
+    return HashKey(std::wstring_view(&c, 1));
+}
+
+constexpr uint32_t MixHash(uint32_t h, uint32_t seed) {
+    h ^= seed * 0x9e3779b9u;
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+/// <summary>
+/// hash-and-displace perfect hash over N keys, built at compile time:
+/// keys are split into buckets by their hash, then each bucket (largest first) is given the first seed
+/// that sends all of its keys to distinct free slots;
+/// a lookup is one string hash plus one slot probe
+/// </summary>
+template <size_t N>
+class PerfectHashIndex {
+    static_assert(N > 0 && N < UINT16_MAX);
+
+public:
+    static constexpr size_t Buckets = N / 2 + 1;
+    static constexpr size_t Slots = std::bit_ceil(N) * 2;
+
+    template <typename Keys>
+    constexpr explicit PerfectHashIndex(const Keys& keys) {
+        std::array<uint32_t, N> hashes{};
+        std::array<size_t, Buckets> bucketSizes{};
+        for (size_t i = 0; i < N; i++) {
+            for (size_t j = 0; j < i; j++) {
+                if (keys[i] == keys[j]) {
+                    throw std::logic_error("duplicate key in perfect hash table");
+                }
+            }
+            hashes[i] = HashKey(keys[i]);
+            bucketSizes[hashes[i] % Buckets]++;
+        }
+        _slots.fill(static_cast<uint16_t>(N));
+
+        for (size_t size = N; size > 0; size--) {
+            for (size_t b = 0; b < Buckets; b++) {
+                if (bucketSizes[b] == size) {
+                    PlaceBucket(b, hashes);
+                }
+            }
+        }
+    }
+
+    /// <summary>returns the only index that may hold a key with this hash, or N if there is none</summary>
+    constexpr size_t Find(uint32_t h) const {
+        return _slots[MixHash(h, _seeds[h % Buckets]) & (Slots - 1)];
+    }
+
+private:
+    constexpr void PlaceBucket(size_t b, const std::array<uint32_t, N>& hashes) {
+        for (uint32_t seed = 0; seed < UINT16_MAX; seed++) {
+            std::array<size_t, N> taken{};
+            size_t ntaken = 0;
+            bool ok = true;
+            for (size_t i = 0; i < N && ok; i++) {
+                if (hashes[i] % Buckets != b) {
+                    continue;
+                }
+                auto slot = MixHash(hashes[i], seed) & (Slots - 1);
+                auto takenEnd = taken.begin() + ntaken;
+                ok = _slots[slot] == N && std::find(taken.begin(), takenEnd, slot) == takenEnd;
+                taken[ntaken++] = slot;
+            }
+            if (ok) {
+                ntaken = 0;
+                for (size_t i = 0; i < N; i++) {
+                    if (hashes[i] % Buckets == b) {
+                        _slots[taken[ntaken++]] = static_cast<uint16_t>(i);
+                    }
+                }
+                _seeds[b] = static_cast<uint16_t>(seed);
+                return;
+            }
+        }
+        throw std::logic_error("cannot build perfect hash table");
+    }
+
+    std::array<uint16_t, Buckets> _seeds{};
+    std::array<uint16_t, Slots> _slots{};
+};
+
+/// <summary>
+/// read-only map with a compile-time perfect hash;
+/// iterates in declaration order like ArrayMap
+/// </summary>
+template <typename K, typename V, size_t N>
+struct HashMap : public std::array<std::pair<K, V>, N> {
+    using const_iterator = typename std::array<std::pair<K, V>, N>::const_iterator;
+
+    constexpr HashMap(std::initializer_list<std::pair<K, V>> init)
+        : std::array<std::pair<K, V>, N>(ToArray(init)), _index(KeyView{this}) {
+    }
+
+    constexpr const_iterator find(const K& key) const {
+        auto i = _index.Find(HashKey(key));
+        if (i < N && (*this)[i].first == key) {
+            return this->cbegin() + i;
+        } else {
+            return this->cend();
+        }
+    }
+
+    constexpr std::optional<std::pair<K, V>> find_opt(const K& key) const {
+        auto it = find(key);
+        if (it != this->cend()) {
+            return *it;
+        } else {
+            return std::nullopt;
+        }
+    }
+
+private:
+    struct KeyView {
+        const HashMap* map;
+        constexpr const K& operator[](size_t i) const {
+            return (*map)[i].first;
+        }
+    };
+
+    static constexpr std::array<std::pair<K, V>, N> ToArray(std::initializer_list<std::pair<K, V>> init) {
+        std::array<std::pair<K, V>, N> result{};
+        std::copy(init.begin(), init.end(), result.begin());
+        return result;
+    }
+
+    PerfectHashIndex<N> _index;
+};
+
+/// <summary>
+/// read-only set with a compile-time perfect hash;
+/// iterates in declaration order like ArraySet
+/// </summary>
+template <typename K, size_t N>
+struct HashSet : public std::array<K, N> {
+    using const_iterator = typename std::array<K, N>::const_iterator;
+
+    constexpr HashSet(std::initializer_list<K> init) : std::array<K, N>(ToArray(init)), _index(*this) {
+    }
+
+    constexpr const_iterator find(const K& key) const {
+        auto i = _index.Find(HashKey(key));
+        if (i < N && (*this)[i] == key) {
+            return this->cbegin() + i;
+        } else {
+            return this->cend();
+        }
+    }
+
+    constexpr std::optional<K> find_opt(const K& key) const {
+        auto it = find(key);
+        if (it != this->cend()) {
+            return *it;
+        } else {
+            return std::nullopt;
+        }
+    }
+
+private:
+    static constexpr std::array<K, N> ToArray(std::initializer_list<K> init) {
+        std::array<K, N> result{};
+        std::copy(init.begin(), init.end(), result.begin());
+        return result;
+    }
+
+    PerfectHashIndex<N> _index;
+};
+
 } // namespace Telex
 } // namespace VietType
@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <bit>
+#include "TelexSession.h"
+
+namespace VietType {
+namespace Telex {
+
+TelexSessionPool::TelexSessionPool(std::size_t capacity)
+    : _sessions(capacity), _index(capacity ? std::bit_ceil(capacity * 2) : 0) {
+    Clear();
+}
+
+std::size_t TelexSessionPool::Hash(ContextId context) {
+    context ^= context >> 33;
+    context *= 0xff51afd7ed558ccdull;
+    context ^= context >> 33;
+    return static_cast<std::size_t>(context);
+}
+
+uint32_t TelexSessionPool::Find(ContextId context) const {
+    if (_index.empty()) {
+        return None;
+    }
+    auto mask = _index.size() - 1;
+    for (auto i = Hash(context) & mask;; i = (i + 1) & mask) {
+        if (!_index[i]) {
+            return None;
+        } else if (_sessions[_index[i] - 1].context == context) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+}
+
+// backward shift deletion, so that lookups never need tombstones
+void TelexSessionPool::Unindex(uint32_t pos) {
+    auto mask = _index.size() - 1;
+    std::size_t hole = pos;
+    for (auto i = (hole + 1) & mask; _index[i]; i = (i + 1) & mask) {
+        auto home = Hash(_sessions[_index[i] - 1].context) & mask;
+        // the entry can fill the hole unless its home lies after the hole
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            _index[hole] = _index[i];
+            hole = i;
+        }
+    }
+    _index[hole] = 0;
+}
+
+void TelexSessionPool::Unlink(uint32_t session) {
+    auto& s = _sessions[session];
+    (s.prev == None ? _head : _sessions[s.prev].next) = s.next;
+    (s.next == None ? _tail : _sessions[s.next].prev) = s.prev;
+}
+
+void TelexSessionPool::PushFront(uint32_t session) {
+    auto& s = _sessions[session];
+    s.prev = None;
+    s.next = _head;
+    (_head == None ? _tail : _sessions[_head].prev) = session;
+    _head = session;
+}
+
+// drop the session indexed at pos
+void TelexSessionPool::Release(uint32_t pos) {
+    auto session = _index[pos] - 1;
+    Unindex(pos);
+    Unlink(session);
+    _sessions[session].next = _free;
+    _free = session;
+    _count--;
+}
+
+bool TelexSessionPool::Save(ContextId context, const ITelexEngine& engine) {
+    auto state = engine.GetState();
+    auto pos = Find(context);
+    if (!engine.Count() || (state != TelexStates::Valid && state != TelexStates::Invalid) || _sessions.empty()) {
+        if (pos != None) {
+            Release(pos);
+        }
+        return false;
+    }
+
+    uint32_t session;
+    if (pos != None) {
+        session = _index[pos] - 1;
+        Unlink(session);
+    } else {
+        if (_free == None) {
+            Release(Find(_sessions[_tail].context));
+            _stats.evictions++;
+        }
+        session = _free;
+        _free = _sessions[session].next;
+        _sessions[session].context = context;
+        auto mask = _index.size() - 1;
+        auto i = Hash(context) & mask;
+        while (_index[i]) {
+            i = (i + 1) & mask;
+        }
+        _index[i] = session + 1;
+        pos = static_cast<uint32_t>(i);
+        _count++;
+    }
+    PushFront(session);
+
+    if (!engine.SaveSnapshot(_sessions[session].snapshot)) {
+        Release(pos);
+        _stats.unsaved++;
+        return false;
+    }
+    _stats.saves++;
+    return true;
+}
+
+bool TelexSessionPool::Restore(ContextId context, ITelexEngine& engine) {
+    auto pos = Find(context);
+    if (pos == None) {
+        _stats.misses++;
+        return false;
+    }
+    engine.RestoreSnapshot(_sessions[_index[pos] - 1].snapshot);
+    Release(pos);
+    _stats.hits++;
+    return true;
+}
+
+void TelexSessionPool::Forget(ContextId context) {
+    auto pos = Find(context);
+    if (pos != None) {
+        Release(pos);
+    }
+}
+
+void TelexSessionPool::Clear() {
+    std::fill(_index.begin(), _index.end(), 0);
+    for (std::size_t i = 0; i < _sessions.size(); i++) {
+        _sessions[i].next = i + 1 < _sessions.size() ? static_cast<uint32_t>(i + 1) : None;
+    }
+    _free = _sessions.empty() ? None : 0;
+    _head = None;
+    _tail = None;
+    _count = 0;
+}
+
+} // namespace Telex
+} // namespace VietType
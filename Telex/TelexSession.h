@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Telex.h"
+#include "TelexEngine.h"
+
+namespace VietType {
+namespace Telex {
+
+struct TelexSessionStats {
+    uint64_t saves = 0;
+    // Restore found the context
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // contexts dropped to make room, always the least recently saved one
+    uint64_t evictions = 0;
+    // words too long for a snapshot
+    uint64_t unsaved = 0;
+};
+
+/// <summary>
+/// the words left unfinished in up to a fixed number of contexts (documents, text fields), so that one engine can
+/// switch between contexts and pick each word up where it was left;
+/// every snapshot lives in a slab allocated up front and is found through an open-addressed index,
+/// so Save and Restore are O(1) and never allocate; when the pool is full the least recently saved context goes
+/// </summary>
+class TelexSessionPool {
+public:
+    // opaque to the pool, e.g. the address of the context
+    using ContextId = uint64_t;
+
+    explicit TelexSessionPool(std::size_t capacity);
+
+    /// <summary>
+    /// put the engine's word aside for the context, replacing anything kept for it before;
+    /// only words still being typed are kept, saving an empty or finished word forgets the context
+    /// </summary>
+    /// <returns>whether the word was kept</returns>
+    bool Save(ContextId context, const ITelexEngine& engine);
+    /// <summary>
+    /// give the word kept for the context back to the engine and forget it;
+    /// the engine is left alone if nothing was kept
+    /// </summary>
+    bool Restore(ContextId context, ITelexEngine& engine);
+    void Forget(ContextId context);
+    /// <summary>
+    /// snapshots only restore into an engine with the config they were saved with, clear the pool on SetConfig
+    /// </summary>
+    void Clear();
+
+    std::size_t Count() const {
+        return _count;
+    }
+    std::size_t Capacity() const {
+        return _sessions.size();
+    }
+    const TelexSessionStats& GetStats() const {
+        return _stats;
+    }
+
+private:
+    static constexpr uint32_t None = UINT32_MAX;
+
+    struct Session {
+        TelexSnapshot snapshot;
+        ContextId context;
+        // recency list while in use, most recent first; free list otherwise
+        uint32_t prev;
+        uint32_t next;
+    };
+
+    static std::size_t Hash(ContextId context);
+    // position in _index, or None
+    uint32_t Find(ContextId context) const;
+    void Unindex(uint32_t pos);
+    void Unlink(uint32_t session);
+    void PushFront(uint32_t session);
+    void Release(uint32_t pos);
+
+    std::vector<Session> _sessions;
+    // session + 1, 0 if empty; linear probing, a power of two at least twice the capacity
+    std::vector<uint32_t> _index;
+    uint32_t _head = None;
+    uint32_t _tail = None;
+    uint32_t _free = None;
+    std::size_t _count = 0;
+    TelexSessionStats _stats;
+};
+
+} // namespace Telex
+} // namespace VietType
@@ -0,0 +1,234 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <bit>
+#include <optional>
+#include <unordered_map>
+#include "TelexSyllables.h"
+#include "TelexData.h"
+
+namespace VietType {
+namespace Telex {
+
+static std::wstring Describe(std::wstring_view c1, std::wstring_view v, std::wstring_view c2) {
+    std::wstring s;
+    s.append(c1).push_back(L'|');
+    s.append(v).push_back(L'|');
+    s.append(c2);
+    return s;
+}
+
+// same choice of table as TelexEngine::FindTable
+static std::optional<VInfo> FindV(std::wstring_view c1, std::wstring_view v, std::wstring_view c2, bool oaUyTone1) {
+    std::optional<std::pair<std::wstring_view, VInfo>> found;
+    if (c1 == L"q") {
+        found = valid_v_q.find_opt(v);
+    } else if (c1 == L"gi") {
+        found = valid_v_gi.find_opt(v);
+    } else {
+        if (c2.empty() && !oaUyTone1) {
+            found = valid_v_oa_uy.find_opt(v);
+        }
+        if (!found) {
+            found = valid_v.find_opt(v);
+        }
+    }
+    if (found) {
+        return found->second;
+    }
+    return std::nullopt;
+}
+
+const SyllableTable& SyllableTable::Get() {
+    static const SyllableTable table = Generate();
+    return table;
+}
+
+SyllableTable SyllableTable::Generate() {
+    SyllableTable table;
+    auto& issues = table._issues;
+
+    // give a code to every character of the tables
+    uint8_t nextCode = 1;
+    auto addChars = [&](std::wstring_view part, std::size_t maxLength, const wchar_t* what) {
+        if (part.size() > maxLength) {
+            issues.push_back(std::wstring(what) + L" longer than the packed key allows: " + std::wstring(part));
+        }
+        for (auto c : part) {
+            if (static_cast<std::size_t>(c) >= table._codes.size()) {
+                issues.push_back(std::wstring(what) + L" has a character outside the packed alphabet: " +
+                                 std::wstring(part));
+            } else if (!table._codes[c]) {
+                if (nextCode >= 32) {
+                    issues.push_back(L"more than 31 distinct characters in the syllable tables");
+                    return;
+                }
+                table._codes[c] = nextCode++;
+            }
+        }
+    };
+    for (auto c1 : valid_c1) {
+        addChars(c1, MaxC1Length, L"c1");
+    }
+    for (const auto& [c2, restricted] : valid_c2) {
+        addChars(c2, MaxC2Length, L"c2");
+    }
+    std::vector<std::wstring_view> vs;
+    auto addV = [&](const auto& vtable) {
+        for (const auto& [v, vinfo] : vtable) {
+            addChars(v, MaxVLength, L"v");
+            vs.push_back(v);
+        }
+    };
+    addV(valid_v);
+    addV(valid_v_q);
+    addV(valid_v_gi);
+    addV(valid_v_oa_uy);
+    std::sort(vs.begin(), vs.end());
+    vs.erase(std::unique(vs.begin(), vs.end()), vs.end());
+    if (!issues.empty()) {
+        return table;
+    }
+
+    for (const auto& [c2, restricted] : valid_c2) {
+        // Commit only looks at the whole c2, but typing relies on the restriction being known from the first letter
+        for (const auto& [other, otherRestricted] : valid_c2) {
+            if (!c2.empty() && other.size() > c2.size() && other.starts_with(c2) && otherRestricted != restricted) {
+                issues.push_back(L"c2 " + std::wstring(other) + L" does not have the same tone restriction as " +
+                                 std::wstring(c2));
+            }
+        }
+    }
+    for (const auto& [v, vinfo] : valid_v_oa_uy) {
+        if (vinfo.c2mode == C2Mode::MustC2) {
+            issues.push_back(L"valid_v_oa_uy entry is only used without c2 but requires one: " + std::wstring(v));
+        }
+        if (!valid_v.find_opt(v)) {
+            issues.push_back(L"valid_v_oa_uy entry missing from valid_v: " + std::wstring(v));
+        }
+    }
+
+    std::unordered_map<uint64_t, std::size_t> seen;
+    for (auto c1 : valid_c1) {
+        for (const auto& [c2, restricted] : valid_c2) {
+            for (auto v : vs) {
+                for (bool oaUyTone1 : {true, false}) {
+                    auto vinfo = FindV(c1, v, c2, oaUyTone1);
+                    if (!vinfo) {
+                        continue;
+                    }
+
+                    // the same checks as Commit after the lookups
+                    SyllableInfo info{};
+                    std::wstring tonedV(v);
+                    if (vinfo->tonepos < 0 && c1 == L"gi" && v.empty()) {
+                        info.moveGi = true;
+                        tonedV.push_back(L'i');
+                        vinfo->tonepos = 0;
+                    } else if (vinfo->c2mode == C2Mode::MustC2 && c2.empty()) {
+                        continue;
+                    } else if (vinfo->c2mode == C2Mode::NoC2 && !c2.empty()) {
+                        continue;
+                    }
+                    if (vinfo->tonepos < 0 || static_cast<std::size_t>(vinfo->tonepos) >= tonedV.size()) {
+                        issues.push_back(L"tone position outside of v: " + Describe(c1, v, c2));
+                        continue;
+                    }
+                    info.tonepos = static_cast<int8_t>(vinfo->tonepos);
+
+                    auto base = tonedV[vinfo->tonepos];
+                    auto tones = transitions_tones.find(base);
+                    if (tones == transitions_tones.end()) {
+                        issues.push_back(L"tone placed on a character without tones: " + Describe(c1, v, c2));
+                    }
+                    for (std::size_t t = 0; t < info.toned.size(); t++) {
+                        if (restricted && t != static_cast<std::size_t>(Tones::S) &&
+                            t != static_cast<std::size_t>(Tones::J)) {
+                            info.toned[t] = 0;
+                        } else {
+                            info.toned[t] = tones != transitions_tones.end() ? tones->second[t] : base;
+                        }
+                    }
+
+                    info.key = table.Pack(c1, v, c2, oaUyTone1);
+                    auto [it, inserted] = seen.emplace(info.key, table._entries.size());
+                    if (inserted) {
+                        table._entries.push_back(info);
+                    } else {
+                        const auto& other = table._entries[it->second];
+                        if (other.tonepos != info.tonepos || other.moveGi != info.moveGi ||
+                            other.toned != info.toned) {
+                            issues.push_back(L"oa_uy_tone1 changes a syllable it should not: " + Describe(c1, v, c2));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (!table.BuildIndex()) {
+        // Find stays correct through a binary search, only slower
+        issues.push_back(L"cannot build the perfect hash of the syllable table");
+        table._seeds.clear();
+        table._slots.clear();
+        std::sort(table._entries.begin(), table._entries.end(), [](const SyllableInfo& a, const SyllableInfo& b) {
+            return a.key < b.key;
+        });
+    }
+    return table;
+}
+
+// hash-and-displace like PerfectHashIndex, with the sizes only known at run time
+bool SyllableTable::BuildIndex() {
+    auto n = _entries.size();
+    if (!n || n >= UINT16_MAX) {
+        return false;
+    }
+    _seeds.assign(n / 2 + 1, 0);
+    _slots.assign(std::bit_ceil(n) * 2, static_cast<uint16_t>(n));
+
+    std::vector<std::vector<uint16_t>> buckets(_seeds.size());
+    for (std::size_t i = 0; i < n; i++) {
+        buckets[Mix(_entries[i].key, 0) % buckets.size()].push_back(static_cast<uint16_t>(i));
+    }
+    std::vector<std::size_t> order(buckets.size());
+    for (std::size_t b = 0; b < order.size(); b++) {
+        order[b] = b;
+    }
+    std::stable_sort(
+        order.begin(), order.end(), [&](auto a, auto b) { return buckets[a].size() > buckets[b].size(); });
+
+    std::vector<std::size_t> taken;
+    for (auto b : order) {
+        if (buckets[b].empty()) {
+            break;
+        }
+        bool placed = false;
+        for (uint32_t seed = 0; seed < UINT16_MAX && !placed; seed++) {
+            taken.clear();
+            placed = true;
+            for (auto i : buckets[b]) {
+                auto slot = Mix(_entries[i].key, seed) & (_slots.size() - 1);
+                if (_slots[slot] != n || std::find(taken.begin(), taken.end(), slot) != taken.end()) {
+                    placed = false;
+                    break;
+                }
+                taken.push_back(slot);
+            }
+            if (placed) {
+                for (std::size_t j = 0; j < taken.size(); j++) {
+                    _slots[taken[j]] = buckets[b][j];
+                }
+                _seeds[b] = static_cast<uint16_t>(seed);
+            }
+        }
+        if (!placed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace Telex
+} // namespace VietType
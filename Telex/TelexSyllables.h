@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace VietType {
+namespace Telex {
+
+struct SyllableInfo {
+    uint64_t key;
+    // index of the toned character in v
+    int8_t tonepos;
+    // c1 is "gi" and v is empty, the 'i' moves to v before the tone is placed
+    bool moveGi;
+    // v[tonepos] with each tone applied, indexed by Tones; 0 if c2 does not allow the tone
+    std::array<wchar_t, 6> toned;
+};
+
+/// <summary>
+/// every (c1, v, c2) that Commit accepts, enumerated from valid_c1, valid_c2 and the valid_v tables and
+/// looked up through a hash-and-displace perfect hash on the packed syllable, or a binary search if that cannot be
+/// built; generated on first use, and any inconsistency found in the tables along the way is kept in Issues
+/// </summary>
+class SyllableTable {
+public:
+    static constexpr std::size_t MaxC1Length = 3;
+    static constexpr std::size_t MaxVLength = 3;
+    static constexpr std::size_t MaxC2Length = 2;
+
+    static const SyllableTable& Get();
+    static SyllableTable Generate();
+
+    const SyllableInfo* Find(std::wstring_view c1, std::wstring_view v, std::wstring_view c2, bool oaUyTone1) const {
+        auto key = Pack(c1, v, c2, oaUyTone1);
+        if (!key) {
+            return nullptr;
+        }
+        if (_seeds.empty()) {
+            // _entries is sorted by key instead
+            auto less = [](const SyllableInfo& entry, uint64_t k) { return entry.key < k; };
+            auto it = std::lower_bound(_entries.begin(), _entries.end(), key, less);
+            return it != _entries.end() && it->key == key ? &*it : nullptr;
+        }
+        auto h = Mix(key, 0);
+        auto i = _slots[Mix(key, _seeds[h % _seeds.size()]) & (_slots.size() - 1)];
+        if (i < _entries.size() && _entries[i].key == key) {
+            return &_entries[i];
+        }
+        return nullptr;
+    }
+
+    std::size_t Count() const {
+        return _entries.size();
+    }
+
+    const std::vector<SyllableInfo>& Entries() const {
+        return _entries;
+    }
+
+    const std::vector<std::wstring>& Issues() const {
+        return _issues;
+    }
+
+private:
+    SyllableTable() = default;
+
+    // 0 if the syllable cannot be in the table
+    uint64_t Pack(std::wstring_view c1, std::wstring_view v, std::wstring_view c2, bool oaUyTone1) const {
+        if (c1.size() > MaxC1Length || v.size() > MaxVLength || c2.size() > MaxC2Length) {
+            return 0;
+        }
+        // the top bit keeps the empty syllable from packing to 0
+        uint64_t key = 1;
+        auto append = [&](std::wstring_view part, std::size_t width) {
+            for (std::size_t i = 0; i < width; i++) {
+                uint8_t code = 0;
+                if (i < part.size()) {
+                    auto c = part[i];
+                    code = static_cast<std::size_t>(c) < _codes.size() ? _codes[c] : 0;
+                    if (!code) {
+                        return false;
+                    }
+                }
+                key = (key << 5) | code;
+            }
+            return true;
+        };
+        if (!append(c1, MaxC1Length) || !append(v, MaxVLength) || !append(c2, MaxC2Length)) {
+            return 0;
+        }
+        // the option only decides the table when FindTable would look at valid_v_oa_uy
+        return (key << 1) | (!oaUyTone1 && c2.empty() && c1 != L"q" && c1 != L"gi");
+    }
+
+    static constexpr uint32_t Mix(uint64_t key, uint32_t seed) {
+        key ^= seed * 0x9e3779b97f4a7c15ull;
+        key ^= key >> 30;
+        key *= 0xbf58476d1ce4e5b9ull;
+        key ^= key >> 27;
+        key *= 0x94d049bb133111ebull;
+        key ^= key >> 31;
+        return static_cast<uint32_t>(key);
+    }
+
+    bool BuildIndex();
+
+    std::vector<SyllableInfo> _entries;
+    std::vector<uint16_t> _seeds;
+    std::vector<uint16_t> _slots;
+    // 5-bit code of each character used by the tables, 0 if unused
+    std::array<uint8_t, 0x200> _codes{};
+    std::vector<std::wstring> _issues;
+};
+
+} // namespace Telex
+} // namespace VietType
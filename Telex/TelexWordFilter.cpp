@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <algorithm>
+#include <iterator>
+#include "TelexWordFilter.h"
+
+namespace VietType {
+namespace Telex {
+
+static constexpr uint32_t WordFilterMagic = 0x464e4556; // "VENF"
+// 5 bits per letter
+static constexpr uint64_t MaxPackedKey = (1ull << (5 * WordFilter::MaxWordLength)) - 1;
+
+WordFilter WordFilter::Build(std::span<const std::wstring_view> words) {
+    std::vector<uint64_t> keys;
+    keys.reserve(words.size());
+    for (auto w : words) {
+        if (auto key = Pack(w)) {
+            keys.push_back(key);
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    WordFilter filter;
+    filter.Rebuild(keys);
+    return filter;
+}
+
+void WordFilter::Insert(uint64_t key) {
+    auto i = Slot(key);
+    while (_table[i]) {
+        i = (i + 1) & (_table.size() - 1);
+    }
+    _table[i] = key;
+}
+
+void WordFilter::Rebuild(std::span<const uint64_t> keys) {
+    // at least twice as many slots as keys, the table always has an empty slot to end probing
+    int bits = 1;
+    while ((std::size_t{1} << bits) < keys.size() * 2) {
+        bits++;
+    }
+    _table.assign(std::size_t{1} << bits, 0);
+    _shift = 64 - bits;
+    _count = keys.size();
+    for (auto key : keys) {
+        Insert(key);
+    }
+}
+
+bool WordFilter::Save(_In_ FILE* f) const {
+    // the keys are saved sorted so that the file does not depend on the hash function
+    std::vector<uint64_t> keys;
+    keys.reserve(_count);
+    std::copy_if(_table.begin(), _table.end(), std::back_inserter(keys), [](auto key) { return !!key; });
+    std::sort(keys.begin(), keys.end());
+    uint64_t n = keys.size();
+    return fwrite(&WordFilterMagic, sizeof(WordFilterMagic), 1, f) == 1 && fwrite(&n, sizeof(n), 1, f) == 1 &&
+           (!n || fwrite(keys.data(), sizeof(uint64_t), keys.size(), f) == keys.size());
+}
+
+bool WordFilter::Load(_In_ FILE* f) {
+    uint32_t magic;
+    uint64_t n;
+    if (fread(&magic, sizeof(magic), 1, f) != 1 || magic != WordFilterMagic || fread(&n, sizeof(n), 1, f) != 1 ||
+        n > (1ull << 32)) {
+        return false;
+    }
+    // n comes from the file, so the keys are read a chunk at a time and a short file fails before much is allocated
+    std::vector<uint64_t> keys;
+    uint64_t chunk[1024];
+    while (keys.size() < n) {
+        auto count = static_cast<std::size_t>(std::min<uint64_t>(std::size(chunk), n - keys.size()));
+        if (fread(chunk, sizeof(uint64_t), count, f) != count) {
+            return false;
+        }
+        keys.insert(keys.end(), chunk, chunk + count);
+    }
+    // strictly increasing also rules out duplicates, which would break the key count
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        if (!keys[i] || keys[i] > MaxPackedKey || (i && keys[i] <= keys[i - 1])) {
+            return false;
+        }
+    }
+    Rebuild(keys);
+    return true;
+}
+
+} // namespace Telex
+} // namespace VietType
@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace VietType {
+namespace Telex {
+
+/// <summary>
+/// exact set of words made of up to 12 letters a-z, each word is packed into 5 bits per letter and kept in an
+/// open-addressed table at most half full, so a lookup is one hash and usually one cache line;
+/// letters are matched case-insensitively and words that cannot be packed are never contained
+/// </summary>
+class WordFilter {
+public:
+    static constexpr std::size_t MaxWordLength = 12;
+
+    WordFilter() = default;
+
+    /// <summary>
+    /// build the set from a list of words, words that cannot be packed are skipped
+    /// </summary>
+    static WordFilter Build(std::span<const std::wstring_view> words);
+
+    bool Contains(std::wstring_view word) const {
+        auto key = Pack(word);
+        if (!key || _table.empty()) {
+            return false;
+        }
+        for (auto i = Slot(key);; i = (i + 1) & (_table.size() - 1)) {
+            if (_table[i] == key) {
+                return true;
+            } else if (!_table[i]) {
+                return false;
+            }
+        }
+    }
+
+    std::size_t Count() const {
+        return _count;
+    }
+
+    bool Save(_In_ FILE* f) const;
+    bool Load(_In_ FILE* f);
+
+private:
+    // 0 if the word cannot be packed
+    static constexpr uint64_t Pack(std::wstring_view word) {
+        if (word.empty() || word.size() > MaxWordLength) {
+            return 0;
+        }
+        uint64_t key = 0;
+        for (auto c : word) {
+            auto lc = c | 0x20;
+            if (lc < L'a' || lc > L'z') {
+                return 0;
+            }
+            key = (key << 5) | (lc - L'a' + 1);
+        }
+        return key;
+    }
+
+    std::size_t Slot(uint64_t key) const {
+        return static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ull) >> _shift);
+    }
+
+    void Insert(uint64_t key);
+    void Rebuild(std::span<const uint64_t> keys);
+
+    std::vector<uint64_t> _table;
+    std::size_t _count = 0;
+    int _shift = 64;
+};
+
+} // namespace Telex
+} // namespace VietType
@@ -1,31 +1,32 @@
 // SPDX-FileCopyrightText: Copyright (c) 2024 Dinh Ngoc Tu
 // SPDX-License-Identifier: GPL-3.0-only
 
-#include <cstdlib>
+#include <cstdint>
+#include <memory>
 #include <stdexcept>
 #include <system_error>
 #include "FileUtil.hpp"
+#include "WordListIterator.hpp"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace VietType {
 namespace TestLib {
 
-static BOOL readall(HANDLE fd, PVOID buf, DWORD count) {
-    auto _buf = static_cast<char*>(buf);
-    DWORD rem = count;
-    while (rem) {
-        DWORD done;
-        if (!ReadFile(fd, _buf, static_cast<DWORD>(rem), &done, NULL))
-            return FALSE;
-        else if (done == 0)
-            break;
-        _buf += done;
-        rem -= done;
-    }
-    return TRUE;
-}
+#ifdef _WIN32
 
-PVOID ReadWholeFile(PCWSTR filename, _Out_ PLONGLONG size) {
-    auto f = CreateFileW(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
+void* ReadWholeFile(const wchar_t* filename, _Out_ long long* size) {
+    auto f = CreateFileW(
+        filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
     if (f == INVALID_HANDLE_VALUE)
         throw std::system_error(GetLastError(), std::system_category(), "CreateFileW");
     LARGE_INTEGER fsize;
@@ -33,26 +34,135 @@ PVOID ReadWholeFile(PCWSTR filename, _Out_ PLONGLONG size) {
         CloseHandle(f);
         throw std::system_error(GetLastError(), std::system_category(), "GetFileSizeEx");
     }
-    if (fsize.QuadPart > (10ll << 32)) {
+    // only limited by the address space
+    if (static_cast<unsigned long long>(fsize.QuadPart) > SIZE_MAX) {
         CloseHandle(f);
         throw std::runtime_error("file too large");
     }
-    auto bytes = malloc(fsize.QuadPart);
-    if (!bytes) {
-        CloseHandle(f);
-        throw std::bad_alloc();
-    }
-    if (!readall(f, bytes, static_cast<DWORD>(fsize.QuadPart))) {
-        free(bytes);
+    // a mapping of an empty file cannot be created
+    if (!fsize.QuadPart) {
         CloseHandle(f);
-        throw std::system_error(GetLastError(), std::system_category(), "ReadFile");
+        *size = 0;
+        return nullptr;
     }
+    auto mapping = CreateFileMappingW(f, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    auto err = GetLastError();
+    CloseHandle(f);
+    if (!mapping)
+        throw std::system_error(err, std::system_category(), "CreateFileMappingW");
+    auto bytes = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    err = GetLastError();
+    // the view keeps the mapping alive
+    CloseHandle(mapping);
+    if (!bytes)
+        throw std::system_error(err, std::system_category(), "MapViewOfFile");
     *size = fsize.QuadPart;
     return bytes;
 }
 
-VOID FreeFile(PVOID file) {
-    free(file);
+void FreeFile(void* file) {
+    if (file)
+        UnmapViewOfFile(file);
+}
+
+#else
+
+// munmap needs the length of the mapping
+static std::mutex mappingsLock;
+static std::unordered_map<void*, size_t> mappings;
+
+static std::string NativePath(const wchar_t* filename) {
+    std::string path;
+    for (; *filename; filename++) {
+        auto c = static_cast<char32_t>(*filename);
+        if (c == U'\\') {
+            path.push_back('/');
+        } else if (c < 0x80) {
+            path.push_back(static_cast<char>(c));
+        } else if (c < 0x800) {
+            path.push_back(static_cast<char>(0xc0 | (c >> 6)));
+            path.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+        } else if (c < 0x10000) {
+            path.push_back(static_cast<char>(0xe0 | (c >> 12)));
+            path.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3f)));
+            path.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+        } else {
+            path.push_back(static_cast<char>(0xf0 | (c >> 18)));
+            path.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3f)));
+            path.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3f)));
+            path.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+        }
+    }
+    return path;
+}
+
+void* ReadWholeFile(const wchar_t* filename, _Out_ long long* size) {
+    auto fd = open(NativePath(filename).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        throw std::system_error(errno, std::generic_category(), "open");
+    struct stat st;
+    if (fstat(fd, &st)) {
+        auto err = errno;
+        close(fd);
+        throw std::system_error(err, std::generic_category(), "fstat");
+    }
+    if (static_cast<unsigned long long>(st.st_size) > SIZE_MAX) {
+        close(fd);
+        throw std::runtime_error("file too large");
+    }
+    if (!st.st_size) {
+        close(fd);
+        *size = 0;
+        return nullptr;
+    }
+    auto length = static_cast<size_t>(st.st_size);
+    auto bytes = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    auto err = errno;
+    close(fd);
+    if (bytes == MAP_FAILED)
+        throw std::system_error(err, std::generic_category(), "mmap");
+    // word lists are read front to back once, only a hint so failure does not matter
+    madvise(bytes, length, MADV_SEQUENTIAL);
+    {
+        std::lock_guard<std::mutex> lock(mappingsLock);
+        mappings.emplace(bytes, length);
+    }
+    *size = static_cast<long long>(length);
+    return bytes;
+}
+
+void FreeFile(void* file) {
+    if (!file)
+        return;
+    size_t length;
+    {
+        std::lock_guard<std::mutex> lock(mappingsLock);
+        auto it = mappings.find(file);
+        if (it == mappings.end())
+            return;
+        length = it->second;
+        mappings.erase(it);
+    }
+    munmap(file, length);
+}
+
+#endif
+
+std::vector<std::wstring> LoadWordList(const wchar_t* filename) {
+    long long fsize;
+    std::unique_ptr<char16_t, decltype(&FreeFile)> list{
+        static_cast<char16_t*>(ReadWholeFile(filename, &fsize)), FreeFile};
+    std::vector<std::wstring> words;
+    if (!list) {
+        return words;
+    }
+    auto wend = list.get() + fsize / sizeof(char16_t);
+    for (Utf16WordListIterator w(list.get(), wend); w != wend; w++) {
+        if (w.wlen()) {
+            words.emplace_back(w.wstr());
+        }
+    }
+    return words;
 }
 
 } // namespace TestLib
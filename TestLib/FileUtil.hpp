@@ -3,13 +3,34 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
 #include <Windows.h>
+#else
+#ifndef _Out_
+#define _Out_
+#endif
+#endif
 
 namespace VietType {
 namespace TestLib {
 
-PVOID ReadWholeFile(PCWSTR filename, _Out_ PLONGLONG size);
-VOID FreeFile(PVOID file);
+/// <summary>
+/// map the whole file into memory, pages are copy-on-write so the caller may modify the contents;
+/// an empty file gives nullptr and a size of 0
+/// </summary>
+/// <param name="filename">on non-Windows platforms, backslashes are taken as path separators</param>
+void* ReadWholeFile(const wchar_t* filename, _Out_ long long* size);
+/// <summary>
+/// unmap a file returned by ReadWholeFile, nullptr is ignored
+/// </summary>
+void FreeFile(void* file);
+/// <summary>
+/// read a NUL-separated UTF-16 word list with ReadWholeFile, skipping empty words
+/// </summary>
+std::vector<std::wstring> LoadWordList(const wchar_t* filename);
 
 } // namespace TestLib
 } // namespace VietType
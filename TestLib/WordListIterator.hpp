@@ -5,23 +5,29 @@
 
 #include <cstddef>
 #include <iterator>
+#include <string>
+#include <string_view>
 
 namespace VietType {
 namespace TestLib {
 
-class WordListIterator {
+/// <summary>
+/// walks a list of NUL-separated words in place, e.g. a file mapped by ReadWholeFile
+/// </summary>
+template <typename CharT>
+class BasicWordListIterator {
 public:
-    using value_type = const wchar_t*;
+    using value_type = const CharT*;
     using difference_type = ptrdiff_t;
     using reference = value_type&;
     using pointer = value_type*;
     using iterator_category = std::input_iterator_tag;
 
-    explicit WordListIterator(value_type words, value_type wend) : _words(words), _wend(wend) {
+    explicit BasicWordListIterator(value_type words, value_type wend) : _words(words), _wend(wend) {
         UpdateWordLength();
     }
 
-    WordListIterator& operator++() {
+    BasicWordListIterator& operator++() {
         if (static_cast<ptrdiff_t>(_wlen) == _wend - _words)
             _words = _wend;
         else
@@ -29,15 +35,15 @@ public:
         UpdateWordLength();
         return *this;
     }
-    WordListIterator operator++(int) {
-        WordListIterator old = *this;
+    BasicWordListIterator operator++(int) {
+        BasicWordListIterator old = *this;
         ++*this;
         return old;
     }
-    constexpr bool operator==(const WordListIterator& other) const {
+    constexpr bool operator==(const BasicWordListIterator& other) const {
         return other._words == _words;
     }
-    constexpr bool operator!=(const WordListIterator& other) const {
+    constexpr bool operator!=(const BasicWordListIterator& other) const {
         return !(*this == other);
     }
     constexpr bool operator==(value_type other) const {
@@ -55,15 +61,42 @@ public:
     constexpr size_t wlen() const {
         return _wlen;
     }
+    /// <summary>
+    /// the current word as wchar_t: a view into the list when CharT is as wide as wchar_t,
+    /// otherwise a copy with surrogate pairs decoded
+    /// </summary>
+    auto wstr() const {
+        if constexpr (sizeof(CharT) == sizeof(wchar_t)) {
+            return std::wstring_view(reinterpret_cast<const wchar_t*>(_words), _wlen);
+        } else {
+            std::wstring word;
+            word.reserve(_wlen);
+            for (size_t i = 0; i < _wlen; i++) {
+                auto c = static_cast<char32_t>(_words[i]);
+                if (c >= 0xd800 && c < 0xdc00 && i + 1 < _wlen && _words[i + 1] >= 0xdc00 && _words[i + 1] < 0xe000) {
+                    c = 0x10000 + ((c - 0xd800) << 10) + (_words[i + 1] - 0xdc00);
+                    i++;
+                }
+                word.push_back(static_cast<wchar_t>(c));
+            }
+            return word;
+        }
+    }
 
 private:
     void UpdateWordLength() {
-        _wlen = wcsnlen_s(_words, _wend - _words);
+        auto rem = static_cast<size_t>(_wend - _words);
+        auto nul = std::char_traits<CharT>::find(_words, rem, CharT{});
+        _wlen = nul ? static_cast<size_t>(nul - _words) : rem;
     }
 
-    const wchar_t *_words, *_wend;
+    const CharT *_words, *_wend;
     size_t _wlen;
 };
 
+using WordListIterator = BasicWordListIterator<wchar_t>;
+// the word lists are UTF-16, which is not what wchar_t holds outside of Windows
+using Utf16WordListIterator = BasicWordListIterator<char16_t>;
+
 } // namespace TestLib
 } // namespace VietType
@@ -19,12 +19,12 @@ static const GUID GUID_LanguageBarButton_Item = {
 static const GUID GUID_SystemNotifyCompartment = {
     0xb2fbd2e7, 0x922f, 0x4996, {0xbe, 0x77, 0x21, 0x8, 0x5b, 0x91, 0xa8, 0xf0}};
 
-_Check_return_ HRESULT
-EngineController::Initialize(_In_ Telex::ITelexEngine* engine, _In_ ITfThreadMgr* threadMgr, _In_ TfClientId clientid) {
+_Check_return_ HRESULT EngineController::Initialize(_In_ ITfThreadMgr* threadMgr, _In_ TfClientId clientid) {
 
     HRESULT hr;
 
-    _engine = engine;
+    // replaced with one for the user's settings in UpdateStates
+    _engine = std::unique_ptr<Telex::ITelexEngine>(Telex::TelexNew(Telex::TelexConfig{}));
     _clientid = clientid;
 
     hr = threadMgr->QueryInterface(&_langBarItemMgr);
@@ -75,7 +75,7 @@ HRESULT EngineController::Uninitialize() {
     DBG_HRESULT_CHECK(hr, L"%s", L"UninitLanguageBar failed");
 
     _langBarItemMgr.Release();
-    _engine = nullptr;
+    _engine.reset();
 
     return S_OK;
 }
@@ -149,6 +149,14 @@ EngineSettingsController* EngineController::GetSettings() const {
     return _settings;
 }
 
+void EngineController::SetEngineConfig(const Telex::TelexConfig& cfg) {
+    if (_engine->SetConfig(cfg)) {
+        return;
+    }
+    // the engine has the options checked while typing compiled in, so changing them takes a new engine
+    _engine = std::unique_ptr<Telex::ITelexEngine>(Telex::TelexNewFrom(*_engine, cfg));
+}
+
 HRESULT EngineController::UpdateStates(bool foreground) {
     HRESULT hr;
 
@@ -171,7 +179,7 @@ HRESULT EngineController::UpdateStates(bool foreground) {
         Telex::TelexConfig cfg = GetEngine().GetConfig();
         hr = _settings->LoadTelexSettings(cfg);
         DBG_HRESULT_CHECK(hr, L"%s", L"_settings->LoadSettings failed") else {
-            GetEngine().SetConfig(cfg);
+            SetEngineConfig(cfg);
         }
     }
 
@@ -38,8 +38,7 @@ public:
     END_COM_MAP()
     DECLARE_PROTECT_FINAL_CONSTRUCT()
 
-    _Check_return_ HRESULT
-    Initialize(_In_ Telex::ITelexEngine* engine, _In_ ITfThreadMgr* threadMgr, _In_ TfClientId clientid);
+    _Check_return_ HRESULT Initialize(_In_ ITfThreadMgr* threadMgr, _In_ TfClientId clientid);
     HRESULT Uninitialize();
 
     Telex::ITelexEngine& GetEngine();
@@ -63,11 +62,12 @@ public:
 private:
     _Check_return_ HRESULT InitLanguageBar();
     HRESULT UninitLanguageBar();
+    void SetEngineConfig(const Telex::TelexConfig& cfg);
 
 private:
     bool _initialized = false;
 
-    Telex::ITelexEngine* _engine = nullptr;
+    std::unique_ptr<Telex::ITelexEngine> _engine;
     CComPtr<ITfLangBarItemMgr> _langBarItemMgr;
 
     TfClientId _clientid = TF_CLIENTID_NULL;
@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright (c) 2018 Dinh Ngoc Tu
 // SPDX-License-Identifier: GPL-3.0-only
 
+#include <array>
 #include "KeyHandler.h"
 #include "Telex.h"
 #include "KeyTranslator.h"
@@ -75,14 +76,17 @@ HRESULT KeyHandlerEditSession::Uninitialize() {
 
 HRESULT KeyHandlerEditSession::ComposeKey(_In_ TfEditCookie ec) {
     HRESULT hr;
+    // composition text is rebuilt after every key, keep it off the heap
+    std::array<wchar_t, Telex::MaxOutputLength + 1> str;
 
     DBG_DPRINT(L"%s", L"");
 
     switch (PushKey(_controller->GetEngine(), _wParam, _lParam, _keyState)) {
     case Telex::TelexStates::Valid: {
         if (_controller->GetEngine().Count()) {
-            auto str = _controller->GetEngine().Peek();
-            hr = _compositionManager->EnsureCompositionText(ec, _context, &str[0], static_cast<LONG>(str.length()));
+            auto length = _controller->GetEngine().Peek(std::span(str).first(Telex::MaxOutputLength));
+            str[length] = 0;
+            hr = _compositionManager->EnsureCompositionText(ec, _context, str.data(), static_cast<LONG>(length));
             DBG_HRESULT_CHECK(hr, L"%s", L"_compositionManager->EnsureCompositionText failed");
         } else {
             // backspace returns Valid on an empty buffer
@@ -98,8 +102,9 @@ HRESULT KeyHandlerEditSession::ComposeKey(_In_ TfEditCookie ec) {
 
     case Telex::TelexStates::Invalid: {
         assert(_controller->GetEngine().Count() > 0);
-        auto str = _controller->GetEngine().RetrieveRaw();
-        hr = _compositionManager->EnsureCompositionText(ec, _context, &str[0], static_cast<LONG>(str.length()));
+        auto length = _controller->GetEngine().RetrieveRaw(std::span(str).first(Telex::MaxOutputLength));
+        str[length] = 0;
+        hr = _compositionManager->EnsureCompositionText(ec, _context, str.data(), static_cast<LONG>(length));
         DBG_HRESULT_CHECK(hr, L"%s", L"_compositionManager->EnsureCompositionText failed");
         break;
     }
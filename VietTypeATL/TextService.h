@@ -16,10 +16,6 @@ using namespace ATL;
 
 namespace VietType {
 
-namespace Telex {
-class ITelexEngine;
-}
-
 class ThreadMgrEventSink;
 class KeyEventSink;
 class CompositionManager;
@@ -61,8 +57,6 @@ private:
     TfClientId _clientId = TF_CLIENTID_NULL;
     DWORD _activateFlags = 0;
 
-    std::unique_ptr<Telex::ITelexEngine> _engine;
-
     CComPtr<EngineController> _engineController;
 
     CComPtr<VietType::EnumDisplayAttributeInfo> _attributeStore;
@@ -0,0 +1,152 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Telex.h"
+#include "Util.h"
+#include "TelexAutocorrect.h"
+#include "TelexEngine.h"
+#include "TelexDfa.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace VietType::Telex;
+
+namespace VietType {
+namespace UnitTests {
+
+TEST_CLASS (TestAutocorrect) {
+    // the built-in rules, then uo before ng -> ươ and qa -> qua
+    static AutocorrectRules MakeRules() {
+        auto builtin = AutocorrectRules::BuiltinRules();
+        std::vector<AutocorrectRule> rules(builtin.begin(), builtin.end());
+        rules.push_back({.v = L"uo", .c2 = L"ng", .newV = L"\x1b0\x1a1"});
+        rules.push_back({.c1 = L"q", .v = L"a", .newV = L"ua"});
+        return AutocorrectRules::Compile(rules);
+    }
+
+    // the autocorrect only shows on Commit
+    static void TestCommit(ITelexEngine& e, const wchar_t* expected, const wchar_t* input) {
+        FeedWord(e, input);
+        AssertTelexStatesEqual(TelexStates::Committed, e.Commit());
+        Assert::AreEqual(expected, e.Retrieve().c_str());
+    }
+
+    static std::wstring Show(std::optional<std::wstring_view> part) {
+        return part ? std::wstring(*part) : L"-";
+    }
+
+public:
+    TEST_METHOD (TestAutocorrectBuiltin) {
+        const auto& rules = AutocorrectRules::Default();
+        Assert::AreEqual(size_t{0}, rules.Issues().size());
+        Assert::AreEqual(AutocorrectRules::BuiltinRules().size(), rules.Count());
+
+        Assert::AreEqual(L"\x1b0u", Show(rules.Find(L"", L"wu", L"", Tones::Z, 0).v).c_str());
+        Assert::AreEqual(L"\x1a1", Show(rules.Find(L"nh", L"wo", L"", Tones::Z, AutocorrectHasC1).v).c_str());
+        Assert::AreEqual(L"-", Show(rules.Find(L"", L"wo", L"", Tones::Z, 0).v).c_str());
+        Assert::AreEqual(L"ch", Show(rules.Find(L"b", L"a", L"h", Tones::S, AutocorrectHasC1).c2).c_str());
+        Assert::AreEqual(L"-", Show(rules.Find(L"b", L"a", L"h", Tones::Z, AutocorrectHasC1).c2).c_str());
+        Assert::AreEqual(L"nh", Show(rules.Find(L"b", L"a", L"h", Tones::Z, AutocorrectMultilangLow).c2).c_str());
+        Assert::AreEqual(L"nh", Show(rules.Find(L"b", L"\xea", L"h", Tones::R, AutocorrectValidRespos).c2).c_str());
+        Assert::AreEqual(L"-", Show(rules.Find(L"b", L"o", L"h", Tones::Z, AutocorrectMultilangLow).c2).c_str());
+
+        // both parts at once, each from its own rule
+        auto both = rules.Find(L"h", L"wuo", L"gn", Tones::Z, AutocorrectHasC1 | AutocorrectValidRespos);
+        Assert::AreEqual(L"\x1b0\x1a1", Show(both.v).c_str());
+        Assert::AreEqual(L"ng", Show(both.c2).c_str());
+
+        Assert::IsTrue(rules.MayRewrite(AutocorrectRules::V, L"w"));
+        Assert::IsTrue(rules.MayRewrite(AutocorrectRules::V, L"wuo"));
+        Assert::IsFalse(rules.MayRewrite(AutocorrectRules::V, L"wuoo"));
+        Assert::IsTrue(rules.MayRewrite(AutocorrectRules::C2, L"g"));
+        Assert::IsFalse(rules.MayRewrite(AutocorrectRules::C2, L"k"));
+    }
+
+    TEST_METHOD (TestAutocorrectOrder) {
+        std::vector<AutocorrectRule> list{
+            {.v = L"a", .tones = AutocorrectRule::ToneBit(Tones::S), .newV = L"o"},
+            {.v = L"a", .newV = L"e"},
+            {.v = L"a", .newV = L"i", .newC2 = L"n"},
+            {.c2 = L"t", .newC2 = L"c"},
+            {.c1 = L"b", .newV = L"u"},
+        };
+        auto rules = AutocorrectRules::Compile(list);
+        Assert::AreEqual(list.size(), rules.Count());
+        // the first rule that matches wins each part, and a rule is skipped once either of its parts is taken
+        Assert::AreEqual(L"o", Show(rules.Find(L"", L"a", L"", Tones::S, 0).v).c_str());
+        Assert::AreEqual(L"e", Show(rules.Find(L"", L"a", L"", Tones::F, 0).v).c_str());
+        Assert::AreEqual(L"-", Show(rules.Find(L"", L"a", L"", Tones::F, 0).c2).c_str());
+        auto r = rules.Find(L"b", L"a", L"t", Tones::Z, 0);
+        Assert::AreEqual(L"e", Show(r.v).c_str());
+        Assert::AreEqual(L"c", Show(r.c2).c_str());
+        Assert::AreEqual(L"u", Show(rules.Find(L"b", L"o", L"", Tones::Z, 0).v).c_str());
+        Assert::AreEqual(L"-", Show(rules.Find(L"c", L"o", L"", Tones::Z, 0).v).c_str());
+        // parts too long to be a pattern only match wildcards
+        Assert::AreEqual(L"c", Show(rules.Find(L"nghhh", L"uyeee", L"t", Tones::Z, 0).c2).c_str());
+    }
+
+    TEST_METHOD (TestAutocorrectIssues) {
+        std::vector<AutocorrectRule> list{
+            {.v = L"uyeee", .newV = L"uy\xea"},
+            {.v = L"a", .newC2 = L"nnnnn"},
+            {.v = L"a"},
+            {.v = L"a", .tones = 0, .newV = L"e"},
+            {.v = L"a", .newV = L"e"},
+        };
+        auto rules = AutocorrectRules::Compile(list);
+        Assert::AreEqual(size_t{1}, rules.Count());
+        Assert::AreEqual(size_t{4}, rules.Issues().size());
+        Assert::AreEqual(L"e", Show(rules.Find(L"", L"a", L"", Tones::Z, 0).v).c_str());
+
+        AutocorrectRules empty;
+        Assert::AreEqual(L"-", Show(empty.Find(L"", L"wu", L"", Tones::Z, 0).v).c_str());
+    }
+
+    TEST_METHOD (TestAutocorrectCommit) {
+        auto rules = MakeRules();
+        Assert::AreEqual(size_t{0}, rules.Issues().size());
+        TelexConfig config;
+        config.autocorrect = true;
+        auto e = std::unique_ptr<ITelexEngine>(TelexNew(config));
+        TestInvalidWord(*e, L"tuong", L"tuong");
+        TestInvalidWord(*e, L"QAN", L"QAN");
+
+        config.autocorrect_rules = &rules;
+        e = std::unique_ptr<ITelexEngine>(TelexNew(config));
+        TestCommit(*e, L"t\x1b0\x1a1ng", L"tuong");
+        TestCommit(*e, L"T\x1af\x1edc" L"NG", L"TUONGF");
+        // an added character takes the case of the first one of its part
+        TestCommit(*e, L"QUAN", L"QAN");
+        TestCommit(*e, L"Qu\xe1n", L"Qans");
+        TestCommit(*e, L"h\x1b0\x1a1ng", L"hwuogn");
+        TestCommit(*e, L"NH\x1a0", L"NHWO");
+    }
+
+    TEST_METHOD (TestAutocorrectDfa) {
+        auto rules = MakeRules();
+        TelexConfig config;
+        config.autocorrect = true;
+        config.autocorrect_rules = &rules;
+        std::vector<std::wstring> seeds{L"tuong", L"qans", L"hwuogn"};
+        size_t unminimized;
+        auto dfa = TelexDfa::Build(config, seeds, &unminimized);
+        TelexDfaEngine e(dfa);
+        TestCommit(e, L"t\x1b0\x1a1ng", L"tuong");
+        TestCommit(e, L"Qu\xe1n", L"Qans");
+        TestCommit(e, L"h\x1b0\x1a1ng", L"hwuogn");
+        Assert::IsFalse(e.IsFallback());
+
+        config.autocorrect_rules = nullptr;
+        e.SetConfig(config);
+        e.Reset();
+        TestInvalidWord(e, L"tuong", L"tuong");
+    }
+};
+
+} // namespace UnitTests
+} // namespace VietType
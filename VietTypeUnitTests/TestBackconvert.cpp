@@ -0,0 +1,190 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Telex.h"
+#include "FileUtil.hpp"
+#include "Util.h"
+#include "TelexEngine.h"
+#include "TelexBackconvert.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace VietType::Telex;
+using namespace VietType::TestLib;
+
+namespace VietType {
+namespace UnitTests {
+
+// Backconvert builds most words directly and must leave the engine exactly as BackconvertReplay does
+TEST_CLASS (TestBackconvert) {
+    std::vector<std::wstring> words;
+    std::vector<std::wstring> englishWords;
+
+    // the checkpoints only show through Backspace, so backspace both down to nothing and type the last key again
+    static void CheckWord(const TelexConfig& config, const std::wstring& word) {
+        TelexEngine direct(config);
+        TelexEngine replay(config);
+        direct.Backconvert(word);
+        replay.BackconvertReplay(word);
+        AssertSameEngine(replay, direct, word);
+
+        TelexEngine directCommit(direct);
+        TelexEngine replayCommit(replay);
+        directCommit.Commit();
+        replayCommit.Commit();
+        AssertSameEngine(replayCommit, directCommit, word + L'!');
+
+        // typing on, cancelling and backspacing out of the word, BackconvertFailed included
+        for (auto key : {L'j', L'\xea', L'e', L'<', L'~'}) {
+            TelexEngine directNext(direct);
+            TelexEngine replayNext(replay);
+            if (key == L'<') {
+                directNext.Backspace();
+                replayNext.Backspace();
+            } else if (key == L'~') {
+                directNext.Cancel();
+                replayNext.Cancel();
+            } else {
+                directNext.PushChar(key);
+                replayNext.PushChar(key);
+            }
+            AssertSameEngine(replayNext, directNext, word + key);
+            directNext.Commit();
+            replayNext.Commit();
+            AssertSameEngine(replayNext, directNext, word + key + L'!');
+        }
+
+        if (direct.GetState() != TelexStates::Valid && direct.GetState() != TelexStates::Invalid) {
+            return;
+        }
+        auto msg = word;
+        while (direct.Count()) {
+            direct.Backspace();
+            replay.Backspace();
+            msg.push_back(L'<');
+            AssertSameEngine(replay, direct, msg);
+        }
+    }
+
+    // level 2 only differs from level 1 in Commit, which is compared too
+    static std::vector<TelexConfig> AllConfigs() {
+        std::vector<TelexConfig> configs;
+        for (int level = 0; level <= 3; level++) {
+            for (int flags = 0; flags < 16; flags++) {
+                TelexConfig config;
+                config.optimize_multilang = level;
+                config.oa_uy_tone1 = !!(flags & 1);
+                config.accept_separate_dd = !!(flags & 2);
+                config.backspaced_word_stays_invalid = !!(flags & 4);
+                config.autocorrect = !!(flags & 8);
+                configs.push_back(config);
+            }
+        }
+        return configs;
+    }
+
+    static void CheckWords(const std::vector<std::wstring>& words, const std::vector<TelexConfig>& configs) {
+        for (const auto& config : configs) {
+            for (const auto& word : words) {
+                CheckWord(config, word);
+                auto upper = word;
+                for (auto& c : upper) {
+                    c = ToUpper(c);
+                }
+                CheckWord(config, upper);
+                auto capitalized = word;
+                capitalized[0] = ToUpper(capitalized[0]);
+                CheckWord(config, capitalized);
+            }
+        }
+    }
+
+public:
+    TestBackconvert()
+        : words(LoadWordList(L"..\\..\\data\\vw39kw.txt")), englishWords(LoadWordList(L"..\\..\\data\\ewdsw.txt")) {
+    }
+
+    TEST_METHOD (TestBackconvertWordList) {
+        Assert::IsTrue(BackconvertTable::Get().Count() > 0);
+        std::vector<TelexConfig> configs;
+        for (int level : {0, 3}) {
+            for (bool oaUyTone1 : {false, true}) {
+                TelexConfig config;
+                config.optimize_multilang = level;
+                config.oa_uy_tone1 = oaUyTone1;
+                configs.push_back(config);
+            }
+        }
+        CheckWords(words, configs);
+    }
+
+    // a sample of the word list with a letter added or the last one swapped, so most end in a tone key,
+    // a consonant that cannot end a word or a vowel that does not fit
+    TEST_METHOD (TestBackconvertMutated) {
+        std::vector<std::wstring> mutated;
+        for (size_t i = 0; i < words.size(); i += 631) {
+            for (wchar_t c = L'a'; c <= L'z'; c++) {
+                mutated.push_back(words[i] + c);
+                auto swapped = words[i];
+                swapped.back() = c;
+                mutated.push_back(swapped);
+            }
+        }
+        CheckWords(mutated, AllConfigs());
+    }
+
+    TEST_METHOD (TestBackconvertEnglish) {
+        std::vector<std::wstring> sample;
+        for (size_t i = 0; i < englishWords.size(); i += 131) {
+            sample.push_back(englishWords[i]);
+        }
+        CheckWords(sample, AllConfigs());
+    }
+
+    TEST_METHOD (TestBackconvertUnusual) {
+        std::vector<std::wstring> unusual{
+            L"g\xec",             // gì
+            L"g\xecn",            // gìn
+            L"gi\x1ebft",         // giết
+            L"qu\x1ed1\x63",      // quốc
+            L"xoong",
+            L"\x111\x111",        // đđ
+            L"d\x111",            // dđ
+            L"\x111\x1ed3n1",     // đồn1
+            L"nghi\xeangs",
+            L"ngh\x1ec9nh\x1ec9", // nghỉnhỉ
+            L"h\x1ecfng",         // hỏng
+            L"\x111\x1ecfng",     // đỏng
+            L"ho\xe0",            // hoà
+            L"h\xf2\x61",         // hòa
+            L"thu\x1edf",         // thuở
+            L"khu\x1ef7u",        // khuỷu
+            L"aa",
+            L"ee",
+            L"ww",
+            L"bc",
+            L"tr",
+            L"q",
+            L"gi",
+            L"a1",
+            L"\x1b0\x1a1",        // ươ
+            // tone keys and other consonants after the vowel are not a c2
+            L"bus",
+            L"mix",
+            L"gas",
+            L"cox",
+            L"B\xf9s",            // Bùs
+            L"m\x1ed9s",          // mộs
+            L"\x1ef7r",           // ỷr
+            L"g\xe3R",            // gãR
+            L"chuwm",
+        };
+        CheckWords(unusual, AllConfigs());
+    }
+};
+
+} // namespace UnitTests
+} // namespace VietType
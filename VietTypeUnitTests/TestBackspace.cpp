@@ -0,0 +1,186 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <string>
+#include <string_view>
+#include "Telex.h"
+#include "Util.h"
+#include "TelexEngine.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace VietType::Telex;
+
+namespace VietType {
+namespace UnitTests {
+
+// Backspace pops per-key checkpoints instead of replaying the word,
+// these tests check it against BackspaceReplay which still does the full replay
+TEST_CLASS (TestBackspace) {
+    // backspace the word down to nothing both ways, checking that the two engines agree after every step,
+    // that committing agrees, and that typing on after a backspace agrees
+    static void CheckBackspaceChain(const TelexEngine& start, std::wstring keys) {
+        TelexEngine fast(start);
+        TelexEngine replay(start);
+        bool retyped = false;
+        while (fast.Count()) {
+            auto last = keys.empty() ? L'\0' : keys.back();
+            fast.Backspace();
+            replay.BackspaceReplay();
+            keys.push_back(L'<');
+            AssertSameEngine(replay, fast, keys);
+
+            TelexEngine fastCommit(fast);
+            TelexEngine replayCommit(replay);
+            fastCommit.Commit();
+            replayCommit.Commit();
+            AssertSameEngine(replayCommit, fastCommit, keys + L'!');
+
+            if (!retyped && last && (fast.GetState() == TelexStates::Valid || fast.GetState() == TelexStates::Invalid)) {
+                retyped = true;
+                TelexEngine fastRetype(fast);
+                TelexEngine replayRetype(replay);
+                fastRetype.PushChar(last);
+                replayRetype.PushChar(last);
+                AssertSameEngine(replayRetype, fastRetype, keys + last);
+                fastRetype.Backspace();
+                replayRetype.BackspaceReplay();
+                AssertSameEngine(replayRetype, fastRetype, keys + last + L'<');
+            }
+        }
+    }
+
+    // every key sequence over the alphabet up to maxDepth
+    static void CheckAllSequences(TelexEngine& e, std::wstring& keys, std::wstring_view alphabet, size_t maxDepth) {
+        CheckBackspaceChain(e, keys);
+        if (keys.size() >= maxDepth) {
+            return;
+        }
+        for (auto c : alphabet) {
+            TelexEngine next(e);
+            next.PushChar(c);
+            keys.push_back(c);
+            CheckAllSequences(next, keys, alphabet, maxDepth);
+            keys.pop_back();
+        }
+    }
+
+    template <typename F>
+    static void ForEachConfig(F f) {
+        // level 2 only differs from level 1 in Commit
+        for (int level : {0, 1, 3}) {
+            for (int flags = 0; flags < 8; flags++) {
+                TelexConfig config;
+                config.optimize_multilang = level;
+                config.autocorrect = !!(flags & 1);
+                config.backspaced_word_stays_invalid = !!(flags & 2);
+                config.accept_separate_dd = !!(flags & 4);
+                f(config);
+            }
+        }
+    }
+
+    static void CheckAlphabet(std::wstring_view alphabet, size_t maxDepth) {
+        ForEachConfig([=](const TelexConfig& config) {
+            TelexEngine e(config);
+            std::wstring keys;
+            CheckAllSequences(e, keys, alphabet, maxDepth);
+        });
+    }
+
+public:
+    TEST_METHOD (TestBackspaceAllLetters) {
+        CheckAlphabet(L"abcdefghijklmnopqrstuvwxyz", 3);
+    }
+
+    TEST_METHOD (TestBackspaceTransitions) {
+        // the letters taking part in transitions, tones and double undos;
+        // 'z' is left out since backspacing over a tone removal can turn a Valid word Invalid,
+        // which trips the debug invariant check in BackspaceReplay as well
+        CheckAlphabet(L"adeoiuwsfnD", 4);
+    }
+
+    TEST_METHOD (TestBackspaceLongWords) {
+        ForEachConfig([](const TelexConfig& config) {
+            for (auto word : {L"nghieengsz", L"nhuwowngxf", L"dduwowngfs", L"tooooooooooooooo", L"cuwwowwwwwasdasd"}) {
+                TelexEngine e(config);
+                for (auto c : std::wstring_view(word)) {
+                    e.PushChar(c);
+                }
+                CheckBackspaceChain(e, word);
+            }
+            TelexEngine e(config);
+            std::wstring keys;
+            for (int i = 0; i < 300; i++) {
+                wchar_t c = L"aooddw"[i % 6];
+                e.PushChar(c);
+                keys.push_back(c);
+            }
+            CheckBackspaceChain(e, keys);
+        });
+    }
+
+    // past MaxResposLength keys the respos are not stored, the word must look the same from outside
+    TEST_METHOD (TestBackspacePassthrough) {
+        ForEachConfig([](const TelexConfig& config) {
+            std::wstring url(L"https://example.com/VietType/issues?q=is%3Aopen+dduwowngf");
+            for (auto prefix : {L"", L"aaa", L"ddd", L"www"}) {
+                TelexEngine e(config);
+                std::wstring keys(prefix);
+                keys += url;
+                for (auto c : keys) {
+                    e.PushChar(c);
+                }
+                Assert::AreEqual(static_cast<int>(TelexStates::Invalid), static_cast<int>(e.GetState()));
+                auto respos = e.GetRespos();
+                Assert::AreEqual(keys.size(), respos.size());
+                for (size_t i = MaxResposLength; i < respos.size(); i++) {
+                    Assert::AreEqual(
+                        static_cast<int>((respos[i - 1] & ResposMask) + 1), static_cast<int>(respos[i] & ResposMask));
+                }
+                CheckBackspaceChain(e, keys);
+            }
+        });
+    }
+
+    TEST_METHOD (TestBackspaceBackconverted) {
+        ForEachConfig([](const TelexConfig& config) {
+            for (auto word : {L"\x111\x1b0\x1a1ng", L"Tr\x1b0\x1edd", L"nghi\xeang", L"ho\xe0", L"thu\x1edf", L"\x111\x1ea5y"}) {
+                TelexEngine e(config);
+                e.Backconvert(word);
+                CheckBackspaceChain(e, word);
+            }
+        });
+    }
+
+    // words that Backconvert keeps as given although their keys type something else, then keys typed on top
+    TEST_METHOD (TestBackspaceAfterBackconvert) {
+        ForEachConfig([](const TelexConfig& config) {
+            for (auto word : {L"chuwm", L"m\x1ed9s", L"bus", L"Vi\x1ec7t", L"gi\xe0", L"thuwowr", L"\x111\x1b0\x1a1ng"}) {
+                TelexEngine e(config);
+                e.Backconvert(word);
+                std::wstring keys(word);
+                CheckAllSequences(e, keys, L"aeEojs", keys.size() + 2);
+            }
+        });
+    }
+
+    TEST_METHOD (TestBackspaceAfterSetConfig) {
+        ForEachConfig([](const TelexConfig& config) {
+            auto other = config;
+            other.autocorrect = !config.autocorrect;
+            other.optimize_multilang = 3 - config.optimize_multilang;
+            for (auto word : {L"wowf", L"ddoongf", L"aaa", L"khoongr"}) {
+                TelexEngine e(config);
+                for (auto c : std::wstring_view(word)) {
+                    e.PushChar(c);
+                }
+                e.SetConfig(other);
+                CheckBackspaceChain(e, word);
+            }
+        });
+    }
+};
+
+} // namespace UnitTests
+} // namespace VietType
@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "TelexCase.h"
+#include "TelexChars.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace VietType::Telex;
+
+namespace VietType {
+namespace UnitTests {
+
+// the run functions must give what ToUpper and ToLower give one character at a time, for every BMP code unit
+// at every offset from a vector boundary and in both character types
+TEST_CLASS (TestCase) {
+    template <typename Char>
+    static std::vector<Char> AllCodeUnits() {
+        std::vector<Char> all;
+        for (uint32_t u = 0; u <= 0xffff; u++) {
+            all.push_back(static_cast<Char>(u));
+        }
+        return all;
+    }
+
+    template <typename Char, typename Run, typename Scalar>
+    static void CheckRun(Run run, Scalar scalar) {
+        auto all = AllCodeUnits<Char>();
+        for (size_t offset = 0; offset <= 17; offset++) {
+            auto s = all;
+            run(std::span<Char>(s.data() + offset, s.size() - offset));
+            for (size_t i = 0; i < s.size(); i++) {
+                auto expected = i < offset ? all[i] : static_cast<Char>(scalar(static_cast<wchar_t>(all[i])));
+                Assert::AreEqual(static_cast<uint32_t>(expected), static_cast<uint32_t>(s[i]));
+            }
+        }
+    }
+
+    template <typename Char>
+    static void CheckCaseBits() {
+        auto all = AllCodeUnits<Char>();
+        std::mt19937_64 rng(20260101);
+        std::vector<uint64_t> bits(all.size() / 64);
+        for (auto& b : bits) {
+            // runs of no bits at all take the skip
+            b = rng() % 4 ? rng() : 0;
+        }
+        for (size_t offset = 0; offset <= 17; offset++) {
+            auto s = all;
+            ApplyCaseBits(std::span<Char>(s.data(), s.size() - offset), bits);
+            for (size_t i = 0; i < s.size(); i++) {
+                auto upper = i < s.size() - offset && ((bits[i / 64] >> (i % 64)) & 1);
+                auto expected = upper ? static_cast<Char>(ToUpper(static_cast<wchar_t>(all[i]))) : all[i];
+                Assert::AreEqual(static_cast<uint32_t>(expected), static_cast<uint32_t>(s[i]));
+            }
+        }
+    }
+
+public:
+    TEST_METHOD (TestCaseUpper) {
+        CheckRun<char16_t>([](std::span<char16_t> s) { ToUpperRun(s); }, ToUpper);
+        CheckRun<wchar_t>([](std::span<wchar_t> s) { ToUpperRun(s); }, ToUpper);
+    }
+
+    TEST_METHOD (TestCaseLower) {
+        CheckRun<char16_t>([](std::span<char16_t> s) { ToLowerRun(s); }, ToLower);
+        CheckRun<wchar_t>([](std::span<wchar_t> s) { ToLowerRun(s); }, ToLower);
+    }
+
+    TEST_METHOD (TestCaseBits) {
+        CheckCaseBits<char16_t>();
+        CheckCaseBits<wchar_t>();
+    }
+
+    TEST_METHOD (TestCaseShortRuns) {
+        std::wstring word = L"NGHI\x1ebeNG vi\x1ec7t \x1af\x1a0 \x1b0\x1a1";
+        for (size_t n = 0; n <= word.size(); n++) {
+            auto s = word.substr(0, n);
+            ToLowerRun(std::span<wchar_t>(s.data(), s.size()));
+            for (size_t i = 0; i < n; i++) {
+                Assert::AreEqual(ToLower(word[i]), s[i]);
+            }
+            ToUpperRun(std::span<wchar_t>(s.data(), s.size()));
+            for (size_t i = 0; i < n; i++) {
+                Assert::AreEqual(ToUpper(word[i]), s[i]);
+            }
+        }
+    }
+};
+
+} // namespace UnitTests
+} // namespace VietType
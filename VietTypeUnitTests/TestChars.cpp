@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <algorithm>
+#include <array>
+#include "TelexChars.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace VietType::Telex;
+
+namespace VietType {
+namespace UnitTests {
+
+// the Vietnamese letters outside a-z that the surrounding word scanner used to search
+static const std::array<wchar_t, 134> vietnamesechars_notaz = {
+    L'\xc0',   L'\xc1',   L'\xc2',   L'\xc3',   L'\xc8',   L'\xc9',   L'\xca',   L'\xcc',   L'\xcd',   L'\xd2',
+    L'\xd3',   L'\xd4',   L'\xd5',   L'\xd9',   L'\xda',   L'\xdd',   L'\xe0',   L'\xe1',   L'\xe2',   L'\xe3',
+    L'\xe8',   L'\xe9',   L'\xea',   L'\xec',   L'\xed',   L'\xf2',   L'\xf3',   L'\xf4',   L'\xf5',   L'\xf9',
+    L'\xfa',   L'\xfd',   L'\x102',  L'\x103',  L'\x110',  L'\x111',  L'\x128',  L'\x129',  L'\x168',  L'\x169',
+    L'\x1a0',  L'\x1a1',  L'\x1af',  L'\x1b0',  L'\x1ea0', L'\x1ea1', L'\x1ea2', L'\x1ea3', L'\x1ea4', L'\x1ea5',
+    L'\x1ea6', L'\x1ea7', L'\x1ea8', L'\x1ea9', L'\x1eaa', L'\x1eab', L'\x1eac', L'\x1ead', L'\x1eae', L'\x1eaf',
+    L'\x1eb0', L'\x1eb1', L'\x1eb2', L'\x1eb3', L'\x1eb4', L'\x1eb5', L'\x1eb6', L'\x1eb7', L'\x1eb8', L'\x1eb9',
+    L'\x1eba', L'\x1ebb', L'\x1ebc', L'\x1ebd', L'\x1ebe', L'\x1ebf', L'\x1ec0', L'\x1ec1', L'\x1ec2', L'\x1ec3',
+    L'\x1ec4', L'\x1ec5', L'\x1ec6', L'\x1ec7', L'\x1ec8', L'\x1ec9', L'\x1eca', L'\x1ecb', L'\x1ecc', L'\x1ecd',
+    L'\x1ece', L'\x1ecf', L'\x1ed0', L'\x1ed1', L'\x1ed2', L'\x1ed3', L'\x1ed4', L'\x1ed5', L'\x1ed6', L'\x1ed7',
+    L'\x1ed8', L'\x1ed9', L'\x1eda', L'\x1edb', L'\x1edc', L'\x1edd', L'\x1ede', L'\x1edf', L'\x1ee0', L'\x1ee1',
+    L'\x1ee2', L'\x1ee3', L'\x1ee4', L'\x1ee5', L'\x1ee6', L'\x1ee7', L'\x1ee8', L'\x1ee9', L'\x1eea', L'\x1eeb',
+    L'\x1eec', L'\x1eed', L'\x1eee', L'\x1eef', L'\x1ef0', L'\x1ef1', L'\x1ef2', L'\x1ef3', L'\x1ef4', L'\x1ef5',
+    L'\x1ef6', L'\x1ef7', L'\x1ef8', L'\x1ef9',
+};
+
+// every BMP code unit goes through the table, check all of them against the rules it was built from
+TEST_CLASS (TestChars) {
+public:
+    TEST_METHOD (TestCharsCase) {
+        for (uint32_t u = 0; u <= 0xffff; u++) {
+            auto c = static_cast<wchar_t>(u);
+            Assert::AreEqual(ToUpperRule(c), ToUpper(c));
+            Assert::AreEqual(ToLowerRule(c), ToLower(c));
+        }
+        Assert::AreEqual(L'\x1af', ToUpper(L'\x1b0'));
+        Assert::AreEqual(L'\x1b0', ToLower(L'\x1af'));
+        Assert::AreEqual(L'\x110', ToUpper(L'\x111'));
+    }
+
+    TEST_METHOD (TestCharsLetters) {
+        for (uint32_t u = 0; u <= 0xffff; u++) {
+            auto c = static_cast<wchar_t>(u);
+            auto expected = (c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z') ||
+                            std::binary_search(vietnamesechars_notaz.begin(), vietnamesechars_notaz.end(), c);
+            Assert::AreEqual(expected, IsVietnameseLetter(c));
+            if (expected) {
+                Assert::AreEqual(
+                    static_cast<int>(GetCharInfo(ToLower(c)).letter), static_cast<int>(GetCharInfo(c).letter));
+                Assert::IsTrue(GetCharInfo(c).letter < CharLetterCount);
+            }
+        }
+    }
+
+    TEST_METHOD (TestCharsClasses) {
+        for (uint32_t u = 0; u <= 0xffff; u++) {
+            auto c = static_cast<wchar_t>(u);
+            auto expected = c >= L'a' && c <= L'z' ? letterClasses[c - L'a'] : CharTypes::Uncategorized;
+            Assert::AreEqual(static_cast<unsigned int>(expected), static_cast<unsigned int>(ClassifyCharacter(c)));
+        }
+    }
+};
+
+} // namespace UnitTests
+} // namespace VietType
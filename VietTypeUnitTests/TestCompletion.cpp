@@ -0,0 +1,187 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "CompletionTrie.h"
+#include "Telex.h"
+#include "TelexData.h"
+#include "TelexEngine.h"
+#include "WordListIterator.hpp"
+#include "FileUtil.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace VietType::Completion;
+using namespace VietType::Telex;
+using namespace VietType::TestLib;
+
+namespace VietType {
+namespace UnitTests {
+
+// every lookup must give what a scan of the whole word list gives
+TEST_CLASS (TestCompletion) {
+    std::vector<std::wstring> words;
+
+    // the tone of the word as a character followed by its letters without the tone, empty if more than one tone
+    static std::wstring ReferenceKey(std::wstring_view word) {
+        std::wstring key(1, L'0');
+        if (word.size() > CompletionTrie::MaxWordLength) {
+            return {};
+        }
+        for (auto c : word) {
+            if (!IsVietnameseLetter(c)) {
+                return {};
+            }
+            c = ToLower(c);
+            for (const auto& [base, toned] : transitions_tones) {
+                auto t = toned.find(c);
+                if (t != std::wstring_view::npos && t > 0) {
+                    if (key[0] != L'0') {
+                        return {};
+                    }
+                    key[0] = static_cast<wchar_t>(L'0' + t);
+                    c = base;
+                    break;
+                }
+            }
+            key.push_back(c);
+        }
+        return key;
+    }
+
+    static bool ReferenceMatch(const std::wstring& prefixKey, const std::wstring& wordKey) {
+        return (prefixKey[0] == L'0' || prefixKey[0] == wordKey[0]) && wordKey.size() >= prefixKey.size() &&
+               std::equal(prefixKey.begin() + 1, prefixKey.end(), wordKey.begin() + 1);
+    }
+
+    // weights of the best matches in order, and the words that may be among them
+    static void CheckPrefix(
+        const CompletionTrie& trie,
+        const std::vector<std::wstring>& keys,
+        const std::vector<uint32_t>& weights,
+        std::wstring_view prefix) {
+        auto msg = std::wstring(prefix);
+        auto prefixKey = ReferenceKey(prefix);
+        std::vector<std::pair<uint32_t, const std::wstring*>> expected;
+        std::set<std::wstring> seen;
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (!keys[i].empty() && ReferenceMatch(prefixKey, keys[i]) && seen.insert(keys[i]).second) {
+                expected.emplace_back(weights[i], &keys[i]);
+            }
+        }
+        std::stable_sort(
+            expected.begin(), expected.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+        std::array<CompletionResult, CompletionTrie::MaxResults> results;
+        auto count = trie.Complete(prefix, results);
+        Assert::AreEqual(std::min(expected.size(), results.size()), count, msg.c_str());
+        std::set<std::wstring> returned;
+        for (size_t i = 0; i < count; i++) {
+            Assert::AreEqual(expected[i].first, results[i].weight, msg.c_str());
+            auto key = ReferenceKey(results[i].word);
+            Assert::IsTrue(ReferenceMatch(prefixKey, key), msg.c_str());
+            Assert::IsTrue(returned.insert(key).second, msg.c_str());
+        }
+    }
+
+    static std::vector<std::wstring> AllPrefixes(const std::vector<std::wstring>& words) {
+        std::set<std::wstring> prefixes;
+        for (const auto& w : words) {
+            for (size_t n = 0; n <= w.size(); n++) {
+                prefixes.insert(w.substr(0, n));
+            }
+        }
+        return std::vector<std::wstring>(prefixes.begin(), prefixes.end());
+    }
+
+    void CheckWeights(const std::vector<uint32_t>& weights) {
+        std::vector<std::wstring_view> views(words.begin(), words.end());
+        auto trie = CompletionTrie::Build(views, weights);
+        std::vector<std::wstring> keys;
+        std::vector<uint32_t> referenceWeights;
+        for (size_t i = 0; i < words.size(); i++) {
+            keys.push_back(ReferenceKey(words[i]));
+            referenceWeights.push_back(
+                weights.empty() ? static_cast<uint32_t>(CompletionTrie::MaxWordLength - words[i].size()) : weights[i]);
+        }
+        for (const auto& prefix : AllPrefixes(words)) {
+            CheckPrefix(trie, keys, referenceWeights, prefix);
+        }
+    }
+
+public:
+    TestCompletion() {
+        long long fsize = 0;
+        std::unique_ptr<char16_t, decltype(FreeFile)*> file{
+            static_cast<char16_t*>(ReadWholeFile(L"..\\..\\data\\vw39kw.txt", &fsize)), FreeFile};
+        auto wend = file.get() + fsize / sizeof(char16_t);
+        for (Utf16WordListIterator w(file.get(), wend); w != wend; w++) {
+            if (w.wlen()) {
+                words.emplace_back(w.wstr());
+            }
+        }
+    }
+
+    TEST_METHOD (TestCompletionWordList) {
+        Assert::IsTrue(words.size() > 6000);
+        CheckWeights({});
+    }
+
+    TEST_METHOD (TestCompletionWeights) {
+        // distinct weights, so that the order is fully decided by them
+        std::vector<uint32_t> weights;
+        for (uint32_t i = 0; i < words.size(); i++) {
+            weights.push_back((i * 2654435761u) ^ 0x5bd1e995u);
+        }
+        CheckWeights(weights);
+    }
+
+    TEST_METHOD (TestCompletionTones) {
+        std::vector<std::wstring_view> views(words.begin(), words.end());
+        auto trie = CompletionTrie::Build(views);
+        std::array<CompletionResult, 4> results;
+        // a prefix without a tone completes to every tone, one with a tone only to that tone wherever it sits
+        Assert::AreEqual(size_t(4), trie.Complete(L"vi\xea", results));
+        auto count = trie.Complete(L"h\xf2" L"a", results);
+        Assert::IsTrue(count > 0);
+        for (size_t i = 0; i < count; i++) {
+            Assert::AreEqual(L'1', ReferenceKey(results[i].word)[0]);
+        }
+        Assert::AreEqual(size_t(0), trie.Complete(L"h\xf2\xe0", results));
+        Assert::AreEqual(size_t(0), trie.Complete(L"xyz1", results));
+        Assert::AreEqual(size_t(4), trie.Complete(L"NGH", results));
+    }
+
+    TEST_METHOD (TestCompletionEngine) {
+        std::vector<std::wstring_view> views(words.begin(), words.end());
+        auto trie = CompletionTrie::Build(views);
+        TelexConfig config;
+        TelexEngine e(config);
+        for (auto c : std::wstring_view(L"Nghieen")) {
+            e.PushChar(c);
+        }
+        std::array<CompletionResult, CompletionTrie::MaxResults> results;
+        auto count = trie.Complete(e, results);
+        Assert::AreEqual(L"nghi\xean", std::wstring(results[0].word).c_str());
+        Assert::IsTrue(std::any_of(results.begin(), results.begin() + count, [](const auto& r) {
+            return r.word == L"nghi\xeang";
+        }));
+    }
+
+    TEST_METHOD (TestCompletionEmpty) {
+        auto trie = CompletionTrie::Build({});
+        std::array<CompletionResult, 4> results;
+        Assert::AreEqual(size_t(0), trie.Complete(L"a", results));
+        Assert::AreEqual(size_t(0), trie.Complete(L"", results));
+    }
+};
+
+} // namespace UnitTests
+} // namespace VietType
@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include "Telex.h"
+#include "Util.h"
+#include "TelexConvert.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace VietType::Telex;
+
+namespace VietType {
+namespace UnitTests {
+
+TEST_CLASS (TestConvert) {
+    // words and separators mixed so that chunk boundaries land everywhere
+    static std::wstring MakeText(size_t words) {
+        static const wchar_t* vocabulary[] = {
+            L"Vieetj", L"nam", L"ddaays", L"laf", L"tieengs", L"aaa", L"www", L"nguwowif", L"tesst", L"khoong",
+            L"DDUWOWNGF"};
+        static const wchar_t* separators[] = {L" ", L", ", L".\r\n", L"\t", L"123", L" (", L") "};
+        std::wstring text;
+        for (size_t i = 0; i < words; i++) {
+            text.append(vocabulary[(i * 7) % std::size(vocabulary)]);
+            text.append(separators[(i * 3) % std::size(separators)]);
+        }
+        return text;
+    }
+
+public:
+    TEST_METHOD (TestConvertSentence) {
+        TelexConfig config;
+        Assert::AreEqual(
+            L"Vi\x1ec7t Nam, \x111\x1ea5y l\xe0 ti\x1ebfng Vi\x1ec7t.",
+            ConvertText(config, L"Vieetj Nam, ddaays laf tieengs Vieetj.").c_str());
+        Assert::AreEqual(
+            L"\x110\xe2y\tl\xe0\r\n12 TI\x1ebeNG", ConvertText(config, L"Ddaay\tlaf\r\n12 TIEENGS").c_str());
+        Assert::AreEqual(L"", ConvertText(config, L"").c_str());
+        Assert::AreEqual(L" ,. ", ConvertText(config, L" ,. ").c_str());
+    }
+
+    TEST_METHOD (TestConvertInvalidWords) {
+        TelexConfig config;
+        Assert::AreEqual(L"aa www", ConvertText(config, L"aaa www").c_str());
+        // longer than the engine can hold, the double undo at the start is still dropped
+        std::wstring longWord(1000, L'x');
+        Assert::AreEqual(
+            (L"aa" + longWord + L" \x111\xe2y").c_str(), ConvertText(config, L"aaa" + longWord + L" ddaay").c_str());
+    }
+
+    TEST_METHOD (TestConvertMatchesEngine) {
+        TelexConfig config;
+        auto engine = std::unique_ptr<ITelexEngine>(TelexNew(config));
+        auto text = MakeText(200);
+        std::wstring expected;
+        size_t wordStart = 0;
+        for (size_t i = 0; i <= text.size(); i++) {
+            if (i == text.size() || IsSeparatorCharacter(text[i])) {
+                if (i > wordStart) {
+                    engine->Reset();
+                    for (auto c : std::wstring_view(text).substr(wordStart, i - wordStart)) {
+                        engine->PushChar(c);
+                    }
+                    engine->Commit();
+                    expected.append(engine->Retrieve());
+                }
+                if (i < text.size()) {
+                    expected.push_back(text[i]);
+                }
+                wordStart = i + 1;
+            }
+        }
+        Assert::AreEqual(expected.c_str(), ConvertText(config, text, 1).c_str());
+    }
+
+    TEST_METHOD (TestConvertThreaded) {
+        TelexConfig config;
+        auto text = MakeText(5000);
+        auto expected = ConvertText(config, text, 1);
+        for (size_t chunkLength : {1, 7, 100, 4096}) {
+            for (unsigned int threads : {0, 2, 4, 16}) {
+                Assert::AreEqual(expected.c_str(), ConvertText(config, text, threads, chunkLength).c_str());
+            }
+        }
+    }
+
+    TEST_METHOD (TestConvertStream) {
+        TelexConfig config;
+        auto text = MakeText(100);
+        auto expected = ConvertText(config, text, 1);
+        for (size_t split = 0; split <= text.size(); split += 3) {
+            TextConverter converter(config);
+            std::wstring output;
+            converter.Push(std::wstring_view(text).substr(0, split), output);
+            converter.Push(std::wstring_view(text).substr(split), output);
+            converter.Flush(output);
+            Assert::AreEqual(expected.c_str(), output.c_str());
+        }
+
+        TextConverter converter(config);
+        std::wstring output;
+        for (auto c : text) {
+            converter.Push(std::wstring_view(&c, 1), output);
+        }
+        converter.Flush(output);
+        Assert::AreEqual(expected.c_str(), output.c_str());
+    }
+
+    TEST_METHOD (TestConvertStreamLongWord) {
+        TelexConfig config;
+        TextConverter converter(config);
+        std::wstring output;
+        converter.Push(L"ddaay ", output);
+        Assert::AreEqual(L"\x111\xe2y ", output.c_str());
+        // once the word is Invalid it is passed through as it comes instead of being held back
+        for (int i = 0; i < 1000; i++) {
+            converter.Push(L"x", output);
+        }
+        Assert::IsTrue(output.size() >= 4 + 1000 - (MaxLength + 1));
+        converter.Push(L" ddaay", output);
+        converter.Flush(output);
+        Assert::AreEqual((L"\x111\xe2y " + std::wstring(1000, L'x') + L" \x111\xe2y").c_str(), output.c_str());
+    }
+};
+
+} // namespace UnitTests
+} // namespace VietType
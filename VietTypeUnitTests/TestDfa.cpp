@@ -0,0 +1,229 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Telex.h"
+#include "WordListIterator.hpp"
+#include "FileUtil.hpp"
+#include "Util.h"
+#include "TelexEngine.h"
+#include "TelexDfa.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace VietType::Telex;
+using namespace VietType::TestLib;
+
+namespace VietType {
+namespace UnitTests {
+
+// TelexDfaEngine must be indistinguishable from TelexEngine, whether it runs on the table or falls back
+TEST_CLASS (TestDfa) {
+    std::vector<std::wstring> seeds;
+
+    static void CheckKeys(const TelexDfa& dfa, std::wstring_view keys) {
+        TelexEngine expected(dfa.config);
+        TelexDfaEngine actual(dfa);
+        std::wstring typed;
+        for (auto c : keys) {
+            expected.PushChar(c);
+            actual.PushChar(c);
+            typed.push_back(c);
+            AssertSameEngine(expected, actual, typed);
+        }
+
+        TelexEngine expectedCommit(expected);
+        TelexDfaEngine actualCommit(actual);
+        expectedCommit.Commit();
+        actualCommit.Commit();
+        AssertSameEngine(expectedCommit, actualCommit, typed + L'!');
+
+        expected.Backspace();
+        actual.Backspace();
+        AssertSameEngine(expected, actual, typed + L'<');
+    }
+
+    static std::vector<TelexConfig> TestConfigs() {
+        std::vector<TelexConfig> configs;
+        for (int level = 0; level <= 3; level++) {
+            TelexConfig config;
+            config.optimize_multilang = level;
+            config.autocorrect = level % 2 == 1;
+            config.oa_uy_tone1 = level != 2;
+            config.accept_separate_dd = level == 3;
+            configs.push_back(config);
+        }
+        return configs;
+    }
+
+public:
+    TestDfa() {
+        LONGLONG fsize;
+        std::unique_ptr<char16_t, decltype(FreeFile)*> words{
+            static_cast<char16_t*>(ReadWholeFile(L"..\\..\\data\\vw39kw.txt", &fsize)), FreeFile};
+        auto wend = words.get() + fsize / sizeof(char16_t);
+        TelexConfig config;
+        TelexEngine engine(config);
+        for (Utf16WordListIterator w(words.get(), wend); w != wend; w++) {
+            engine.Reset();
+            if (engine.Backconvert(w.wstr()) == TelexStates::Valid) {
+                seeds.push_back(engine.RetrieveRaw());
+            }
+        }
+    }
+
+    TEST_METHOD (TestDfaWordList) {
+        for (const auto& config : TestConfigs()) {
+            size_t unminimized;
+            auto dfa = TelexDfa::Build(config, seeds, &unminimized);
+            Assert::IsTrue(dfa.StateCount() <= unminimized);
+            for (const auto& seed : seeds) {
+                CheckKeys(dfa, seed);
+                auto upper = seed;
+                upper[0] = ToUpper(upper[0]);
+                upper.back() = ToUpper(upper.back());
+                CheckKeys(dfa, upper);
+
+                TelexDfaEngine e(dfa);
+                for (auto c : upper) {
+                    e.PushChar(c);
+                }
+                Assert::IsFalse(e.IsFallback(), upper.c_str());
+            }
+        }
+    }
+
+    TEST_METHOD (TestDfaAllPairs) {
+        std::vector<std::wstring> few{L"ddaays", L"nguwowif", L"quaanf", L"giowf", L"khoong"};
+        std::wstring_view alphabet = L"abcdefghijklmnopqrstuvwxyzAW1 ";
+        for (const auto& config : TestConfigs()) {
+            size_t unminimized;
+            auto dfa = TelexDfa::Build(config, few, &unminimized);
+            for (auto a : alphabet) {
+                for (auto b : alphabet) {
+                    CheckKeys(dfa, std::wstring{a, b});
+                    for (const auto& word : few) {
+                        CheckKeys(dfa, word + a + b);
+                    }
+                }
+            }
+            CheckKeys(dfa, L"ddddddddddddddddddddddddddddddddddddddddddddddddd");
+        }
+    }
+
+    TEST_METHOD (TestDfaSaveLoad) {
+        TelexConfig config;
+        size_t unminimized;
+        auto dfa = TelexDfa::Build(config, seeds, &unminimized);
+
+        std::unique_ptr<FILE, decltype(&fclose)> f{tmpfile(), fclose};
+        Assert::IsNotNull(f.get());
+        Assert::IsTrue(dfa.Save(f.get()));
+        rewind(f.get());
+        TelexDfa loaded;
+        Assert::IsTrue(loaded.Load(f.get()));
+        Assert::AreEqual(dfa.StateCount(), loaded.StateCount());
+        Assert::IsTrue(dfa.transitions == loaded.transitions);
+        Assert::IsTrue(dfa.strings == loaded.strings);
+        for (const auto& seed : seeds) {
+            CheckKeys(loaded, seed);
+        }
+
+        std::unique_ptr<FILE, decltype(&fclose)> bad{tmpfile(), fclose};
+        Assert::IsNotNull(bad.get());
+        fputs("not a table", bad.get());
+        rewind(bad.get());
+        Assert::IsFalse(loaded.Load(bad.get()));
+
+        // outputs longer than a word part, or cased from a bit past one, would overrun the buffers at Retrieve
+        auto saveLoad = [](const TelexDfa& table) {
+            std::unique_ptr<FILE, decltype(&fclose)> file{tmpfile(), fclose};
+            Assert::IsNotNull(file.get());
+            Assert::IsTrue(table.Save(file.get()));
+            rewind(file.get());
+            TelexDfa result;
+            return result.Load(file.get());
+        };
+        auto tooLong = dfa;
+        tooLong.strings.append(MaxWordPartLength + 1, L'a');
+        tooLong.states[0].commitOffset = 0;
+        tooLong.states[0].commitLength = static_cast<uint8_t>(MaxWordPartLength + 1);
+        Assert::IsFalse(saveLoad(tooLong));
+        auto badCase = dfa;
+        badCase.strings.push_back(L'a');
+        badCase.states[0].commitOffset = 0;
+        badCase.states[0].commitLength = 1;
+        badCase.states[0].commitCases[0] = static_cast<uint8_t>(MaxWordPartLength);
+        Assert::IsFalse(saveLoad(badCase));
+        Assert::IsTrue(saveLoad(dfa));
+    }
+
+    TEST_METHOD (TestDfaSetConfig) {
+        TelexConfig config;
+        size_t unminimized;
+        auto dfa = TelexDfa::Build(config, seeds, &unminimized);
+        auto other = config;
+        other.optimize_multilang = 3;
+        other.autocorrect = !config.autocorrect;
+
+        TelexEngine expected(config);
+        TelexDfaEngine actual(dfa);
+        for (auto c : std::wstring_view(L"dduwowngf")) {
+            expected.PushChar(c);
+            actual.PushChar(c);
+        }
+        expected.SetConfig(other);
+        actual.SetConfig(other);
+        AssertSameEngine(expected, actual, L"dduwowngf");
+
+        // the table does not match the config anymore, so the engine stays on the fallback
+        for (auto word : {L"wowf", L"casc", L"tesst"}) {
+            expected.Reset();
+            actual.Reset();
+            Assert::IsTrue(actual.IsFallback());
+            for (auto c : std::wstring_view(word)) {
+                expected.PushChar(c);
+                actual.PushChar(c);
+            }
+            expected.Commit();
+            actual.Commit();
+            AssertSameEngine(expected, actual, word);
+        }
+
+        actual.SetConfig(config);
+        actual.Reset();
+        Assert::IsFalse(actual.IsFallback());
+    }
+
+    TEST_METHOD (TestStateKeyWithoutOutputs) {
+        TelexConfig config;
+        auto type = [&](std::wstring_view keys) {
+            TelexEngine e(config);
+            for (auto c : keys) {
+                Assert::AreEqual(static_cast<int>(TelexStates::Valid), static_cast<int>(e.PushChar(c)));
+            }
+            return e;
+        };
+
+        // neither can become a syllable, and only the part lengths are left
+        auto a = type(L"tbh");
+        auto b = type(L"tbp");
+        Assert::IsTrue(TelexStateKey(a, false) == TelexStateKey(b, false));
+        Assert::IsFalse(TelexStateKey(a) == TelexStateKey(b));
+
+        // 'q' still changes what 'w' does even though the coda is dead
+        auto q = type(L"qoctb");
+        auto c = type(L"boctb");
+        Assert::IsFalse(TelexStateKey(q, false) == TelexStateKey(c, false));
+
+        // a word that can still commit keeps its parts
+        Assert::IsFalse(TelexStateKey(type(L"toan"), false) == TelexStateKey(type(L"toam"), false));
+    }
+};
+
+} // namespace UnitTests
+} // namespace VietType
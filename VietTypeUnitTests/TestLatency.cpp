@@ -0,0 +1,104 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <memory>
+#include <string_view>
+#include "Telex.h"
+#include "TelexLatency.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace VietType::Telex;
+
+namespace VietType {
+namespace UnitTests {
+
+TEST_CLASS (TestLatency) {
+    static const LatencySummary* Find(
+        const std::vector<LatencySummary>& summaries, LatencyOp op, TelexStates from, TelexStates to) {
+        for (const auto& s : summaries) {
+            if (s.op == op && s.from == from && s.to == to) {
+                return &s;
+            }
+        }
+        return nullptr;
+    }
+
+public:
+    TEST_METHOD (TestLatencyBuckets) {
+        for (size_t b = 0; b + 1 < LatencyHistogram::BucketCount; b++) {
+            auto limit = LatencyHistogram::BucketLimit(b);
+            Assert::AreEqual(b, LatencyHistogram::BucketOf(limit));
+            Assert::AreEqual(b + 1, LatencyHistogram::BucketOf(limit + 1));
+        }
+        for (uint64_t ns = 1; ns < (uint64_t(1) << 32); ns = ns * 3 + 1) {
+            auto limit = LatencyHistogram::BucketLimit(LatencyHistogram::BucketOf(ns));
+            Assert::IsTrue(limit >= ns);
+            Assert::IsTrue(limit - ns <= ns / LatencyHistogram::SubCount);
+        }
+        Assert::AreEqual(LatencyHistogram::BucketCount - 1, LatencyHistogram::BucketOf(~uint64_t(0)));
+    }
+
+    TEST_METHOD (TestLatencyPercentiles) {
+        // too big for the stack
+        auto recorder = std::make_unique<LatencyRecorder>();
+        for (uint64_t ns = 1; ns <= 10000; ns++) {
+            recorder->Record(LatencyOp::PushChar, TelexStates::Valid, TelexStates::Valid, ns);
+        }
+        recorder->Record(LatencyOp::PushChar, TelexStates::Valid, TelexStates::Invalid, 1000000);
+
+        auto snapshot = recorder->Snapshot();
+        Assert::AreEqual(size_t(1), snapshot.operations.size());
+        Assert::AreEqual(size_t(2), snapshot.transitions.size());
+        auto valid = Find(snapshot.transitions, LatencyOp::PushChar, TelexStates::Valid, TelexStates::Valid);
+        Assert::IsNotNull(valid);
+        Assert::AreEqual(uint64_t(10000), valid->count);
+        Assert::AreEqual(uint64_t(10000), valid->max);
+        Assert::IsTrue(valid->p50 >= 5000 && valid->p50 <= 5000 + 5000 / LatencyHistogram::SubCount);
+        Assert::IsTrue(valid->p99 >= 9900 && valid->p99 <= 10000);
+        Assert::IsTrue(valid->p999 >= 9990 && valid->p999 <= 10000);
+
+        auto all = Find(snapshot.operations, LatencyOp::PushChar, TelexStates::TxError, TelexStates::TxError);
+        Assert::IsNotNull(all);
+        Assert::AreEqual(uint64_t(10001), all->count);
+        Assert::AreEqual(uint64_t(1000000), all->max);
+
+        recorder->Clear();
+        snapshot = recorder->Snapshot();
+        Assert::IsTrue(snapshot.operations.empty());
+        Assert::IsTrue(snapshot.transitions.empty());
+    }
+
+    TEST_METHOD (TestLatencyEngine) {
+        auto recorder = std::make_unique<LatencyRecorder>();
+        TelexConfig config;
+        TelexLatencyEngine e(std::unique_ptr<ITelexEngine>(TelexNewDynamic(config)), *recorder);
+        for (auto c : std::wstring_view(L"vieetj")) {
+            Assert::AreEqual(static_cast<int>(TelexStates::Valid), static_cast<int>(e.PushChar(c)));
+            e.Peek();
+        }
+        e.Commit();
+        Assert::AreEqual(L"vi\x1ec7t", e.Retrieve().c_str());
+        e.Reset();
+        e.PushChar(L'x');
+        e.PushChar(L'1');
+        e.Cancel();
+
+        auto snapshot = recorder->Snapshot();
+        auto push = Find(snapshot.transitions, LatencyOp::PushChar, TelexStates::Valid, TelexStates::Valid);
+        Assert::IsNotNull(push);
+        Assert::AreEqual(uint64_t(7), push->count);
+        auto invalid = Find(snapshot.transitions, LatencyOp::PushChar, TelexStates::Valid, TelexStates::Invalid);
+        Assert::IsNotNull(invalid);
+        Assert::IsNotNull(Find(snapshot.transitions, LatencyOp::Commit, TelexStates::Valid, TelexStates::Committed));
+        Assert::IsNotNull(
+            Find(snapshot.transitions, LatencyOp::Cancel, TelexStates::Invalid, TelexStates::CommittedInvalid));
+        Assert::IsNotNull(Find(snapshot.transitions, LatencyOp::Reset, TelexStates::Committed, TelexStates::Valid));
+        auto peek = Find(snapshot.operations, LatencyOp::Peek, TelexStates::TxError, TelexStates::TxError);
+        Assert::IsNotNull(peek);
+        Assert::AreEqual(uint64_t(6), peek->count);
+    }
+};
+
+} // namespace UnitTests
+} // namespace VietType
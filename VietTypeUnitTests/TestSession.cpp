@@ -0,0 +1,181 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "Telex.h"
+#include "Util.h"
+#include "TelexEngine.h"
+#include "TelexSession.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace VietType::Telex;
+
+namespace VietType {
+namespace UnitTests {
+
+TEST_CLASS (TestSession) {
+    static void Type(ITelexEngine& e, std::wstring_view keys) {
+        for (auto c : keys) {
+            e.PushChar(c);
+        }
+    }
+
+    // one engine switching between contexts through the pool must type every context the same as an engine of
+    // its own, except that an evicted context starts over
+    static void CheckSwitching(const TelexConfig& config, size_t contexts, size_t capacity, uint64_t seed) {
+        static constexpr std::wstring_view words[] = {
+            L"nghieengs", L"vieetj", L"dduowngf", L"thuowr", L"hoaf", L"quoocs", L"giuwax", L"Tooi", L"xin",
+            L"chaof", L"DDaays", L"khuyr", L"english", L"windows", L"tieengs", L"Vieejt", L"nuwowcs", L"ddd",
+        };
+        std::mt19937_64 rng(seed);
+        std::vector<std::unique_ptr<ITelexEngine>> own;
+        // the word each context is typing and how far along it is
+        std::vector<std::pair<std::wstring_view, size_t>> typing(contexts);
+        for (size_t i = 0; i < contexts; i++) {
+            own.emplace_back(TelexNew(config));
+        }
+        std::unique_ptr<ITelexEngine> shared(TelexNew(config));
+        TelexSessionPool pool(capacity);
+        size_t current = 0;
+
+        for (int step = 0; step < 20000; step++) {
+            if (rng() % 3 == 0) {
+                auto next = static_cast<size_t>(rng() % contexts);
+                if (next != current) {
+                    pool.Save(current, *shared);
+                    shared->Reset();
+                    if (!pool.Restore(next, *shared)) {
+                        own[next]->Reset();
+                        typing[next] = {};
+                    }
+                    current = next;
+                }
+            }
+            auto& expected = *own[current];
+            auto& [word, typed] = typing[current];
+            auto msg = std::wstring(word.substr(0, typed));
+            if (typed == word.size()) {
+                expected.Commit();
+                shared->Commit();
+                AssertSameEngine(expected, *shared, msg + L'!');
+                expected.Reset();
+                shared->Reset();
+                word = words[rng() % std::size(words)];
+                typed = 0;
+            } else if (typed && rng() % 8 == 0 && expected.GetState() == TelexStates::Valid) {
+                expected.Backspace();
+                shared->Backspace();
+                typed--;
+                msg.push_back(L'<');
+            } else {
+                expected.PushChar(word[typed]);
+                shared->PushChar(word[typed]);
+                msg.push_back(word[typed]);
+                typed++;
+            }
+            AssertSameEngine(expected, *shared, msg);
+        }
+        Assert::IsTrue(pool.Count() <= capacity);
+        Assert::IsTrue(pool.GetStats().hits > 0);
+    }
+
+public:
+    TEST_METHOD (TestSessionRestore) {
+        TelexConfig config;
+        std::unique_ptr<ITelexEngine> e(TelexNew(config));
+        std::unique_ptr<ITelexEngine> expected(TelexNew(config));
+        TelexSessionPool pool(4);
+
+        Type(*e, L"nghieen");
+        Type(*expected, L"nghieen");
+        Assert::IsTrue(pool.Save(1, *e));
+        e->Reset();
+        Type(*e, L"abc");
+        Assert::IsTrue(pool.Save(2, *e));
+        e->Reset();
+        Assert::AreEqual(size_t(2), pool.Count());
+
+        Assert::IsTrue(pool.Restore(1, *e));
+        AssertSameEngine(*expected, *e, L"restore");
+        Assert::IsFalse(pool.Restore(1, *e));
+        Assert::AreEqual(size_t(1), pool.Count());
+
+        // typing and backspacing carry on from the restored word
+        Type(*e, L"gs");
+        Type(*expected, L"gs");
+        AssertSameEngine(*expected, *e, L"nghieengs");
+        e->Backspace();
+        expected->Backspace();
+        AssertSameEngine(*expected, *e, L"nghieengs<");
+        e->Commit();
+        expected->Commit();
+        AssertSameEngine(*expected, *e, L"nghieengs<!");
+    }
+
+    TEST_METHOD (TestSessionEviction) {
+        TelexConfig config;
+        std::unique_ptr<ITelexEngine> e(TelexNew(config));
+        TelexSessionPool pool(2);
+        for (uint64_t context : {10, 20, 30}) {
+            e->Reset();
+            Type(*e, L"vieet");
+            Assert::IsTrue(pool.Save(context, *e));
+        }
+        Assert::AreEqual(size_t(2), pool.Count());
+        Assert::AreEqual(uint64_t(1), pool.GetStats().evictions);
+        Assert::IsFalse(pool.Restore(10, *e));
+        // saving again makes a context the most recent
+        Assert::IsTrue(pool.Save(20, *e));
+        Assert::IsTrue(pool.Save(40, *e));
+        Assert::IsFalse(pool.Restore(30, *e));
+        Assert::IsTrue(pool.Restore(20, *e));
+        Assert::IsTrue(pool.Restore(40, *e));
+        Assert::AreEqual(size_t(0), pool.Count());
+    }
+
+    TEST_METHOD (TestSessionNotKept) {
+        TelexConfig config;
+        std::unique_ptr<ITelexEngine> e(TelexNew(config));
+        TelexSessionPool pool(2);
+        Type(*e, L"vieet");
+        Assert::IsTrue(pool.Save(1, *e));
+
+        // an empty word, a finished word and a word too long for a snapshot all forget the context
+        e->Reset();
+        Assert::IsFalse(pool.Save(1, *e));
+        Assert::AreEqual(size_t(0), pool.Count());
+        Type(*e, L"vieet");
+        e->Commit();
+        Assert::IsFalse(pool.Save(1, *e));
+        e->Reset();
+        Type(*e, std::wstring(TelexSnapshot::MaxKeys + 1, L'x'));
+        Assert::IsFalse(pool.Save(1, *e));
+        Assert::AreEqual(uint64_t(1), pool.GetStats().unsaved);
+        Assert::AreEqual(size_t(0), pool.Count());
+
+        pool.Save(2, *e);
+        pool.Clear();
+        Assert::AreEqual(size_t(0), pool.Count());
+    }
+
+    TEST_METHOD (TestSessionSwitching) {
+        for (int level : {0, 1, 3}) {
+            TelexConfig config;
+            config.optimize_multilang = level;
+            CheckSwitching(config, 5, 8, level);
+            CheckSwitching(config, 12, 4, level + 100);
+        }
+        TelexConfig config;
+        config.autocorrect = true;
+        CheckSwitching(config, 7, 3, 7);
+    }
+};
+
+} // namespace UnitTests
+} // namespace VietType
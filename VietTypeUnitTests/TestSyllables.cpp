@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <string>
+#include "TelexEngine.h"
+#include "TelexSyllables.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace VietType::Telex;
+
+namespace VietType {
+namespace UnitTests {
+
+TEST_CLASS (TestSyllables) {
+    static wchar_t Toned(const SyllableInfo* info, Tones t) {
+        return info->toned[static_cast<int>(t)];
+    }
+
+public:
+    TEST_METHOD (TestSyllableTableConsistent) {
+        const auto& table = SyllableTable::Get();
+        std::wstring issues;
+        for (const auto& issue : table.Issues()) {
+            issues.append(issue).push_back(L'\n');
+        }
+        Assert::AreEqual(L"", issues.c_str());
+        Assert::IsTrue(table.Count() > 0);
+    }
+
+    TEST_METHOD (TestSyllableTableFind) {
+        const auto& table = SyllableTable::Get();
+
+        auto nghieng = table.Find(L"ngh", L"i\xea", L"ng", true);
+        Assert::IsNotNull(nghieng);
+        Assert::AreEqual(1, static_cast<int>(nghieng->tonepos));
+        Assert::AreEqual(L'\x1ebf', Toned(nghieng, Tones::S));
+        Assert::AreEqual(L'\xea', Toned(nghieng, Tones::Z));
+
+        // c2 that only takes s/j
+        auto cac = table.Find(L"c", L"a", L"c", true);
+        Assert::IsNotNull(cac);
+        Assert::AreEqual(L'\xe1', Toned(cac, Tones::S));
+        Assert::AreEqual(L'\x1ea1', Toned(cac, Tones::J));
+        Assert::AreEqual(L'\0', Toned(cac, Tones::F));
+        Assert::AreEqual(L'\0', Toned(cac, Tones::Z));
+
+        Assert::AreEqual(1, static_cast<int>(table.Find(L"h", L"oa", L"", true)->tonepos));
+        Assert::AreEqual(0, static_cast<int>(table.Find(L"h", L"oa", L"", false)->tonepos));
+        Assert::AreEqual(1, static_cast<int>(table.Find(L"h", L"oa", L"n", false)->tonepos));
+
+        auto gi = table.Find(L"gi", L"", L"", true);
+        Assert::IsNotNull(gi);
+        Assert::IsTrue(gi->moveGi);
+        Assert::AreEqual(L'\xec', Toned(gi, Tones::F));
+
+        // v that needs c2, or cannot have one
+        Assert::IsNull(table.Find(L"t", L"\x103", L"", true));
+        Assert::IsNull(table.Find(L"t", L"ai", L"n", true));
+        Assert::IsNull(table.Find(L"tr", L"wu", L"", true));
+        Assert::IsNull(table.Find(L"f", L"a", L"", true));
+        Assert::IsNull(table.Find(L"ngh", L"i\xea", L"ngh", true));
+    }
+};
+
+} // namespace UnitTests
+} // namespace VietType
@@ -2,8 +2,10 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "stdafx.h"
+#include <array>
 #include <functional>
 #include "Util.h"
+#include "TelexEngine.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace VietType::Telex;
@@ -211,6 +213,14 @@ public:
         });
     }
 
+    TEST_METHOD (TestForceCommitGif) {
+        MultiConfigTester(config).Invoke([](auto& e) {
+            FeedWord(e, L"gif");
+            AssertTelexStatesEqual(TelexStates::Committed, e.ForceCommit());
+            Assert::AreEqual(L"g\xec", e.Retrieve().c_str());
+        });
+    }
+
     TEST_METHOD (TestEmptyCancel) {
         MultiConfigTester(config).Invoke([](auto& e) {
             e.Reset();
@@ -775,6 +785,15 @@ public:
         });
     }
 
+    TEST_METHOD (TestBackconversionDdoonf1) {
+        MultiConfigTester(config).Invoke([](auto& e) {
+            AssertTelexStatesEqual(TelexStates::BackconvertFailed, e.Backconvert(L"\x111\x1ed3n1"));
+            Assert::AreEqual(L"\x111\x1ed3n1", e.Peek().c_str());
+            AssertTelexStatesEqual(TelexStates::Valid, e.Backspace());
+            Assert::AreEqual(L"\x111\x1ed3n", e.Peek().c_str());
+        });
+    }
+
     TEST_METHOD (TestBackconversionXooong) {
         MultiConfigTester(config).Invoke([](auto& e) {
             AssertTelexStatesEqual(TelexStates::Valid, e.Backconvert(L"xoong"));
@@ -925,6 +944,143 @@ public:
         VietType::UnitTests::TestInvalidWord(*e, L"DENSE", L"DENSE");
     }
 
+    // test config specialization
+
+    TEST_METHOD (TestCommitCacheSetConfig) {
+        auto cacheConfig = config;
+        cacheConfig.commit_cache_size = 16;
+        TelexEngine e(cacheConfig);
+        // a word is only kept once it has missed twice
+        VietType::UnitTests::TestValidWord(e, L"ho\xe0", L"hoaf");
+        VietType::UnitTests::TestValidWord(e, L"ho\xe0", L"hoaf");
+        Assert::AreEqual(uint64_t{0}, e.GetCommitCacheStats().hits);
+        VietType::UnitTests::TestValidWord(e, L"ho\xe0", L"hoaf");
+        Assert::AreEqual(uint64_t{1}, e.GetCommitCacheStats().hits);
+
+        cacheConfig.oa_uy_tone1 = false;
+        e.SetConfig(cacheConfig);
+        VietType::UnitTests::TestValidWord(e, L"h\xf2" L"a", L"hoaf");
+        Assert::AreEqual(uint64_t{1}, e.GetCommitCacheStats().hits);
+
+        // backconverted words and words typed before SetConfig are not cached
+        e.Reset();
+        e.Backconvert(L"h\xf2" L"a");
+        AssertTelexStatesEqual(TelexStates::Committed, e.Commit());
+        FeedWord(e, L"hoaf");
+        e.SetConfig(cacheConfig);
+        AssertTelexStatesEqual(TelexStates::Committed, e.Commit());
+        Assert::AreEqual(uint64_t{3}, e.GetCommitCacheStats().misses);
+    }
+
+    TEST_METHOD (TestCommitCacheKeepsRepeatedWords) {
+        auto cacheConfig = config;
+        // a single set
+        cacheConfig.commit_cache_size = 4;
+        TelexEngine e(cacheConfig);
+        for (int i = 0; i < 2; i++) {
+            VietType::UnitTests::TestValidWord(e, L"Ho\xe0", L"Hoaf");
+        }
+        // words typed once never get in
+        for (auto word : {L"ddi", L"ddeen", L"nuwowcs", L"tooi", L"mootj", L"vieetj", L"nawm", L"boosn"}) {
+            FeedWord(e, word);
+            AssertTelexStatesEqual(TelexStates::Committed, e.Commit());
+        }
+        Assert::AreEqual(uint64_t{0}, e.GetCommitCacheStats().evictions);
+        VietType::UnitTests::TestValidWord(e, L"Ho\xe0", L"Hoaf");
+        Assert::AreEqual(uint64_t{1}, e.GetCommitCacheStats().hits);
+        Assert::AreEqual(uint64_t{10}, e.GetCommitCacheStats().misses);
+    }
+
+    TEST_METHOD (TestCommitCacheBackconvertFailed) {
+        auto cacheConfig = config;
+        cacheConfig.commit_cache_size = 16;
+        TelexEngine e(cacheConfig);
+        VietType::UnitTests::TestValidWord(e, L"ho\xe0", L"hoaf");
+        VietType::UnitTests::TestValidWord(e, L"ho\xe0", L"hoaf");
+        e.Reset();
+        e.Backconvert(L"h\xf2" L"1");
+        AssertTelexStatesEqual(TelexStates::BackconvertFailed, e.GetState());
+        // backspacing into a word that converts keeps the cache and its stats
+        AssertTelexStatesEqual(TelexStates::Valid, e.Backspace());
+        Assert::AreEqual(uint64_t{2}, e.GetCommitCacheStats().misses);
+        e.Reset();
+        VietType::UnitTests::TestValidWord(e, L"ho\xe0", L"hoaf");
+        Assert::AreEqual(uint64_t{1}, e.GetCommitCacheStats().hits);
+    }
+
+    TEST_METHOD (TestFixedConfigSetConfig) {
+        std::unique_ptr<ITelexEngine> e(TelexNew(config));
+        auto config1 = config;
+        config1.backspaced_word_stays_invalid = !config.backspaced_word_stays_invalid;
+        Assert::IsTrue(e->SetConfig(config1));
+        Assert::AreEqual(config1.backspaced_word_stays_invalid, e->GetConfig().backspaced_word_stays_invalid);
+        // options checked while typing are fixed, the engine keeps its config
+        config1.autocorrect = !config.autocorrect;
+        Assert::IsFalse(e->SetConfig(config1));
+        Assert::AreEqual(config.autocorrect, e->GetConfig().autocorrect);
+        Assert::AreEqual(config1.backspaced_word_stays_invalid, e->GetConfig().backspaced_word_stays_invalid);
+
+        std::unique_ptr<ITelexEngine> d(TelexNewDynamic(config));
+        Assert::IsTrue(d->SetConfig(config1));
+        Assert::AreEqual(config1.autocorrect, d->GetConfig().autocorrect);
+    }
+
+    TEST_METHOD (TestNewFromKeepsWord) {
+        auto config1 = config;
+        config1.autocorrect = !config.autocorrect;
+        // the word carries over as it does across SetConfig on the dynamic engine
+        for (auto word : {L"dduwowngf", L"hoaf", L"nghieengx", L"xyz"}) {
+            std::unique_ptr<ITelexEngine> e(TelexNew(config));
+            TelexEngine d(config);
+            FeedWord(*e, word);
+            FeedWord(d, word);
+            std::unique_ptr<ITelexEngine> n(TelexNewFrom(*e, config1));
+            Assert::IsTrue(d.SetConfig(config1));
+            Assert::AreEqual(config1.autocorrect, n->GetConfig().autocorrect);
+            Assert::AreEqual(d.Peek().c_str(), n->Peek().c_str());
+            AssertTelexStatesEqual(d.Backspace(), n->Backspace());
+            Assert::AreEqual(d.Peek().c_str(), n->Peek().c_str());
+            AssertTelexStatesEqual(d.Commit(), n->Commit());
+            Assert::AreEqual(d.Retrieve().c_str(), n->Retrieve().c_str());
+        }
+
+        // too long for a snapshot, the keys are typed again
+        auto longWord = L"httpsexamplecomsomeplacethatisalongpath";
+        std::unique_ptr<ITelexEngine> e(TelexNew(config));
+        FeedWord(*e, longWord);
+        TelexSnapshot snapshot;
+        Assert::IsFalse(e->SaveSnapshot(snapshot));
+        std::unique_ptr<ITelexEngine> n(TelexNewFrom(*e, config1));
+        AssertTelexStatesEqual(e->GetState(), n->GetState());
+        Assert::AreEqual(e->Count(), n->Count());
+        Assert::AreEqual(longWord, n->RetrieveRaw().c_str());
+        e->Commit();
+        n.reset(TelexNewFrom(*e, config1));
+        AssertTelexStatesEqual(TelexStates::CommittedInvalid, n->GetState());
+        Assert::AreEqual(longWord, n->Retrieve().c_str());
+    }
+
+    TEST_METHOD (TestFixedConfigMultilangAbove3) {
+        auto config1 = config;
+        config1.optimize_multilang = 4;
+        std::unique_ptr<ITelexEngine> e(TelexNew(config1));
+        std::unique_ptr<ITelexEngine> d(TelexNewDynamic(config1));
+        Assert::AreEqual(4ul, e->GetConfig().optimize_multilang);
+        // levels above 3 type as 3 does
+        for (auto word : {L"defe", L"dense", L"virus", L"hoaf", L"tuaans"}) {
+            AssertTelexStatesEqual(FeedWord(*d, word), FeedWord(*e, word));
+            Assert::AreEqual(d->Peek().c_str(), e->Peek().c_str());
+            AssertTelexStatesEqual(d->Commit(), e->Commit());
+            Assert::AreEqual(d->Retrieve().c_str(), e->Retrieve().c_str());
+        }
+        AssertTelexStatesEqual(TelexStates::Invalid, FeedWord(*e, L"defe"));
+
+        config1.optimize_multilang = 3;
+        Assert::IsTrue(e->SetConfig(config1));
+        config1.optimize_multilang = 2;
+        Assert::IsFalse(e->SetConfig(config1));
+    }
+
     // test doublekey backspace
 
     TEST_METHOD (TestBackspaceMooo) {
@@ -943,6 +1099,80 @@ public:
         });
     }
 
+    // test buffer limits
+
+    TEST_METHOD (TestLongInvalidWord) {
+        MultiConfigTester(config).Invoke([](auto& e) {
+            e.Reset();
+            for (int i = 0; i < 300; i++) {
+                e.PushChar(L'x');
+            }
+            AssertTelexStatesEqual(TelexStates::Invalid, e.GetState());
+            Assert::AreEqual(std::size_t{251}, e.Count());
+            Assert::AreEqual(std::wstring(251, L'x').c_str(), e.RetrieveRaw().c_str());
+            AssertTelexStatesEqual(TelexStates::Invalid, e.Backspace());
+            Assert::AreEqual(std::wstring(250, L'x').c_str(), e.Peek().c_str());
+        });
+    }
+
+    // test span output
+
+    TEST_METHOD (TestSpanOutputValid) {
+        MultiConfigTester(config).Invoke([](auto& e) {
+            std::array<wchar_t, MaxOutputLength> buf;
+            FeedWord(e, L"dduwowngf");
+            auto length = e.Peek(buf);
+            Assert::AreEqual(e.Peek().c_str(), std::wstring(buf.data(), length).c_str());
+            length = e.RetrieveRaw(buf);
+            Assert::AreEqual(L"dduwowngf", std::wstring(buf.data(), length).c_str());
+            AssertTelexStatesEqual(TelexStates::Committed, e.Commit());
+            length = e.Retrieve(buf);
+            Assert::AreEqual(L"\x111\x1b0\x1eddng", std::wstring(buf.data(), length).c_str());
+        });
+    }
+
+    TEST_METHOD (TestSpanOutputTruncated) {
+        MultiConfigTester(config).Invoke([](auto& e) {
+            std::array<wchar_t, 4> buf{L'#', L'#', L'#', L'#'};
+            FeedWord(e, L"nghieengx");
+            Assert::AreEqual(std::size_t{7}, e.Peek(std::span(buf).first(3)));
+            Assert::AreEqual(L"ngh#", std::wstring(buf.data(), buf.size()).c_str());
+            Assert::AreEqual(std::size_t{7}, e.Peek(std::span<wchar_t>()));
+        });
+    }
+
+    TEST_METHOD (TestSpanOutputTruncatedEveryLength) {
+        MultiConfigTester(config).Invoke([](auto& e) {
+            // the shorter spans end before the tone and before some of the case bits
+            auto check = [](std::wstring_view full, auto output) {
+                for (size_t n = 0; n <= full.size(); n++) {
+                    std::array<wchar_t, MaxOutputLength> buf;
+                    buf.fill(L'#');
+                    Assert::AreEqual(full.size(), output(std::span(buf).first(n)));
+                    auto expected = std::wstring(full.substr(0, n)) + L'#';
+                    Assert::AreEqual(expected.c_str(), std::wstring(buf.data(), n + 1).c_str());
+                }
+            };
+            FeedWord(e, L"NGHIEENGX");
+            check(L"NGHI\x1ec4NG", [&](std::span<wchar_t> s) { return e.Peek(s); });
+            AssertTelexStatesEqual(TelexStates::Committed, e.Commit());
+            check(L"NGHI\x1ec4NG", [&](std::span<wchar_t> s) { return e.Retrieve(s); });
+        });
+    }
+
+    TEST_METHOD (TestSpanOutputLongInvalidWord) {
+        MultiConfigTester(config).Invoke([](auto& e) {
+            std::array<wchar_t, MaxOutputLength> buf;
+            e.Reset();
+            for (int i = 0; i < 300; i++) {
+                e.PushChar(L'x');
+            }
+            Assert::AreEqual(std::size_t{251}, e.RetrieveRaw(buf));
+            Assert::AreEqual(std::size_t{251}, e.Peek(buf));
+            Assert::AreEqual(std::wstring(251, L'x').c_str(), std::wstring(buf.data(), 251).c_str());
+        });
+    }
+
     TEST_METHOD (TestAutocorrectHwuogn) {
         auto config1 = config;
         config1.autocorrect = true;
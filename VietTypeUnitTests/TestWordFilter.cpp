@@ -0,0 +1,138 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Telex.h"
+#include "Util.h"
+#include "TelexEngine.h"
+#include "TelexDfa.h"
+#include "TelexWordFilter.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace VietType::Telex;
+
+namespace VietType {
+namespace UnitTests {
+
+TEST_CLASS (TestWordFilter) {
+    static WordFilter MakeFilter() {
+        std::vector<std::wstring_view> words{
+            L"cos", L"Sums", L"mix", L"abcdefghijkl", L"abcdefghijklm", L"caf\xe9", L"don't", L"", L"cos"};
+        return WordFilter::Build(words);
+    }
+
+public:
+    TEST_METHOD (TestWordFilterContains) {
+        auto filter = MakeFilter();
+        Assert::AreEqual(size_t{4}, filter.Count());
+        Assert::IsTrue(filter.Contains(L"cos"));
+        Assert::IsTrue(filter.Contains(L"COS"));
+        Assert::IsTrue(filter.Contains(L"sums"));
+        Assert::IsTrue(filter.Contains(L"abcdefghijkl"));
+        Assert::IsFalse(filter.Contains(L"abcdefghijklm"));
+        Assert::IsFalse(filter.Contains(L"caf\xe9"));
+        Assert::IsFalse(filter.Contains(L"co"));
+        Assert::IsFalse(filter.Contains(L"coss"));
+        Assert::IsFalse(filter.Contains(L""));
+        Assert::IsFalse(WordFilter().Contains(L"cos"));
+    }
+
+    TEST_METHOD (TestWordFilterMany) {
+        // every 3-letter word with an even sum of letters
+        std::vector<std::wstring> words;
+        for (wchar_t a = L'a'; a <= L'z'; a++) {
+            for (wchar_t b = L'a'; b <= L'z'; b++) {
+                for (wchar_t c = L'a'; c <= L'z'; c++) {
+                    words.push_back(std::wstring{a, b, c});
+                }
+            }
+        }
+        std::vector<std::wstring_view> even;
+        for (const auto& w : words) {
+            if ((w[0] + w[1] + w[2]) % 2 == 0) {
+                even.push_back(w);
+            }
+        }
+        auto filter = WordFilter::Build(even);
+        Assert::AreEqual(even.size(), filter.Count());
+        for (const auto& w : words) {
+            Assert::AreEqual((w[0] + w[1] + w[2]) % 2 == 0, filter.Contains(w), w.c_str());
+        }
+    }
+
+    TEST_METHOD (TestWordFilterSaveLoad) {
+        auto filter = MakeFilter();
+        std::unique_ptr<FILE, decltype(&fclose)> f{tmpfile(), fclose};
+        Assert::IsNotNull(f.get());
+        Assert::IsTrue(filter.Save(f.get()));
+        rewind(f.get());
+        WordFilter loaded;
+        Assert::IsTrue(loaded.Load(f.get()));
+        Assert::AreEqual(filter.Count(), loaded.Count());
+        for (auto w : {L"cos", L"sums", L"mix", L"abcdefghijkl"}) {
+            Assert::IsTrue(loaded.Contains(w));
+        }
+        Assert::IsFalse(loaded.Contains(L"ban"));
+
+        std::unique_ptr<FILE, decltype(&fclose)> bad{tmpfile(), fclose};
+        Assert::IsNotNull(bad.get());
+        fputs("not a filter", bad.get());
+        rewind(bad.get());
+        Assert::IsFalse(loaded.Load(bad.get()));
+
+        // a key count far beyond what the file holds fails on the missing keys
+        std::unique_ptr<FILE, decltype(&fclose)> truncated{tmpfile(), fclose};
+        Assert::IsNotNull(truncated.get());
+        rewind(f.get());
+        uint32_t magic;
+        Assert::AreEqual(size_t{1}, fread(&magic, sizeof(magic), 1, f.get()));
+        uint64_t header[] = {1ull << 32, 1, 2, 3};
+        fwrite(&magic, sizeof(magic), 1, truncated.get());
+        fwrite(header, sizeof(header[0]), std::size(header), truncated.get());
+        rewind(truncated.get());
+        Assert::IsFalse(loaded.Load(truncated.get()));
+    }
+
+    TEST_METHOD (TestWordFilterCommit) {
+        auto filter = MakeFilter();
+        TelexConfig config;
+        config.english_filter = &filter;
+        auto e = std::unique_ptr<ITelexEngine>(TelexNew(config));
+        TestInvalidWord(*e, L"cos", L"cos");
+        TestInvalidWord(*e, L"Sums", L"Sums");
+        TestValidWord(*e, L"c\xf2", L"cof");
+        TestValidWord(*e, L"b\xe1n", L"bans");
+
+        config.optimize_multilang = 0;
+        e = std::unique_ptr<ITelexEngine>(TelexNew(config));
+        TestValidWord(*e, L"c\xf3", L"cos");
+    }
+
+    TEST_METHOD (TestWordFilterDfa) {
+        auto filter = MakeFilter();
+        TelexConfig config;
+        config.english_filter = &filter;
+        std::vector<std::wstring> seeds{L"cos", L"sums", L"bans"};
+        size_t unminimized;
+        auto dfa = TelexDfa::Build(config, seeds, &unminimized);
+        TelexDfaEngine e(dfa);
+        TestInvalidWord(e, L"cos", L"cos");
+        TestInvalidWord(e, L"SUMS", L"SUMS");
+        TestValidWord(e, L"b\xe1n", L"bans");
+        Assert::IsFalse(e.IsFallback());
+
+        config.english_filter = nullptr;
+        e.SetConfig(config);
+        e.Reset();
+        TestValidWord(e, L"c\xf3", L"cos");
+    }
+};
+
+} // namespace UnitTests
+} // namespace VietType
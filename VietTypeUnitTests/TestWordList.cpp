@@ -5,6 +5,7 @@
 #include <cstdlib>
 #include <cstdio>
 #include <memory>
+#include <vector>
 #include "Telex.h"
 #include "WordListIterator.hpp"
 #include "FileUtil.hpp"
@@ -19,12 +20,12 @@ namespace VietType {
 namespace UnitTests {
 
 TEST_CLASS (TestWordList) {
-    std::unique_ptr<wchar_t, decltype(FreeFile)*> words{nullptr, FreeFile};
+    std::unique_ptr<char16_t, decltype(FreeFile)*> words{nullptr, FreeFile};
     LONGLONG fsize = 0;
 
 public:
     TestWordList() {
-        words = {static_cast<wchar_t*>(ReadWholeFile(L"..\\..\\data\\vw39kw.txt", &fsize)), FreeFile};
+        words = {static_cast<char16_t*>(ReadWholeFile(L"..\\..\\data\\vw39kw.txt", &fsize)), FreeFile};
     }
 
     TEST_METHOD (TestBackconvertWordList) {
@@ -36,11 +37,11 @@ public:
         config1.oa_uy_tone1 = true;
         TelexEngine engine2(config2);
 
-        auto wend = words.get() + fsize / sizeof(wchar_t);
-        for (WordListIterator w(words.get(), wend); w != wend; w++) {
+        auto wend = words.get() + fsize / sizeof(char16_t);
+        for (Utf16WordListIterator w(words.get(), wend); w != wend; w++) {
             if (!w.wlen())
                 continue;
-            std::wstring word(*w, w.wlen());
+            std::wstring word(w.wstr());
 
             engine1.Reset();
             engine2.Reset();
@@ -76,6 +77,46 @@ public:
             Assert::IsTrue(word == c1 || word == c2);
         }
     }
+
+    TEST_METHOD (TestCommitCacheWordList) {
+        TelexConfig config;
+        TelexEngine plain(config);
+        // small enough that the word list keeps evicting
+        config.commit_cache_size = 64;
+        TelexEngine cached(config);
+
+        std::vector<std::wstring> keys;
+        auto wend = words.get() + fsize / sizeof(char16_t);
+        for (Utf16WordListIterator w(words.get(), wend); w != wend; w++) {
+            plain.Reset();
+            if (plain.Backconvert(w.wstr()) == TelexStates::Valid) {
+                auto raw = plain.RetrieveRaw();
+                keys.push_back(raw);
+                raw[0] = ToUpper(raw[0]);
+                keys.push_back(raw);
+            }
+        }
+
+        for (int pass = 0; pass < 2; pass++) {
+            for (size_t i = 0; i < keys.size(); i++) {
+                // repeat recent words the way typing does
+                for (const auto& k : {keys[i], keys[i / 2], keys[i]}) {
+                    FeedWord(plain, k.c_str());
+                    FeedWord(cached, k.c_str());
+                    AssertTelexStatesEqual(plain.Commit(), cached.Commit());
+                    Assert::AreEqual(plain.Retrieve().c_str(), cached.Retrieve().c_str(), k.c_str());
+                    Assert::AreEqual(plain.RetrieveRaw().c_str(), cached.RetrieveRaw().c_str(), k.c_str());
+                    Assert::AreEqual(plain.Peek().c_str(), cached.Peek().c_str(), k.c_str());
+                    Assert::AreEqual(plain.IsAutocorrected(), cached.IsAutocorrected());
+                }
+            }
+        }
+        const auto& stats = cached.GetCommitCacheStats();
+        Assert::IsTrue(stats.hits > 0);
+        Assert::IsTrue(stats.evictions > 0);
+        Assert::AreEqual(keys.size() * 6, static_cast<size_t>(stats.hits + stats.misses));
+        Assert::AreEqual(uint64_t{0}, plain.GetCommitCacheStats().hits + plain.GetCommitCacheStats().misses);
+    }
 };
 
 } // namespace UnitTests
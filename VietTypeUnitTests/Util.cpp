@@ -2,8 +2,11 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "stdafx.h"
+#include <array>
+#include <span>
 #include "Util.h"
 #include "Telex.h"
+#include "TelexEngine.h"
 
 using namespace VietType::Telex;
 
@@ -42,5 +45,44 @@ void TestPeekWord(ITelexEngine& e, const wchar_t* expected, const wchar_t* input
     Assert::AreEqual(expected, e.Peek().c_str());
 }
 
+void AssertSameEngine(const ITelexEngine& expected, const ITelexEngine& actual, const std::wstring& msg) {
+    Assert::AreEqual(static_cast<int>(expected.GetState()), static_cast<int>(actual.GetState()), msg.c_str());
+    Assert::AreEqual(expected.Count(), actual.Count(), msg.c_str());
+    Assert::AreEqual(expected.Peek().c_str(), actual.Peek().c_str(), msg.c_str());
+    Assert::AreEqual(expected.RetrieveRaw().c_str(), actual.RetrieveRaw().c_str(), msg.c_str());
+    Assert::AreEqual(expected.Retrieve().c_str(), actual.Retrieve().c_str(), msg.c_str());
+    // the span overloads cut the same output short
+    enum class Output { Peek, Retrieve, RetrieveRaw };
+    auto truncated = [](const ITelexEngine& e, Output output, size_t n) {
+        std::array<wchar_t, MaxOutputLength> buf;
+        auto span = std::span(buf).first(n);
+        auto length = output == Output::Peek       ? e.Peek(span)
+                      : output == Output::Retrieve ? e.Retrieve(span)
+                                                   : e.RetrieveRaw(span);
+        return std::wstring(buf.data(), n) + L'/' + std::to_wstring(length);
+    };
+    for (auto [output, size] : {
+             std::pair{Output::Peek, expected.Peek().size()},
+             std::pair{Output::Retrieve, expected.Retrieve().size()},
+             std::pair{Output::RetrieveRaw, expected.RetrieveRaw().size()},
+         }) {
+        Assert::AreEqual(
+            truncated(expected, output, size / 2).c_str(), truncated(actual, output, size / 2).c_str(), msg.c_str());
+    }
+}
+
+void AssertSameEngine(const TelexEngine& expected, const TelexEngine& actual, const std::wstring& msg) {
+    AssertSameEngine(static_cast<const ITelexEngine&>(expected), static_cast<const ITelexEngine&>(actual), msg);
+    Assert::AreEqual(static_cast<int>(expected.GetTone()), static_cast<int>(actual.GetTone()), msg.c_str());
+    Assert::AreEqual(expected.IsBackconverted(), actual.IsBackconverted(), msg.c_str());
+    Assert::AreEqual(expected.IsAutocorrected(), actual.IsAutocorrected(), msg.c_str());
+    auto rpExpected = expected.GetRespos();
+    auto rpActual = actual.GetRespos();
+    Assert::AreEqual(rpExpected.size(), rpActual.size(), msg.c_str());
+    for (size_t i = 0; i < rpExpected.size(); i++) {
+        Assert::AreEqual(static_cast<int>(rpExpected[i]), static_cast<int>(rpActual[i]), msg.c_str());
+    }
+}
+
 } // namespace UnitTests
 } // namespace VietType
@@ -4,7 +4,9 @@
 #pragma once
 
 #include "stdafx.h"
+#include <string>
 #include "Telex.h"
+#include "TelexEngine.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -23,5 +25,17 @@ void TestInvalidWord(VietType::Telex::ITelexEngine& e, const wchar_t* expected,
 
 void TestPeekWord(VietType::Telex::ITelexEngine& e, const wchar_t* expected, const wchar_t* input);
 
+// state, count and every output, including the span overloads cut short
+void AssertSameEngine(
+    const VietType::Telex::ITelexEngine& expected,
+    const VietType::Telex::ITelexEngine& actual,
+    const std::wstring& msg);
+
+// the above plus the tone, flags and respos that only TelexEngine shows
+void AssertSameEngine(
+    const VietType::Telex::TelexEngine& expected,
+    const VietType::Telex::TelexEngine& actual,
+    const std::wstring& msg);
+
 } // namespace UnitTests
 } // namespace VietType
@@ -2,9 +2,21 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "stdafx.h"
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <vector>
 #include "Telex.h"
+#include "TelexCase.h"
+#include "TelexChars.h"
 #include "TelexEngine.h"
+#include "TelexData.h"
+#include "TelexConvert.h"
+#include "TelexLatency.h"
 #include "WordListIterator.hpp"
 #include "FileUtil.hpp"
 
@@ -19,18 +31,496 @@ using namespace VietType::TestLib;
 #define VITERATIONS 2000
 #endif
 
+static std::atomic<unsigned long long> allocations = 0;
+
+// count every heap allocation made by the process so that allocating engine paths can be caught
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+static bool benchalloc() {
+    LONGLONG efsize, vfsize;
+    auto ewords = static_cast<char16_t*>(ReadWholeFile(L"..\\..\\data\\ewdsw.txt", &efsize));
+    auto ewend = ewords + efsize / sizeof(char16_t);
+    auto vwords = static_cast<char16_t*>(ReadWholeFile(L"..\\..\\data\\vw39kw.txt", &vfsize));
+    auto vwend = vwords + vfsize / sizeof(char16_t);
+
+    TelexConfig config;
+    TelexEngine engine(config);
+    unsigned long long count = 0;
+    auto before = allocations.load();
+    for (Utf16WordListIterator ew(ewords, ewend); ew != ewend; ew++) {
+        engine.Reset();
+        for (auto c : ew.wstr()) {
+            engine.PushChar(c);
+        }
+        engine.Commit();
+        engine.Reset();
+        for (auto c : ew.wstr()) {
+            engine.PushChar(c);
+        }
+        engine.Cancel();
+        count++;
+    }
+    for (Utf16WordListIterator vw(vwords, vwend); vw != vwend; vw++) {
+        engine.Reset();
+        engine.Backconvert(vw.wstr());
+        engine.Backspace();
+        engine.ForceCommit();
+        count++;
+    }
+    auto allocated = allocations.load() - before;
+    wprintf(
+        L"keystroke paths: count = %llu, allocations = %llu, sizeof(TelexEngine) = %zu\n",
+        count,
+        allocated,
+        sizeof(TelexEngine));
+
+    FreeFile(vwords);
+    FreeFile(ewords);
+    return !allocated;
+}
+
+template <typename Table, typename Key>
+static void benchlookup(const wchar_t* name, const Table& table, const std::vector<Key>& queries) {
+    unsigned long long count = 0;
+    unsigned long long found = 0;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (auto i = 0; i < VITERATIONS * 100; i++) {
+        for (const auto& q : queries) {
+            found += table.find(q) != table.end();
+            count++;
+        }
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    wprintf(
+        L"%s: count = %llu, found = %llu, time = %llu us\n",
+        name,
+        count,
+        found,
+        std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count());
+}
+
+// compare the perfect hash tables against sorted and unsorted ArrayMaps holding the same entries,
+// querying every key and as many misses
+template <typename K, typename V, size_t N>
+static void benchmap(const wchar_t* name, const HashMap<K, V, N>& table, const std::vector<K>& misses) {
+    ArrayMap<K, V, N, true> sorted;
+    ArrayMap<K, V, N, false> unsorted;
+    std::copy(table.begin(), table.end(), sorted.begin());
+    std::sort(sorted.begin(), sorted.end(), twopair_less<K, V>);
+    std::copy(table.begin(), table.end(), unsorted.begin());
+
+    std::vector<K> queries;
+    for (const auto& p : table) {
+        queries.push_back(p.first);
+    }
+    queries.insert(queries.end(), misses.begin(), misses.end());
+
+    wprintf(L"%s (%zu entries)\n", name, N);
+    benchlookup(L"  hash", table, queries);
+    benchlookup(L"  sorted", sorted, queries);
+    benchlookup(L"  unsorted", unsorted, queries);
+}
+
+static void benchmaps() {
+    std::vector<std::wstring_view> vmisses{L"aa", L"oeo", L"uu", L"ieu", L"w", L"uyu", L"aaa", L"yy"};
+    benchmap(L"valid_v", valid_v, vmisses);
+    benchmap(L"valid_v_gi", valid_v_gi, vmisses);
+    benchmap(L"transitions", transitions, vmisses);
+    std::vector<wchar_t> cmisses{L'a', L'b', L'z', L'\x1ef0', L'\x110', L'\xc0', L'\x300', L'\x1b1'};
+    benchmap(L"backconversions", backconversions, cmisses);
+}
+
+template <typename Fn>
+static void benchcharfn(const wchar_t* name, Fn&& fn) {
+    unsigned long long checksum = 0;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (auto i = 0; i < VITERATIONS / 10; i++) {
+        for (uint32_t u = 0; u <= 0xffff; u++) {
+            checksum += fn(static_cast<wchar_t>(u));
+        }
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    wprintf(
+        L"  %s: checksum = %llu, time = %llu us\n",
+        name,
+        checksum,
+        std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count());
+}
+
+// run the character table and what it replaced over every BMP code unit
+static void benchchars() {
+    std::vector<wchar_t> sorted(vietnameseLetters.begin(), vietnameseLetters.end());
+    for (auto c : vietnameseLetters) {
+        sorted.push_back(ToUpperRule(c));
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    wprintf(L"chars total iters: %d\n", VITERATIONS / 10);
+    benchcharfn(L"upper table", [](wchar_t c) { return ToUpper(c); });
+    benchcharfn(L"upper ranges", [](wchar_t c) { return ToUpperRule(c); });
+    benchcharfn(L"lower table", [](wchar_t c) { return ToLower(c); });
+    benchcharfn(L"lower ranges", [](wchar_t c) { return ToLowerRule(c); });
+    benchcharfn(L"letter table", [](wchar_t c) { return IsVietnameseLetter(c); });
+    benchcharfn(L"letter search", [&](wchar_t c) {
+        auto it = std::lower_bound(sorted.begin(), sorted.end(), c);
+        return (c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z') || (it != sorted.end() && *it == c);
+    });
+    benchcharfn(L"class table", [](wchar_t c) { return static_cast<unsigned int>(ClassifyCharacter(c)); });
+    benchcharfn(L"class ranges", [](wchar_t c) {
+        return static_cast<unsigned int>(c >= L'a' && c <= L'z' ? letterClasses[c - L'a'] : CharTypes::Uncategorized);
+    });
+}
+
+template <typename Fn>
+static void benchcasefn(const wchar_t* name, const std::vector<char16_t>& text, Fn&& fn) {
+    auto s = text;
+    unsigned long long checksum = 0;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (auto i = 0; i < EITERATIONS; i++) {
+        fn(std::span<char16_t>(s));
+        checksum += s[i % s.size()];
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    wprintf(
+        L"  %s: checksum = %llu, time = %llu us\n",
+        name,
+        checksum,
+        std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count());
+}
+
+// case the Vietnamese word list as one document with the run kernels and one character at a time
+static void benchcase() {
+    LONGLONG vfsize;
+    auto vwords = static_cast<char16_t*>(ReadWholeFile(L"..\\..\\data\\vw39kw.txt", &vfsize));
+    auto vwend = vwords + vfsize / sizeof(char16_t);
+    std::vector<char16_t> text;
+    for (Utf16WordListIterator vw(vwords, vwend); vw != vwend; vw++) {
+        for (auto c : vw.wstr()) {
+            text.push_back(static_cast<char16_t>(text.size() % 3 ? c : ToUpper(c)));
+        }
+        text.push_back(u' ');
+    }
+    FreeFile(vwords);
+    std::vector<uint64_t> bits((text.size() + 63) / 64);
+    std::mt19937_64 rng(0);
+    for (auto& b : bits) {
+        b = rng() & rng();
+    }
+
+    wprintf(L"case %s total iters: %d, length = %zu\n", CaseKernelName(), EITERATIONS, text.size());
+    benchcasefn(L"upper run", text, [](std::span<char16_t> s) { ToUpperRun(s); });
+    benchcasefn(L"upper scalar", text, [](std::span<char16_t> s) {
+        for (auto& c : s) {
+            c = static_cast<char16_t>(ToUpper(c));
+        }
+    });
+    benchcasefn(L"lower run", text, [](std::span<char16_t> s) { ToLowerRun(s); });
+    benchcasefn(L"lower scalar", text, [](std::span<char16_t> s) {
+        for (auto& c : s) {
+            c = static_cast<char16_t>(ToLower(c));
+        }
+    });
+    benchcasefn(L"bits run", text, [&](std::span<char16_t> s) { ApplyCaseBits(s, bits); });
+    benchcasefn(L"bits scalar", text, [&](std::span<char16_t> s) {
+        for (size_t i = 0; i < s.size(); i++) {
+            if ((bits[i / 64] >> (i % 64)) & 1) {
+                s[i] = static_cast<char16_t>(ToUpper(s[i]));
+            }
+        }
+    });
+}
+
+// compare composing each word with the allocating Peek/Retrieve against the span overloads
+static void benchspan() {
+    LONGLONG vfsize;
+    auto vwords = static_cast<char16_t*>(ReadWholeFile(L"..\\..\\data\\vw39kw.txt", &vfsize));
+    auto vwend = vwords + vfsize / sizeof(char16_t);
+    TelexConfig config;
+    TelexEngine engine(config);
+
+    // retype the backconverted keys so that every word goes through PushChar
+    std::vector<std::wstring> keys;
+    for (Utf16WordListIterator vw(vwords, vwend); vw != vwend; vw++) {
+        engine.Reset();
+        engine.Backconvert(vw.wstr());
+        keys.push_back(engine.RetrieveRaw());
+    }
+    FreeFile(vwords);
+
+    for (auto useSpan : {false, true}) {
+        std::array<wchar_t, MaxOutputLength> buf;
+        unsigned long long count = 0;
+        unsigned long long checksum = 0;
+        auto before = allocations.load();
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (auto i = 0; i < EITERATIONS; i++) {
+            for (const auto& word : keys) {
+                engine.Reset();
+                for (auto c : word) {
+                    engine.PushChar(c);
+                    if (useSpan) {
+                        checksum += engine.Peek(buf);
+                    } else {
+                        checksum += engine.Peek().size();
+                    }
+                }
+                engine.Commit();
+                if (useSpan) {
+                    checksum += engine.Retrieve(buf);
+                } else {
+                    checksum += engine.Retrieve().size();
+                }
+                count++;
+            }
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        wprintf(
+            L"%s output total iters: %d, count = %llu, checksum = %llu, allocations = %llu, time = %llu us\n",
+            useSpan ? L"span" : L"wstring",
+            EITERATIONS,
+            count,
+            checksum,
+            allocations.load() - before,
+            std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count());
+    }
+}
+
+static unsigned long long typewords(ITelexEngine& engine, const std::vector<std::wstring>& words) {
+    unsigned long long checksum = 0;
+    for (auto i = 0; i < EITERATIONS; i++) {
+        for (const auto& word : words) {
+            engine.Reset();
+            for (auto c : word) {
+                engine.PushChar(c);
+            }
+            checksum += static_cast<unsigned long long>(engine.Commit());
+        }
+    }
+    return checksum;
+}
+
+// type the English word list on the engine taking any config and on the one TelexNew fixes to the config
+static void benchconfigs() {
+    LONGLONG efsize;
+    auto ewords = static_cast<char16_t*>(ReadWholeFile(L"..\\..\\data\\ewdsw.txt", &efsize));
+    auto ewend = ewords + efsize / sizeof(char16_t);
+    std::vector<std::wstring> words;
+    for (Utf16WordListIterator ew(ewords, ewend); ew != ewend; ew++) {
+        words.emplace_back(ew.wstr());
+    }
+    FreeFile(ewords);
+
+    for (int flags = 0; flags < 32; flags++) {
+        TelexConfig config;
+        config.oa_uy_tone1 = !!(flags & 1);
+        config.accept_separate_dd = !!(flags & 2);
+        config.optimize_multilang = (flags >> 2) & 3;
+        config.autocorrect = !!(flags & 16);
+
+        TelexEngine dynamic(config);
+        std::unique_ptr<ITelexEngine> fixed(TelexNew(config));
+        auto t1 = std::chrono::high_resolution_clock::now();
+        auto checksum1 = typewords(dynamic, words);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        auto checksum2 = typewords(*fixed, words);
+        auto t3 = std::chrono::high_resolution_clock::now();
+        wprintf(
+            L"oa_uy_tone1 = %d, accept_separate_dd = %d, optimize_multilang = %lu, autocorrect = %d: "
+            L"dynamic = %llu us, fixed = %llu us%s\n",
+            config.oa_uy_tone1,
+            config.accept_separate_dd,
+            config.optimize_multilang,
+            config.autocorrect,
+            std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count(),
+            std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count(),
+            checksum1 == checksum2 ? L"" : L" (results differ)");
+    }
+}
+
+// a stream of Vietnamese words with Zipf frequencies (s = 1), about one word in ten capitalized,
+// typed with the commit cache at different sizes; Commit is timed on its own
+static void benchcommitcache() {
+    LONGLONG vfsize;
+    auto vwords = static_cast<char16_t*>(ReadWholeFile(L"..\\..\\data\\vw39kw.txt", &vfsize));
+    auto vwend = vwords + vfsize / sizeof(char16_t);
+    std::vector<std::wstring> keys;
+    {
+        TelexConfig config;
+        TelexEngine engine(config);
+        for (Utf16WordListIterator vw(vwords, vwend); vw != vwend; vw++) {
+            engine.Reset();
+            if (engine.Backconvert(vw.wstr()) == TelexStates::Valid) {
+                keys.push_back(engine.RetrieveRaw());
+            }
+        }
+    }
+    FreeFile(vwords);
+
+    // the list is sorted, so give the ranks out in random order
+    std::mt19937 rng(12345);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    std::vector<double> weights;
+    for (size_t rank = 1; rank <= keys.size(); rank++) {
+        weights.push_back(1.0 / static_cast<double>(rank));
+    }
+    std::discrete_distribution<size_t> zipf(weights.begin(), weights.end());
+    std::vector<std::wstring> stream;
+    for (auto i = 0; i < EITERATIONS * 10000; i++) {
+        auto word = keys[zipf(rng)];
+        if (rng() % 10 == 0) {
+            word[0] = ToUpper(word[0]);
+        }
+        stream.push_back(std::move(word));
+    }
+
+    for (unsigned int size : {0u, 256u, 1024u, 4096u}) {
+        TelexConfig config;
+        config.commit_cache_size = size;
+        TelexEngine engine(config);
+        std::chrono::high_resolution_clock::duration hitTime{}, missTime{};
+        std::array<wchar_t, MaxOutputLength> buf;
+        unsigned long long checksum = 0;
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (const auto& word : stream) {
+            engine.Reset();
+            for (auto c : word) {
+                engine.PushChar(c);
+            }
+            auto hits = engine.GetCommitCacheStats().hits;
+            auto c1 = std::chrono::high_resolution_clock::now();
+            engine.Commit();
+            auto c2 = std::chrono::high_resolution_clock::now();
+            (engine.GetCommitCacheStats().hits != hits ? hitTime : missTime) += c2 - c1;
+            checksum += engine.Retrieve(buf);
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        const auto& stats = engine.GetCommitCacheStats();
+        auto lookups = stats.hits + stats.misses;
+        wprintf(
+            L"commit cache %u: words = %zu, hit rate = %.1f%%, evictions = %llu, "
+            L"commit hit = %.1f ns, commit miss = %.1f ns, time = %llu us, checksum = %llu\n",
+            size,
+            stream.size(),
+            lookups ? 100.0 * static_cast<double>(stats.hits) / static_cast<double>(lookups) : 0.0,
+            static_cast<unsigned long long>(stats.evictions),
+            stats.hits ? static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(hitTime).count()) /
+                             static_cast<double>(stats.hits)
+                       : 0.0,
+            static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(missTime).count()) /
+                static_cast<double>(stream.size() - stats.hits),
+            std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count(),
+            checksum);
+    }
+}
+
+// convert the English word list as one document, on one thread and on every core
+static void benchconvert() {
+    LONGLONG efsize;
+    auto ewords = static_cast<char16_t*>(ReadWholeFile(L"..\\..\\data\\ewdsw.txt", &efsize));
+    auto ewend = ewords + efsize / sizeof(char16_t);
+    std::wstring text;
+    for (auto i = 0; i < EITERATIONS / 10; i++) {
+        for (Utf16WordListIterator ew(ewords, ewend); ew != ewend; ew++) {
+            text.append(ew.wstr());
+            text.push_back(L' ');
+        }
+    }
+    FreeFile(ewords);
+
+    TelexConfig config;
+    for (unsigned int threads : {1u, 0u}) {
+        auto t1 = std::chrono::high_resolution_clock::now();
+        auto result = ConvertText(config, text, threads);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        wprintf(
+            L"convert threads = %u: length = %zu, output = %zu, time = %llu us\n",
+            threads,
+            text.size(),
+            result.size(),
+            std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count());
+    }
+}
+
+static void printlatency(const LatencySummary& s) {
+    wprintf(
+        L"count = %llu, p50 = %llu ns, p99 = %llu ns, p999 = %llu ns, max = %llu ns\n",
+        static_cast<unsigned long long>(s.count),
+        static_cast<unsigned long long>(s.p50),
+        static_cast<unsigned long long>(s.p99),
+        static_cast<unsigned long long>(s.p999),
+        static_cast<unsigned long long>(s.max));
+}
+
+// type both word lists through TelexNew the way the text service does, with a Peek after every key and a
+// Backspace and Backconvert on every Vietnamese word, then print what the latency layer recorded
+static void benchlatency() {
+    LONGLONG efsize, vfsize;
+    auto ewords = static_cast<char16_t*>(ReadWholeFile(L"..\\..\\data\\ewdsw.txt", &efsize));
+    auto ewend = ewords + efsize / sizeof(char16_t);
+    auto vwords = static_cast<char16_t*>(ReadWholeFile(L"..\\..\\data\\vw39kw.txt", &vfsize));
+    auto vwend = vwords + vfsize / sizeof(char16_t);
+
+    TelexConfig config;
+    std::unique_ptr<ITelexEngine> engine(TelexNew(config));
+    std::array<wchar_t, MaxOutputLength> buf;
+    GlobalLatencyRecorder().Clear();
+    for (Utf16WordListIterator ew(ewords, ewend); ew != ewend; ew++) {
+        engine->Reset();
+        for (auto c : ew.wstr()) {
+            engine->PushChar(c);
+            engine->Peek(buf);
+        }
+        engine->Commit();
+        engine->Retrieve(buf);
+    }
+    for (Utf16WordListIterator vw(vwords, vwend); vw != vwend; vw++) {
+        engine->Reset();
+        engine->Backconvert(vw.wstr());
+        engine->Backspace();
+        engine->Peek(buf);
+        engine->Cancel();
+        engine->Retrieve(buf);
+    }
+    FreeFile(vwords);
+    FreeFile(ewords);
+
+    auto snapshot = GlobalLatencyRecorder().Snapshot();
+    for (const auto& s : snapshot.operations) {
+        wprintf(L"latency %s: ", LatencyOpName(s.op));
+        printlatency(s);
+    }
+    for (const auto& s : snapshot.transitions) {
+        wprintf(L"  %s %s -> %s: ", LatencyOpName(s.op), LatencyStateName(s.from), LatencyStateName(s.to));
+        printlatency(s);
+    }
+}
+
 bool bench() {
     {
         LONGLONG efsize;
-        auto ewords = static_cast<wchar_t*>(ReadWholeFile(L"..\\..\\data\\ewdsw.txt", &efsize));
-        auto ewend = ewords + efsize / sizeof(wchar_t);
+        auto ewords = static_cast<char16_t*>(ReadWholeFile(L"..\\..\\data\\ewdsw.txt", &efsize));
+        auto ewend = ewords + efsize / sizeof(char16_t);
         TelexConfig config;
         TelexEngine engine(config);
         unsigned long long count = 0;
         auto t1 = std::chrono::high_resolution_clock::now();
         for (auto i = 0; i < EITERATIONS; i++) {
-            for (WordListIterator ew(ewords, ewend); ew != ewend; ew++) {
-                std::wstring eword(*ew, ew.wlen());
+            for (Utf16WordListIterator ew(ewords, ewend); ew != ewend; ew++) {
+                std::wstring eword(ew.wstr());
                 engine.Reset();
                 for (auto c : eword) {
                     engine.PushChar(c);
@@ -52,15 +542,15 @@ bool bench() {
 
     {
         LONGLONG vfsize;
-        auto vwords = static_cast<wchar_t*>(ReadWholeFile(L"..\\..\\data\\vw39kw.txt", &vfsize));
-        auto vwend = vwords + vfsize / sizeof(wchar_t);
+        auto vwords = static_cast<char16_t*>(ReadWholeFile(L"..\\..\\data\\vw39kw.txt", &vfsize));
+        auto vwend = vwords + vfsize / sizeof(char16_t);
         TelexConfig config;
         TelexEngine engine(config);
         unsigned long long count = 0;
         auto t1 = std::chrono::high_resolution_clock::now();
         for (auto i = 0; i < VITERATIONS; i++) {
-            for (WordListIterator vw(vwords, vwend); vw != vwend; vw++) {
-                std::wstring vword(*vw, vw.wlen());
+            for (Utf16WordListIterator vw(vwords, vwend); vw != vwend; vw++) {
+                std::wstring vword(vw.wstr());
                 engine.Reset();
                 engine.Backconvert(vword);
                 count++;
@@ -74,5 +564,17 @@ bool bench() {
             std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count());
         FreeFile(vwords);
     }
-    return true;
+
+    benchspan();
+    benchmaps();
+    benchchars();
+    benchcase();
+    benchconvert();
+    benchconfigs();
+    benchcommitcache();
+    if (LatencyEnabled) {
+        benchlatency();
+    }
+
+    return benchalloc();
 }
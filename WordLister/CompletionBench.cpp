@@ -0,0 +1,133 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <array>
+#include <chrono>
+#include <climits>
+#include <set>
+#include <vector>
+#include "CompletionTrie.h"
+#include "Telex.h"
+#include "TelexEngine.h"
+#include "WordListIterator.hpp"
+#include "FileUtil.hpp"
+
+using namespace VietType::Completion;
+using namespace VietType::Telex;
+using namespace VietType::TestLib;
+
+#ifdef _DEBUG
+#define CITERATIONS 2
+#else
+#define CITERATIONS 50
+#endif
+
+// every prefix of every word, looked up k results at a time
+static void benchcomplete(const CompletionTrie& trie, const std::vector<std::wstring>& prefixes, size_t k) {
+    std::array<CompletionResult, CompletionTrie::MaxResults> results;
+    unsigned long long checksum = 0;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (auto i = 0; i < CITERATIONS; i++) {
+        for (const auto& p : prefixes) {
+            checksum += trie.Complete(p, std::span(results.data(), k));
+        }
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
+    wprintf(
+        L"  k = %zu: checksum = %llu, time = %llu us, %.1f ns/lookup\n",
+        k,
+        checksum,
+        static_cast<unsigned long long>(ns / 1000),
+        static_cast<double>(ns) / CITERATIONS / prefixes.size());
+}
+
+// slowest lookups one at a time, taking the best of a few runs of each to leave out interrupts;
+// the clock itself adds a few dozen ns to each
+static void benchcompletetail(const CompletionTrie& trie, const std::vector<std::wstring>& prefixes) {
+    std::array<CompletionResult, CompletionTrie::MaxResults> results;
+    std::vector<long long> samples(prefixes.size(), LLONG_MAX);
+    for (auto rep = 0; rep < 5; rep++) {
+        for (size_t i = 0; i < prefixes.size(); i++) {
+            auto t1 = std::chrono::high_resolution_clock::now();
+            trie.Complete(prefixes[i], results);
+            auto t2 = std::chrono::high_resolution_clock::now();
+            auto ns = static_cast<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+            samples[i] = std::min(samples[i], ns);
+        }
+    }
+    std::sort(samples.begin(), samples.end());
+    wprintf(
+        L"  k = %zu each: p50 = %lld ns, p99 = %lld ns, max = %lld ns\n",
+        results.size(),
+        samples[samples.size() / 2],
+        samples[samples.size() * 99 / 100],
+        samples.back());
+}
+
+bool completionbench() {
+    LONGLONG vfsize;
+    auto vwords = static_cast<char16_t*>(ReadWholeFile(L"..\\..\\data\\vw39kw.txt", &vfsize));
+    if (!vwords) {
+        return false;
+    }
+    auto vwend = vwords + vfsize / sizeof(char16_t);
+    // the list is UTF-16, so keep the words as wchar_t for the views below
+    std::vector<std::wstring> wordStore;
+    std::set<std::wstring> prefixSet;
+    for (Utf16WordListIterator vw(vwords, vwend); vw != vwend; vw++) {
+        if (vw.wlen()) {
+            std::wstring w(vw.wstr());
+            for (size_t n = 1; n <= w.size(); n++) {
+                prefixSet.emplace(w.substr(0, n));
+            }
+            wordStore.push_back(std::move(w));
+        }
+    }
+    std::vector<std::wstring_view> words(wordStore.begin(), wordStore.end());
+    std::vector<std::wstring> prefixes(prefixSet.begin(), prefixSet.end());
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    auto trie = CompletionTrie::Build(words);
+    auto t2 = std::chrono::high_resolution_clock::now();
+    wprintf(
+        L"completion: words = %zu, states = %zu, build = %llu us, prefixes = %zu, total iters: %d\n",
+        trie.Count(),
+        trie.StateCount(),
+        static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()),
+        prefixes.size(),
+        CITERATIONS);
+    for (size_t k : {1, 4, 8, 16}) {
+        benchcomplete(trie, prefixes, k);
+    }
+    benchcompletetail(trie, prefixes);
+
+    // what a keystroke costs: Peek from the engine then complete
+    TelexConfig config;
+    std::vector<TelexEngine> engines;
+    for (auto w : words) {
+        TelexEngine e(config);
+        e.Backconvert(w.substr(0, (w.size() + 1) / 2));
+        engines.push_back(std::move(e));
+    }
+    std::array<CompletionResult, 8> results;
+    unsigned long long checksum = 0;
+    t1 = std::chrono::high_resolution_clock::now();
+    for (auto i = 0; i < CITERATIONS; i++) {
+        for (const auto& e : engines) {
+            checksum += trie.Complete(e, results);
+        }
+    }
+    t2 = std::chrono::high_resolution_clock::now();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
+    wprintf(
+        L"  engine k = %zu: checksum = %llu, time = %llu us, %.1f ns/lookup\n",
+        results.size(),
+        checksum,
+        static_cast<unsigned long long>(ns / 1000),
+        static_cast<double>(ns) / CITERATIONS / engines.size());
+
+    FreeFile(vwords);
+    return true;
+}
@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <fcntl.h>
+#include <io.h>
+#include <vector>
+#include "Telex.h"
+#include "TelexConvert.h"
+
+using namespace VietType::Telex;
+
+static constexpr size_t StreamChunkSize = 1 << 16;
+
+enum class StreamEncoding {
+    Detect,
+    Utf8,
+    Utf16,
+};
+
+// number of bytes at the end that belong to a UTF-8 sequence cut by the chunk boundary
+static size_t IncompleteUtf8Tail(const char* buf, size_t len) {
+    for (size_t back = 1; back <= 3 && back <= len; back++) {
+        auto c = static_cast<unsigned char>(buf[len - back]);
+        if ((c & 0xc0) == 0x80) {
+            continue;
+        }
+        size_t need = c >= 0xf0 ? 4 : c >= 0xe0 ? 3 : c >= 0xc0 ? 2 : 1;
+        return need > back ? back : 0;
+    }
+    return 0;
+}
+
+static bool WriteOutput(const std::wstring& output, StreamEncoding encoding, std::string& narrow) {
+    if (output.empty()) {
+        return true;
+    }
+    if (encoding == StreamEncoding::Utf16) {
+        return fwrite(output.data(), sizeof(wchar_t), output.size(), stdout) == output.size();
+    }
+    auto length = WideCharToMultiByte(
+        CP_UTF8, 0, output.data(), static_cast<int>(output.size()), nullptr, 0, nullptr, nullptr);
+    narrow.resize(length);
+    WideCharToMultiByte(
+        CP_UTF8, 0, output.data(), static_cast<int>(output.size()), narrow.data(), length, nullptr, nullptr);
+    return fwrite(narrow.data(), 1, narrow.size(), stdout) == narrow.size();
+}
+
+// stdin to stdout in fixed size chunks, only the unfinished word is carried from one chunk to the next
+bool convertstream(const wchar_t* encodingName) {
+    auto encoding = StreamEncoding::Detect;
+    if (encodingName && !wcscmp(encodingName, L"utf8")) {
+        encoding = StreamEncoding::Utf8;
+    } else if (encodingName && !wcscmp(encodingName, L"utf16")) {
+        encoding = StreamEncoding::Utf16;
+    } else if (encodingName) {
+        fwprintf(stderr, L"unknown encoding %s\n", encodingName);
+        return false;
+    }
+
+    if (_setmode(_fileno(stdin), _O_BINARY) == -1 || _setmode(_fileno(stdout), _O_BINARY) == -1) {
+        return false;
+    }
+
+    TelexConfig config;
+    TextConverter converter(config);
+    // room for the bytes carried over from the last chunk
+    std::vector<char> in(StreamChunkSize + 4);
+    std::wstring wide;
+    std::wstring output;
+    std::string narrow;
+    size_t carry = 0;
+    bool first = true;
+    while (true) {
+        auto read = fread(in.data() + carry, 1, StreamChunkSize, stdin);
+        if (!read) {
+            break;
+        }
+        auto len = carry + read;
+        size_t start = 0;
+
+        if (first) {
+            first = false;
+            auto bytes = reinterpret_cast<const unsigned char*>(in.data());
+            bool bom16 = len >= 2 && bytes[0] == 0xff && bytes[1] == 0xfe;
+            bool bom8 = len >= 3 && bytes[0] == 0xef && bytes[1] == 0xbb && bytes[2] == 0xbf;
+            if (encoding == StreamEncoding::Detect) {
+                encoding = bom16 ? StreamEncoding::Utf16 : StreamEncoding::Utf8;
+            }
+            // the BOM is not part of the first word
+            if ((encoding == StreamEncoding::Utf16 && bom16) || (encoding == StreamEncoding::Utf8 && bom8)) {
+                start = bom16 ? 2 : 3;
+                if (fwrite(in.data(), 1, start, stdout) != start) {
+                    return false;
+                }
+            }
+        }
+
+        size_t usable;
+        if (encoding == StreamEncoding::Utf16) {
+            usable = (len - start) & ~size_t{1};
+            wide.resize(usable / sizeof(wchar_t));
+            memcpy(wide.data(), in.data() + start, usable);
+        } else {
+            usable = len - start - IncompleteUtf8Tail(in.data() + start, len - start);
+            auto length = MultiByteToWideChar(CP_UTF8, 0, in.data() + start, static_cast<int>(usable), nullptr, 0);
+            wide.resize(length);
+            MultiByteToWideChar(CP_UTF8, 0, in.data() + start, static_cast<int>(usable), wide.data(), length);
+        }
+
+        output.clear();
+        converter.Push(wide, output);
+        if (!WriteOutput(output, encoding, narrow)) {
+            return false;
+        }
+
+        carry = len - start - usable;
+        memmove(in.data(), in.data() + start + usable, carry);
+    }
+
+    // a truncated character at the very end is dropped
+    output.clear();
+    converter.Flush(output);
+    return WriteOutput(output, encoding, narrow) && !ferror(stdin) && !fflush(stdout);
+}
@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <cstdio>
+#include <vector>
+#include "Telex.h"
+#include "WordListIterator.hpp"
+#include "FileUtil.hpp"
+#include "TelexEngine.h"
+#include "TelexDfa.h"
+
+using namespace VietType::Telex;
+using namespace VietType::TestLib;
+
+static bool SameResult(const ITelexEngine& expected, const ITelexEngine& actual) {
+    return expected.GetState() == actual.GetState() && expected.Peek() == actual.Peek() &&
+           expected.Retrieve() == actual.Retrieve() && expected.RetrieveRaw() == actual.RetrieveRaw();
+}
+
+// type every seed in lowercase, capitalized and uppercase on both engines
+static size_t VerifyDfa(const TelexDfa& dfa, const std::vector<std::wstring>& seeds) {
+    size_t failures = 0;
+    TelexEngine expected(dfa.config);
+    TelexDfaEngine actual(dfa);
+    for (const auto& seed : seeds) {
+        for (int variant = 0; variant < 3; variant++) {
+            auto keys = seed;
+            for (size_t i = 0; i < keys.size(); i++) {
+                if (variant == 2 || (variant == 1 && i == 0)) {
+                    keys[i] = ToUpper(keys[i]);
+                }
+            }
+            expected.Reset();
+            actual.Reset();
+            bool same = true;
+            for (auto c : keys) {
+                expected.PushChar(c);
+                actual.PushChar(c);
+                same = same && SameResult(expected, actual);
+            }
+            expected.Commit();
+            actual.Commit();
+            if (!same || !SameResult(expected, actual)) {
+                wprintf(L"mismatch: %s\n", keys.c_str());
+                failures++;
+            }
+        }
+    }
+    return failures;
+}
+
+bool dfagen(const wchar_t* filename) {
+    TelexConfig defaultConfig;
+    std::vector<std::wstring> seeds;
+    {
+        LONGLONG vfsize;
+        auto vwords = static_cast<char16_t*>(ReadWholeFile(L"..\\..\\data\\vw39kw.txt", &vfsize));
+        auto vwend = vwords + vfsize / sizeof(char16_t);
+        TelexEngine engine(defaultConfig);
+        for (Utf16WordListIterator vw(vwords, vwend); vw != vwend; vw++) {
+            engine.Reset();
+            if (engine.Backconvert(vw.wstr()) == TelexStates::Valid) {
+                seeds.push_back(engine.RetrieveRaw());
+            }
+        }
+        FreeFile(vwords);
+    }
+
+    // backspaced_word_stays_invalid only matters to Backspace, which always runs on the reference engine
+    bool ok = true;
+    for (int flags = 0; flags < 32; flags++) {
+        TelexConfig config;
+        config.oa_uy_tone1 = !!(flags & 1);
+        config.accept_separate_dd = !!(flags & 2);
+        config.autocorrect = !!(flags & 4);
+        config.optimize_multilang = flags >> 3;
+
+        size_t unminimized;
+        auto dfa = TelexDfa::Build(config, seeds, &unminimized);
+        auto failures = VerifyDfa(dfa, seeds);
+        wprintf(
+            L"oa_uy_tone1 = %d, accept_separate_dd = %d, autocorrect = %d, optimize_multilang = %lu: "
+            L"states = %zu (%zu before minimization), strings = %zu, failures = %zu\n",
+            config.oa_uy_tone1,
+            config.accept_separate_dd,
+            config.autocorrect,
+            config.optimize_multilang,
+            dfa.StateCount(),
+            unminimized,
+            dfa.strings.size(),
+            failures);
+        ok = ok && !failures;
+
+        if (filename && config.oa_uy_tone1 == defaultConfig.oa_uy_tone1 &&
+            config.accept_separate_dd == defaultConfig.accept_separate_dd &&
+            config.autocorrect == defaultConfig.autocorrect &&
+            config.optimize_multilang == defaultConfig.optimize_multilang) {
+            FILE* f = nullptr;
+            if (_wfopen_s(&f, filename, L"wb") || !dfa.Save(f)) {
+                wprintf(L"cannot write %s\n", filename);
+                ok = false;
+            }
+            if (f) {
+                fclose(f);
+            }
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,360 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <random>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "Telex.h"
+#include "FileUtil.hpp"
+#include "TelexEngine.h"
+#include "TelexDfa.h"
+
+using namespace VietType::Telex;
+using namespace VietType::TestLib;
+
+enum class DiffOpKind {
+    Push,
+    Backspace,
+    Commit,
+    ForceCommit,
+    Cancel,
+    Backconvert,
+    Reset,
+};
+
+struct DiffOp {
+    DiffOpKind kind;
+    wchar_t key = 0;
+    std::wstring text;
+};
+
+using DiffOps = std::vector<DiffOp>;
+using EngineFactory = std::function<std::unique_ptr<ITelexEngine>(const TelexConfig&)>;
+using SpanOutput = std::size_t (ITelexEngine::*)(std::span<wchar_t>) const;
+
+// the engines difffuzz can compare; dfa is built for each config from the Vietnamese word list
+static constexpr std::wstring_view EngineKinds[] = {L"dynamic", L"fixed", L"cache", L"dfa"};
+
+static const std::pair<const wchar_t*, SpanOutput> SpanOutputs[] = {
+    {L"Peek", &ITelexEngine::Peek},
+    {L"Retrieve", &ITelexEngine::Retrieve},
+    {L"RetrieveRaw", &ITelexEngine::RetrieveRaw},
+};
+
+static std::wstring FormatOps(const DiffOps& ops) {
+    std::wstring out;
+    for (const auto& op : ops) {
+        switch (op.kind) {
+        case DiffOpKind::Push:
+            out.push_back(op.key);
+            break;
+        case DiffOpKind::Backspace:
+            out.append(L"[bs]");
+            break;
+        case DiffOpKind::Commit:
+            out.append(L"[commit]");
+            break;
+        case DiffOpKind::ForceCommit:
+            out.append(L"[forcecommit]");
+            break;
+        case DiffOpKind::Cancel:
+            out.append(L"[cancel]");
+            break;
+        case DiffOpKind::Backconvert:
+            out.append(L"[backconvert ").append(op.text).append(L"]");
+            break;
+        case DiffOpKind::Reset:
+            out.append(L"[reset]");
+            break;
+        }
+    }
+    return out;
+}
+
+static TelexStates Apply(ITelexEngine& e, const DiffOp& op) {
+    switch (op.kind) {
+    case DiffOpKind::Push:
+        return e.PushChar(op.key);
+    case DiffOpKind::Backspace:
+        return e.Backspace();
+    case DiffOpKind::Commit:
+        return e.Commit();
+    case DiffOpKind::ForceCommit:
+        return e.ForceCommit();
+    case DiffOpKind::Cancel:
+        return e.Cancel();
+    case DiffOpKind::Backconvert:
+        return e.Backconvert(op.text);
+    case DiffOpKind::Reset:
+        e.Reset();
+        return e.GetState();
+    }
+    return TelexStates::TxError;
+}
+
+// what a span overload writes into a buffer of the given size, followed by the length it returns
+static std::wstring FormatSpanOutput(const ITelexEngine& e, SpanOutput output, size_t room) {
+    std::array<wchar_t, MaxOutputLength> buf;
+    auto length = (e.*output)(std::span(buf).first(room));
+    return std::wstring(buf.data(), std::min(length, room)) + L'/' + std::to_wstring(length);
+}
+
+// describes the first difference between the engines, or returns an empty string
+static std::wstring Difference(const ITelexEngine& expected, const ITelexEngine& actual) {
+    if (expected.GetState() != actual.GetState()) {
+        return L"GetState " + std::to_wstring(static_cast<int>(expected.GetState())) + L" vs " +
+               std::to_wstring(static_cast<int>(actual.GetState()));
+    }
+    if (expected.Count() != actual.Count()) {
+        return L"Count " + std::to_wstring(expected.Count()) + L" vs " + std::to_wstring(actual.Count());
+    }
+    if (expected.Peek() != actual.Peek()) {
+        return L"Peek '" + expected.Peek() + L"' vs '" + actual.Peek() + L"'";
+    }
+    if (expected.Retrieve() != actual.Retrieve()) {
+        return L"Retrieve '" + expected.Retrieve() + L"' vs '" + actual.Retrieve() + L"'";
+    }
+    if (expected.RetrieveRaw() != actual.RetrieveRaw()) {
+        return L"RetrieveRaw '" + expected.RetrieveRaw() + L"' vs '" + actual.RetrieveRaw() + L"'";
+    }
+    // the span overloads, with room for the whole output and cut short
+    for (const auto& [name, output] : SpanOutputs) {
+        std::array<wchar_t, MaxOutputLength> buf;
+        auto half = (expected.*output)(buf) / 2;
+        for (auto room : {MaxOutputLength, half}) {
+            auto expectedSpan = FormatSpanOutput(expected, output, room);
+            auto actualSpan = FormatSpanOutput(actual, output, room);
+            if (expectedSpan != actualSpan) {
+                return std::wstring(name) + L" span of " + std::to_wstring(room) + L" '" + expectedSpan + L"' vs '" +
+                       actualSpan + L"'";
+            }
+        }
+    }
+    return std::wstring();
+}
+
+class DiffRunner {
+public:
+    DiffRunner(const TelexConfig& config, EngineFactory expected, EngineFactory actual)
+        : _config(config), _expected(std::move(expected)), _actual(std::move(actual)) {
+    }
+
+    // runs the ops on fresh engines and returns the index of the first op after which they differ
+    std::optional<size_t> Run(const DiffOps& ops, _Out_ std::wstring* what = nullptr) {
+        auto expected = _expected(_config);
+        auto actual = _actual(_config);
+        for (size_t i = 0; i < ops.size(); i++) {
+            auto expectedResult = Apply(*expected, ops[i]);
+            auto actualResult = Apply(*actual, ops[i]);
+            _checks++;
+            auto diff = expectedResult == actualResult
+                            ? Difference(*expected, *actual)
+                            : L"result " + std::to_wstring(static_cast<int>(expectedResult)) + L" vs " +
+                                  std::to_wstring(static_cast<int>(actualResult));
+            if (!diff.empty()) {
+                if (what) {
+                    *what = std::move(diff);
+                }
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // runs the ops and reports the first mismatch with the ops reduced to a minimal failing sequence;
+    // returns false on a mismatch
+    bool Check(const DiffOps& ops) {
+        auto failed = Run(ops);
+        if (!failed) {
+            return true;
+        }
+        DiffOps minimized(ops.begin(), ops.begin() + *failed + 1);
+        // drop single ops until every remaining one is needed to make the engines differ
+        bool shrunk = true;
+        while (shrunk) {
+            shrunk = false;
+            for (size_t i = minimized.size(); i-- > 0;) {
+                if (i >= minimized.size()) {
+                    continue;
+                }
+                auto candidate = minimized;
+                candidate.erase(candidate.begin() + i);
+                if (auto f = Run(candidate)) {
+                    candidate.resize(*f + 1);
+                    minimized = std::move(candidate);
+                    shrunk = true;
+                }
+            }
+        }
+        std::wstring what;
+        Run(minimized, &what);
+        wprintf(L"mismatch: %s\n    minimized: %s\n    %s\n", FormatOps(ops).c_str(), FormatOps(minimized).c_str(),
+                what.c_str());
+        return false;
+    }
+
+    uint64_t Checks() const {
+        return _checks;
+    }
+
+private:
+    TelexConfig _config;
+    EngineFactory _expected;
+    EngineFactory _actual;
+    uint64_t _checks = 0;
+};
+
+static DiffOps TypeWord(std::wstring_view keys) {
+    DiffOps ops;
+    for (auto c : keys) {
+        ops.push_back({DiffOpKind::Push, c});
+    }
+    return ops;
+}
+
+// every lowercase key sequence of maxLen keys, each finished off with Commit, ForceCommit, Cancel or a few Backspaces
+static bool DiffExhaustive(DiffRunner& runner, DiffOps& prefix, size_t maxLen) {
+    static const std::vector<DiffOps> endings{
+        {{DiffOpKind::Commit}},
+        {{DiffOpKind::ForceCommit}},
+        {{DiffOpKind::Cancel}},
+        {{DiffOpKind::Backspace}, {DiffOpKind::Commit}},
+        {{DiffOpKind::Backspace}, {DiffOpKind::Backspace}, {DiffOpKind::Backspace}},
+    };
+    for (wchar_t c = L'a'; c <= L'z'; c++) {
+        prefix.push_back({DiffOpKind::Push, c});
+        if (prefix.size() == maxLen) {
+            for (const auto& ending : endings) {
+                auto ops = prefix;
+                ops.insert(ops.end(), ending.begin(), ending.end());
+                if (!runner.Check(ops)) {
+                    return false;
+                }
+            }
+        } else if (!DiffExhaustive(runner, prefix, maxLen)) {
+            return false;
+        }
+        prefix.pop_back();
+    }
+    return true;
+}
+
+static DiffOps RandomWalk(std::mt19937& rng, const std::vector<std::wstring>& words) {
+    static constexpr std::wstring_view keys = L"abcdefghijklmnopqrstuvwxyzAEIOUWDSFRXJZ1\x1b0\x1ea1";
+    DiffOps ops;
+    if (rng() % 4 == 0 && !words.empty()) {
+        ops.push_back({DiffOpKind::Backconvert, 0, words[rng() % words.size()]});
+    }
+    auto len = 1 + rng() % 20;
+    for (size_t i = 0; i < len; i++) {
+        auto r = rng() % 32;
+        if (r < 22) {
+            ops.push_back({DiffOpKind::Push, keys[rng() % keys.size()]});
+        } else if (r < 27) {
+            ops.push_back({DiffOpKind::Backspace});
+        } else if (r < 28) {
+            ops.push_back({DiffOpKind::Commit});
+        } else if (r < 29) {
+            ops.push_back({DiffOpKind::ForceCommit});
+        } else if (r < 30) {
+            ops.push_back({DiffOpKind::Cancel});
+        } else {
+            ops.push_back({DiffOpKind::Reset});
+        }
+    }
+    return ops;
+}
+
+static EngineFactory MakeFactory(std::wstring_view kind, const std::optional<TelexDfa>& dfa) {
+    if (kind == L"dfa") {
+        return [&dfa](const TelexConfig&) { return std::make_unique<TelexDfaEngine>(*dfa); };
+    } else if (kind == L"cache") {
+        return [](const TelexConfig& c) {
+            auto cached = c;
+            cached.commit_cache_size = 256;
+            return std::unique_ptr<ITelexEngine>(TelexNewDynamic(cached));
+        };
+    } else if (kind == L"fixed") {
+        return [](const TelexConfig& c) { return std::unique_ptr<ITelexEngine>(TelexNew(c)); };
+    } else {
+        return [](const TelexConfig& c) { return std::unique_ptr<ITelexEngine>(TelexNewDynamic(c)); };
+    }
+}
+
+bool difffuzz(const wchar_t* expectedKind, const wchar_t* actualKind, size_t maxLen, size_t walks) {
+    for (auto kind : {expectedKind, actualKind}) {
+        if (std::find(std::begin(EngineKinds), std::end(EngineKinds), kind) == std::end(EngineKinds)) {
+            wprintf(L"unknown engine %s\n", kind);
+            return false;
+        }
+    }
+    auto vwords = LoadWordList(L"..\\..\\data\\vw39kw.txt");
+    auto ewords = LoadWordList(L"..\\..\\data\\ewdsw.txt");
+
+    auto needDfa = !wcscmp(expectedKind, L"dfa") || !wcscmp(actualKind, L"dfa");
+    std::vector<std::wstring> seeds;
+    if (needDfa) {
+        TelexEngine engine(TelexConfig{});
+        for (const auto& word : vwords) {
+            engine.Reset();
+            if (engine.Backconvert(word) == TelexStates::Valid) {
+                seeds.push_back(engine.RetrieveRaw());
+            }
+        }
+    }
+
+    bool ok = true;
+    for (int flags = 0; flags < 64; flags++) {
+        TelexConfig config;
+        config.oa_uy_tone1 = !!(flags & 1);
+        config.accept_separate_dd = !!(flags & 2);
+        config.backspaced_word_stays_invalid = !!(flags & 4);
+        config.autocorrect = !!(flags & 8);
+        config.optimize_multilang = flags >> 4;
+
+        std::optional<TelexDfa> dfa;
+        if (needDfa) {
+            size_t unminimized;
+            dfa = TelexDfa::Build(config, seeds, &unminimized);
+        }
+
+        DiffRunner runner(config, MakeFactory(expectedKind, dfa), MakeFactory(actualKind, dfa));
+        // each source stops at its first mismatch, the later ones would mostly repeat it
+        DiffOps prefix;
+        auto same = DiffExhaustive(runner, prefix, maxLen);
+        std::mt19937 rng(flags);
+        for (size_t i = 0; same && i < walks; i++) {
+            same = runner.Check(RandomWalk(rng, vwords));
+        }
+        for (size_t i = 0; same && i < vwords.size(); i++) {
+            DiffOps ops{{DiffOpKind::Backconvert, 0, vwords[i]}, {DiffOpKind::Backspace}, {DiffOpKind::Commit}};
+            same = runner.Check(ops);
+        }
+        for (size_t i = 0; same && i < ewords.size(); i++) {
+            auto ops = TypeWord(ewords[i]);
+            ops.push_back({DiffOpKind::Commit});
+            same = runner.Check(ops);
+        }
+        wprintf(
+            L"oa_uy_tone1 = %d, accept_separate_dd = %d, backspaced_word_stays_invalid = %d, autocorrect = %d, "
+            L"optimize_multilang = %lu: %llu checks, %s\n",
+            config.oa_uy_tone1,
+            config.accept_separate_dd,
+            config.backspaced_word_stays_invalid,
+            config.autocorrect,
+            config.optimize_multilang,
+            static_cast<unsigned long long>(runner.Checks()),
+            same ? L"same" : L"MISMATCH");
+        ok = ok && same;
+    }
+    return ok;
+}
@@ -20,17 +20,17 @@ bool dualscan(int mode) {
     std::set<std::wstring> vwordset;
     {
         LONGLONG vfsize;
-        auto vwords = static_cast<wchar_t*>(ReadWholeFile(L"..\\..\\data\\vw39kw.txt", &vfsize));
-        auto vwend = vwords + vfsize / sizeof(wchar_t);
-        for (WordListIterator vw(vwords, vwend); vw != vwend; vw++) {
-            vwordset.insert(std::wstring(*vw, vw.wlen()));
+        auto vwords = static_cast<char16_t*>(ReadWholeFile(L"..\\..\\data\\vw39kw.txt", &vfsize));
+        auto vwend = vwords + vfsize / sizeof(char16_t);
+        for (Utf16WordListIterator vw(vwords, vwend); vw != vwend; vw++) {
+            vwordset.emplace(vw.wstr());
         }
         FreeFile(vwords);
     }
 
     LONGLONG efsize;
-    auto ewords = static_cast<wchar_t*>(ReadWholeFile(L"..\\..\\data\\ewdsw.txt", &efsize));
-    auto ewend = ewords + efsize / sizeof(wchar_t);
+    auto ewords = static_cast<char16_t*>(ReadWholeFile(L"..\\..\\data\\ewdsw.txt", &efsize));
+    auto ewend = ewords + efsize / sizeof(char16_t);
     TelexConfig config;
     switch (mode) {
     case WlistEn2:
@@ -43,8 +43,8 @@ bool dualscan(int mode) {
         break;
     }
     TelexEngine engine(config);
-    for (WordListIterator ew(ewords, ewend); ew != ewend; ew++) {
-        std::wstring eword(*ew, ew.wlen());
+    for (Utf16WordListIterator ew(ewords, ewend); ew != ewend; ew++) {
+        std::wstring eword(ew.wstr());
         engine.Reset();
         for (auto c : eword) {
             engine.PushChar(c);
@@ -52,13 +52,14 @@ bool dualscan(int mode) {
         if (engine.Commit() == TelexStates::Committed) {
             auto outword = engine.Retrieve();
             switch (mode) {
-            case WlistEn2:
+            case WlistEn2: {
+                auto respos = engine.GetRespos();
                 if (vwordset.find(outword) == vwordset.end() &&
-                    std::any_of(
-                        engine.GetRespos().begin(), engine.GetRespos().end(), [](auto x) { return x & ~ResposMask; })) {
+                    std::any_of(respos.begin(), respos.end(), [](auto x) { return x & ~ResposMask; })) {
                     wprintf(L"%s\n", eword.c_str());
                 }
                 break;
+            }
             case WlistEnAc:
                 if (engine.IsAutocorrected()) {
                     wprintf(L"%s\n", eword.c_str());
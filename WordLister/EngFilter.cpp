@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Telex.h"
+#include "WordListIterator.hpp"
+#include "FileUtil.hpp"
+#include "TelexEngine.h"
+#include "TelexWordFilter.h"
+
+using namespace VietType::Telex;
+using namespace VietType::TestLib;
+
+// only the words that would otherwise be committed as Vietnamese need to be in the filter
+static bool CommitsValid(TelexEngine& engine, std::wstring_view word) {
+    engine.Reset();
+    for (auto c : word) {
+        engine.PushChar(c);
+    }
+    return engine.Commit() == TelexStates::Committed;
+}
+
+bool engfilter(const wchar_t* wordlist, const wchar_t* filename) {
+    LONGLONG fsize;
+    auto words = static_cast<char16_t*>(ReadWholeFile(wordlist, &fsize));
+    auto wend = words + fsize / sizeof(char16_t);
+
+    TelexConfig config;
+    config.optimize_multilang = 0;
+    TelexEngine plain(config);
+    config.autocorrect = true;
+    TelexEngine autocorrect(config);
+
+    size_t total = 0;
+    std::vector<std::wstring> kept;
+    for (Utf16WordListIterator w(words, wend); w != wend; w++) {
+        std::wstring word(w.wstr());
+        if (word.empty()) {
+            continue;
+        }
+        total++;
+        if (CommitsValid(plain, word) || CommitsValid(autocorrect, word)) {
+            kept.push_back(std::move(word));
+        }
+    }
+    FreeFile(words);
+    std::vector<std::wstring_view> keptViews(kept.begin(), kept.end());
+    auto filter = WordFilter::Build(keptViews);
+
+    wprintf(L"words = %zu, kept = %zu, filter = %zu\n", total, kept.size(), filter.Count());
+    FILE* f = nullptr;
+    bool ok = !_wfopen_s(&f, filename, L"wb") && filter.Save(f);
+    if (f) {
+        ok = !fclose(f) && ok;
+    }
+    if (!ok) {
+        wprintf(L"cannot write %s\n", filename);
+    }
+    return ok;
+}
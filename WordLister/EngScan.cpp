@@ -20,27 +20,25 @@ static TelexStates TestWord(TelexEngine& e, const wchar_t* input) {
 
 bool engscan(const wchar_t* filename) {
     LONGLONG fsize;
-    auto words = static_cast<wchar_t*>(ReadWholeFile(filename, &fsize));
-    auto wend = words + fsize / sizeof(wchar_t);
+    auto words = static_cast<char16_t*>(ReadWholeFile(filename, &fsize));
+    auto wend = words + fsize / sizeof(char16_t);
 
     TelexConfig config;
     config.optimize_multilang = 0;
     TelexEngine engine(config);
-    for (WordListIterator w(words, wend); w != wend; w++) {
-        std::wstring word(*w, w.wlen());
+    for (Utf16WordListIterator w(words, wend); w != wend; w++) {
+        std::wstring word(w.wstr());
 
         auto state = TestWord(engine, word.c_str());
+        auto respos = engine.GetRespos();
         if (state == TelexStates::Committed && engine.GetTone() != Tones::Z) {
             const wchar_t* wordclass = L"";
-            if (std::count_if(
-                    engine.GetRespos().begin(), engine.GetRespos().end(), [](auto x) { return x & ResposTone; }) > 1)
+            if (std::count_if(respos.begin(), respos.end(), [](auto x) { return x & ResposTone; }) > 1)
                 wordclass = L"DoubleTone";
-            else if (!(*engine.GetRespos().rbegin() & ResposTone))
+            else if (!(*respos.rbegin() & ResposTone))
                 wordclass = L"ToneNotEnd";
             wprintf(L"%s %s\n", word.c_str(), wordclass);
-        } else if (std::any_of(engine.GetRespos().begin(), engine.GetRespos().end(), [](auto x) {
-                       return x & ResposDoubleUndo;
-                   })) {
+        } else if (std::any_of(respos.begin(), respos.end(), [](auto x) { return x & ResposDoubleUndo; })) {
             wprintf(L"%s %s\n", word.c_str(), L"DoubleUndo");
         }
     }
@@ -2,64 +2,315 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "stdafx.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <thread>
+#include <unordered_set>
+#include <vector>
 #include "Telex.h"
 #include "TelexEngine.h"
+#include "TelexDfa.h"
 
 using namespace VietType::Telex;
 
-static void DoFuzz(int len, wchar_t start = 0) {
-    for (int level = 0; level <= 3; level++) {
-        for (int autocorrect = 0; autocorrect <= 1; autocorrect++) {
-            wprintf(L"len %d level %d autocorrect %d\n", len, level, autocorrect);
-            TelexConfig config;
-            config.optimize_multilang = level;
-            config.autocorrect = !!autocorrect;
-            TelexEngine e(config);
-            size_t max = 1;
-            for (auto i = start ? 1 : 0; i < len; i++) {
-                max *= 26;
+struct FuzzStats {
+    uint64_t nodes = 0;
+    uint64_t pruned = 0;
+    uint64_t merged = 0;
+    uint64_t failures = 0;
+
+    FuzzStats& operator+=(const FuzzStats& other) {
+        nodes += other.nodes;
+        pruned += other.pruned;
+        merged += other.merged;
+        failures += other.failures;
+        return *this;
+    }
+};
+
+// Transposition table of the Valid states already expanded, shared by all workers.
+// States are told apart by FuzzStateKey, which holds the number of keys typed, so every word reaching a state has as
+// many keys left below it and the state is expanded only once.
+class FuzzMemo {
+public:
+    // true if the caller should expand the state
+    bool Insert(std::wstring key) {
+        auto& shard = _shards[std::hash<std::wstring>{}(key) % _shards.size()];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.states.insert(std::move(key)).second;
+    }
+
+    size_t Count() {
+        size_t count = 0;
+        for (auto& shard : _shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            count += shard.states.size();
+        }
+        return count;
+    }
+
+private:
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_set<std::wstring> states;
+    };
+    std::array<Shard, 64> _shards;
+};
+
+// a Valid word whose children are still to be visited
+struct FuzzTask {
+    TelexEngine engine;
+    std::wstring word;
+};
+
+// Work-stealing pool: every worker pushes and pops subtrees at the back of its own deque, and an idle worker steals
+// from the front of the others, where the oldest and therefore largest subtrees are.
+// Workers only hand out subtrees while the deques run low, and walk them in place otherwise.
+class FuzzScheduler {
+public:
+    explicit FuzzScheduler(size_t workers) : _queues(workers) {
+    }
+
+    // enough subtrees are queued to keep the idle workers busy
+    bool Hungry() const {
+        return _queued.load(std::memory_order_relaxed) < _queues.size();
+    }
+
+    void Push(size_t worker, FuzzTask task) {
+        _pending.fetch_add(1, std::memory_order_relaxed);
+        _queued.fetch_add(1, std::memory_order_relaxed);
+        {
+            auto& q = _queues[worker];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.tasks.push_back(std::move(task));
+        }
+        // wake the idle workers, only done while the deques run low
+        std::lock_guard<std::mutex> lock(_doneMutex);
+        _doneCv.notify_all();
+    }
+
+    // nullopt once every task has finished
+    std::optional<FuzzTask> Pop(size_t worker) {
+        while (true) {
+            if (auto task = TryPop(worker)) {
+                return task;
+            }
+            std::unique_lock<std::mutex> lock(_doneMutex);
+            _doneCv.wait(lock, [this] {
+                return _queued.load(std::memory_order_relaxed) || !_pending.load(std::memory_order_acquire);
+            });
+            if (!_pending.load(std::memory_order_acquire)) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    // called once a task from Pop has been walked, including any subtrees it walked in place
+    void Done() {
+        if (_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(_doneMutex);
+            _doneCv.notify_all();
+        }
+    }
+
+    // wait until every task has finished or the timeout passes, true if finished
+    template <typename Rep, typename Period>
+    bool WaitFor(std::chrono::duration<Rep, Period> timeout) {
+        std::unique_lock<std::mutex> lock(_doneMutex);
+        return _doneCv.wait_for(lock, timeout, [this] { return !_pending.load(std::memory_order_acquire); });
+    }
+
+private:
+    std::optional<FuzzTask> TryPop(size_t worker) {
+        {
+            auto& q = _queues[worker];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.tasks.empty()) {
+                auto task = std::move(q.tasks.back());
+                q.tasks.pop_back();
+                _queued.fetch_sub(1, std::memory_order_relaxed);
+                return task;
             }
-            for (size_t i = 0; i < max; i++) {
-                std::wstring word(len, start ? start : L'a');
-                size_t cur = i;
-                for (auto j = start ? 1 : 0; j < len; j++) {
-                    word[j] = L'a' + cur % 26;
-                    cur /= 26;
-                }
-                e.Reset();
-                for (auto c : word) {
-                    e.PushChar(c);
-                }
-                if (!e.CheckInvariants()) {
-                    wprintf(L"word failed: %s\n", word.c_str());
-                }
-                e.Commit();
-                if (!e.CheckInvariants()) {
-                    wprintf(L"word failed commit: %s\n", word.c_str());
-                }
+        }
+        for (size_t i = 1; i < _queues.size(); i++) {
+            auto& q = _queues[(worker + i) % _queues.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.tasks.empty()) {
+                auto task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+                _queued.fetch_sub(1, std::memory_order_relaxed);
+                return task;
             }
         }
+        return std::nullopt;
+    }
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<FuzzTask> tasks;
+    };
+    std::vector<Queue> _queues;
+    // tasks pushed but not finished yet
+    std::atomic<size_t> _pending = 0;
+    std::atomic<size_t> _queued = 0;
+    std::mutex _doneMutex;
+    std::condition_variable _doneCv;
+};
+
+// subtrees this close to the length limit are too small to be worth handing to another worker
+static constexpr size_t MinSharedKeys = 3;
+
+struct FuzzWorker {
+    FuzzWorker(size_t index, size_t maxLen, FuzzMemo& memo, FuzzScheduler& scheduler)
+        : index(index), maxLen(maxLen), memo(memo), scheduler(scheduler) {
+    }
+
+    size_t index;
+    size_t maxLen;
+    FuzzMemo& memo;
+    FuzzScheduler& scheduler;
+    FuzzStats stats;
+    // stats.nodes as seen by the progress report
+    std::atomic<uint64_t> progress = 0;
+};
+
+static void FuzzNode(FuzzWorker& w, const TelexEngine& parent, std::wstring& word);
+
+// TelexStateKey without outputs decides what later keys do, but CheckInvariants also reads the word length, every
+// respos and the case bits, so two states only merge if those match as well
+static std::wstring FuzzStateKey(const TelexEngine& e) {
+    auto key = TelexStateKey(e, false);
+    key.push_back(L'|');
+    key.push_back(static_cast<wchar_t>(e.Count()));
+    for (auto rp : e.GetRespos()) {
+        key.push_back(static_cast<wchar_t>(rp));
+    }
+    auto cases = e.GetCases();
+    key.push_back(static_cast<wchar_t>(cases.size()));
+    key.push_back(static_cast<wchar_t>(cases.bits() & 0xffff));
+    key.push_back(static_cast<wchar_t>(cases.bits() >> 16));
+    return key;
+}
+
+// Push `c` onto a copy of `parent`, check it, then visit every key sequence below it depth-first.
+// Invalid is absorbing: once a prefix goes Invalid, every key after it only appends to the raw buffer, so the
+// subtree below it is checked once at its root and then skipped.
+static void FuzzKey(FuzzWorker& w, const TelexEngine& parent, wchar_t c, std::wstring& word) {
+    TelexEngine e(parent);
+    word.push_back(c);
+    auto state = e.PushChar(c);
+    if (!(++w.stats.nodes & 0xfff)) {
+        w.progress.store(w.stats.nodes, std::memory_order_relaxed);
+    }
+    if (!e.CheckInvariants()) {
+        wprintf(L"word failed: %s\n", word.c_str());
+        w.stats.failures++;
+    }
+    if (state != TelexStates::Valid) {
+        w.stats.pruned++;
+    } else if (word.size() < w.maxLen) {
+        if (!w.memo.Insert(FuzzStateKey(e))) {
+            w.stats.merged++;
+        } else if (w.maxLen - word.size() >= MinSharedKeys && w.scheduler.Hungry()) {
+            w.scheduler.Push(w.index, FuzzTask{e, word});
+        } else {
+            FuzzNode(w, e, word);
+        }
+    }
+    // the children are done with this engine (or have their own copy), so commit it in place
+    e.Commit();
+    if (!e.CheckInvariants()) {
+        wprintf(L"word failed commit: %s\n", word.c_str());
+        w.stats.failures++;
+    }
+    word.pop_back();
+}
+
+static void FuzzNode(FuzzWorker& w, const TelexEngine& parent, std::wstring& word) {
+    for (wchar_t c = L'a'; c <= L'z'; c++) {
+        FuzzKey(w, parent, c, word);
     }
 }
 
-static void DoFuzzThreaded(int len) {
-    std::vector<std::thread> workers;
-    for (wchar_t i = L'a'; i <= L'z'; i++) {
-        workers.emplace_back(DoFuzz, len, i);
+static void FuzzWorkerMain(FuzzWorker& w) {
+    while (auto task = w.scheduler.Pop(w.index)) {
+        FuzzNode(w, task->engine, task->word);
+        w.scheduler.Done();
     }
-    for (auto& w : workers)
-        w.join();
+    w.progress.store(w.stats.nodes, std::memory_order_relaxed);
 }
 
-bool fuzz() {
-    SetPriorityClass(GetCurrentProcess(), IDLE_PRIORITY_CLASS);
-    SetThreadExecutionState(ES_SYSTEM_REQUIRED | ES_CONTINUOUS);
-    for (auto len = 1; len <= 4; len++) {
-        DoFuzz(len);
+static FuzzStats DoFuzzThreaded(const TelexConfig& config, size_t maxLen, FuzzMemo& memo) {
+    auto threads = std::max(std::thread::hardware_concurrency(), 1u);
+    FuzzScheduler scheduler(threads);
+    std::vector<std::unique_ptr<FuzzWorker>> workers;
+    for (size_t i = 0; i < threads; i++) {
+        workers.push_back(std::make_unique<FuzzWorker>(i, maxLen, memo, scheduler));
+    }
+    scheduler.Push(0, FuzzTask{TelexEngine(config), std::wstring()});
+
+    std::vector<std::thread> pool;
+    for (auto& w : workers) {
+        pool.emplace_back(FuzzWorkerMain, std::ref(*w));
+    }
+    auto start = std::chrono::steady_clock::now();
+    while (!scheduler.WaitFor(std::chrono::seconds(10))) {
+        uint64_t nodes = 0;
+        for (const auto& w : workers) {
+            nodes += w->progress.load(std::memory_order_relaxed);
+        }
+        auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        wprintf(
+            L"  %.0f s: %llu nodes, %.0f nodes/s, %zu states\n",
+            seconds,
+            static_cast<unsigned long long>(nodes),
+            nodes / seconds,
+            memo.Count());
+    }
+    for (auto& t : pool)
+        t.join();
+
+    FuzzStats total;
+    for (const auto& w : workers) {
+        total += w->stats;
     }
-    for (auto len = 5; len <= 7; len++) {
-        DoFuzzThreaded(len);
+    return total;
+}
+
+bool fuzz(size_t maxLen) {
+    uint64_t failures = 0;
+    for (int level = 0; level <= 3; level++) {
+        for (int autocorrect = 0; autocorrect <= 1; autocorrect++) {
+            TelexConfig config;
+            config.optimize_multilang = level;
+            config.autocorrect = !!autocorrect;
+            FuzzMemo memo;
+            auto t1 = std::chrono::steady_clock::now();
+            auto stats = DoFuzzThreaded(config, maxLen, memo);
+            auto t2 = std::chrono::steady_clock::now();
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+            wprintf(
+                L"len %zu level %d autocorrect %d: %zu unique states, %llu nodes, %llu pruned, %llu merged, "
+                L"%llu failures, %lld ms, %.0f nodes/s\n",
+                maxLen,
+                level,
+                autocorrect,
+                memo.Count(),
+                static_cast<unsigned long long>(stats.nodes),
+                static_cast<unsigned long long>(stats.pruned),
+                static_cast<unsigned long long>(stats.merged),
+                static_cast<unsigned long long>(stats.failures),
+                static_cast<long long>(ms),
+                stats.nodes * 1000.0 / std::max<long long>(ms, 1));
+            failures += stats.failures;
+        }
     }
-    return true;
+    return !failures;
 }
@@ -0,0 +1,457 @@
+// SPDX-FileCopyrightText: Copyright (c) 2026 Dinh Ngoc Tu
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "stdafx.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "Telex.h"
+#include "TelexAutocorrect.h"
+#include "TelexData.h"
+#include "TelexEngine.h"
+#include "FileUtil.hpp"
+
+using namespace VietType::Telex;
+using namespace VietType::TestLib;
+
+#ifdef _DEBUG
+#define OPWARMUP 1
+#define OPREPS 5
+#define OPCASES 128
+#else
+#define OPWARMUP 3
+#define OPREPS 31
+#define OPCASES 512
+#endif
+
+// a median this much slower than the baseline, and well outside the noise of both runs, is a regression;
+// the cheapest operations take a few ns, where timer and restore jitter alone exceed any relative tolerance
+static constexpr double RegressionTolerance = 0.10;
+static constexpr double RegressionMads = 3.0;
+static constexpr double RegressionFloorNs = 10.0;
+
+struct OpStats {
+    size_t cases = 0;
+    size_t reps = 0;
+    double min = 0;
+    double median = 0;
+    double mean = 0;
+    double stddev = 0;
+    // median absolute deviation from the median
+    double mad = 0;
+};
+
+static OpStats Summarize(std::vector<double> samples, size_t cases) {
+    OpStats stats;
+    stats.cases = cases;
+    stats.reps = samples.size();
+    if (samples.empty()) {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto median = [](const std::vector<double>& sorted) {
+        auto n = sorted.size();
+        return n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+    };
+    stats.min = samples.front();
+    stats.median = median(samples);
+    for (auto s : samples) {
+        stats.mean += s;
+    }
+    stats.mean /= static_cast<double>(samples.size());
+    for (auto s : samples) {
+        stats.stddev += (s - stats.mean) * (s - stats.mean);
+    }
+    stats.stddev = std::sqrt(stats.stddev / static_cast<double>(samples.size()));
+    std::vector<double> deviations;
+    for (auto s : samples) {
+        deviations.push_back(std::abs(s - stats.median));
+    }
+    std::sort(deviations.begin(), deviations.end());
+    stats.mad = median(deviations);
+    return stats;
+}
+
+static void* volatile escaped;
+
+// keeps the compiler from dropping the copies and calls whose results are otherwise unused
+template <typename T>
+static void Escape(T& value) {
+    escaped = &value;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+// engines captured right before the operation, and the key or text each one is given;
+// the engine TelexNew returns cannot be copied through ITelexEngine, so it is given the same words as snapshots
+struct OpCases {
+    std::vector<TelexEngine> before;
+    std::vector<TelexSnapshot> snapshots;
+    std::vector<std::wstring> args;
+
+    // false if the word is too long for a snapshot
+    bool Add(TelexEngine e, std::wstring arg) {
+        TelexSnapshot snapshot;
+        if (!e.SaveSnapshot(snapshot)) {
+            return false;
+        }
+        before.push_back(std::move(e));
+        snapshots.push_back(snapshot);
+        args.push_back(std::move(arg));
+        return true;
+    }
+};
+
+// Every repetition restores each case into `work`, once on its own and once followed by the operation.
+// The fastest restore-only pass is taken off every sample so that the time per operation leaves out the restore
+// without adding the noise of a second measurement to each sample.
+template <typename Engine, typename Restore, typename Op>
+static OpStats Measure(const OpCases& cases, Engine& work, Restore restore, Op op) {
+    if (cases.before.empty()) {
+        return OpStats{};
+    }
+    unsigned long long checksum = 0;
+    auto n = static_cast<double>(cases.before.size());
+    double restoreTime = HUGE_VAL;
+    std::vector<double> samples;
+    for (auto rep = 0; rep < OPWARMUP + OPREPS; rep++) {
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < cases.before.size(); i++) {
+            restore(work, i);
+            Escape(work);
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < cases.before.size(); i++) {
+            restore(work, i);
+            checksum += op(work, cases.args[i]);
+            Escape(work);
+        }
+        auto t3 = std::chrono::high_resolution_clock::now();
+        if (rep >= OPWARMUP) {
+            restoreTime = std::min(restoreTime, std::chrono::duration<double, std::nano>(t2 - t1).count() / n);
+            samples.push_back(std::chrono::duration<double, std::nano>(t3 - t2).count() / n);
+        }
+    }
+    Escape(checksum);
+    for (auto& s : samples) {
+        s = std::max(s - restoreTime, 0.0);
+    }
+    return Summarize(std::move(samples), cases.before.size());
+}
+
+static TelexEngine TypeKeys(const TelexConfig& config, std::wstring_view keys) {
+    TelexEngine e(config);
+    for (auto c : keys) {
+        e.PushChar(c);
+    }
+    return e;
+}
+
+// config, engine and operation
+using OpResults = std::map<std::tuple<std::wstring, std::wstring, std::wstring>, OpStats>;
+
+// the dynamic TelexEngine, restored by copying
+static OpStats MeasureDynamic(const OpCases& cases, auto op) {
+    if (cases.before.empty()) {
+        return OpStats{};
+    }
+    TelexEngine work(cases.before.front());
+    return Measure(cases, work, [&](TelexEngine& e, size_t i) { e = cases.before[i]; }, op);
+}
+
+// the engine TelexNew returns for the config, called through ITelexEngine as the IME does
+static OpStats MeasureNew(const TelexConfig& config, const OpCases& cases, auto op) {
+    std::unique_ptr<ITelexEngine> work(TelexNew(config));
+    return Measure(cases, *work, [&](ITelexEngine& e, size_t i) { e.RestoreSnapshot(cases.snapshots[i]); }, op);
+}
+
+static void BenchConfig(
+    const TelexConfig& config,
+    const std::wstring& name,
+    const std::vector<std::wstring>& vwords,
+    const std::vector<std::wstring>& vkeys,
+    const std::vector<std::wstring>& ewords,
+    OpResults& results) {
+    std::mt19937 rng(12345);
+    OpCases push, valid, invalid, fresh;
+    for (size_t i = 0; i < OPCASES && !vkeys.empty(); i++) {
+        const auto& keys = vkeys[rng() % vkeys.size()];
+        auto typed = rng() % keys.size();
+        push.Add(TypeKeys(config, std::wstring_view(keys).substr(0, typed)), keys.substr(typed, 1));
+        valid.Add(TypeKeys(config, keys), keys);
+        fresh.Add(TelexEngine(config), vwords[rng() % vwords.size()]);
+    }
+    for (size_t tries = 0; invalid.before.size() < OPCASES && tries < OPCASES * 100 && !ewords.empty(); tries++) {
+        const auto& word = ewords[rng() % ewords.size()];
+        auto e = TypeKeys(config, word);
+        if (e.GetState() == TelexStates::Invalid) {
+            invalid.Add(std::move(e), word);
+        }
+    }
+
+    // every operation on both engines, with the engine TelexNew returns as an extra column
+    auto record = [&](const wchar_t* op, const OpCases& cases, auto fn) {
+        auto dynamic = MeasureDynamic(cases, fn);
+        auto fixed = MeasureNew(config, cases, fn);
+        wprintf(
+            L"  %s %s: cases = %zu, median = %.1f ns, min = %.1f ns, mean = %.1f ns, stddev = %.1f ns, mad = %.1f ns, "
+            L"TelexNew median = %.1f ns, mad = %.1f ns\n",
+            name.c_str(),
+            op,
+            dynamic.cases,
+            dynamic.median,
+            dynamic.min,
+            dynamic.mean,
+            dynamic.stddev,
+            dynamic.mad,
+            fixed.median,
+            fixed.mad);
+        results[{name, L"dynamic", op}] = dynamic;
+        results[{name, L"new", op}] = fixed;
+    };
+    record(L"PushChar", push, [](auto& e, const std::wstring& arg) {
+        return static_cast<unsigned>(e.PushChar(arg[0]));
+    });
+    record(L"Peek", valid, [](auto& e, const std::wstring&) {
+        std::array<wchar_t, MaxOutputLength> buf;
+        return static_cast<unsigned>(e.Peek(buf));
+    });
+    record(L"BackspaceValid", valid, [](auto& e, const std::wstring&) {
+        return static_cast<unsigned>(e.Backspace());
+    });
+    record(L"BackspaceInvalid", invalid, [](auto& e, const std::wstring&) {
+        return static_cast<unsigned>(e.Backspace());
+    });
+    record(L"Commit", valid, [](auto& e, const std::wstring&) {
+        return static_cast<unsigned>(e.Commit());
+    });
+    record(L"ForceCommit", valid, [](auto& e, const std::wstring&) {
+        return static_cast<unsigned>(e.ForceCommit());
+    });
+    record(L"Cancel", valid, [](auto& e, const std::wstring&) {
+        return static_cast<unsigned>(e.Cancel());
+    });
+    record(L"Backconvert", fresh, [](auto& e, const std::wstring& arg) {
+        return static_cast<unsigned>(e.Backconvert(arg));
+    });
+}
+
+// rules over the parts of real syllables that rewrite a part to itself, so they match and apply as often as real rules
+// would without changing what Commit returns
+static std::vector<AutocorrectRule> MakeIdentityRules(size_t count) {
+    std::vector<std::wstring_view> c1s(valid_c1.begin(), valid_c1.end());
+    std::vector<std::wstring_view> vs, c2s;
+    for (const auto& [v, vinfo] : valid_v) {
+        vs.push_back(v);
+    }
+    for (const auto& [c2, restricted] : valid_c2) {
+        c2s.push_back(c2);
+    }
+    std::mt19937 rng(12345);
+    std::vector<AutocorrectRule> rules;
+    for (size_t i = 0; i < count; i++) {
+        AutocorrectRule r;
+        r.c1 = rng() % 4 ? c1s[rng() % c1s.size()] : AutocorrectRule::Any;
+        r.v = vs[rng() % vs.size()];
+        r.c2 = rng() % 4 ? c2s[rng() % c2s.size()] : AutocorrectRule::Any;
+        r.tones = static_cast<uint8_t>(1 + rng() % AutocorrectRule::AllTones);
+        r.conditions = static_cast<uint8_t>(rng() % 8);
+        if (rng() % 2 || r.c2 == AutocorrectRule::Any) {
+            r.newV = r.v;
+        } else {
+            r.newC2 = r.c2;
+        }
+        rules.push_back(r);
+    }
+    return rules;
+}
+
+// Commit with more and more rules on top of the built-in ones, which should cost the same throughout
+static void BenchAutocorrectRules(const std::vector<std::wstring>& vkeys, OpResults& results) {
+    auto builtin = AutocorrectRules::BuiltinRules();
+    for (size_t extra : {0, 64, 512, 4096}) {
+        std::vector<AutocorrectRule> list(builtin.begin(), builtin.end());
+        auto identity = MakeIdentityRules(extra);
+        list.insert(list.end(), identity.begin(), identity.end());
+        auto rules = AutocorrectRules::Compile(list);
+
+        TelexConfig config;
+        config.autocorrect = true;
+        config.autocorrect_rules = &rules;
+        std::mt19937 rng(12345);
+        OpCases valid;
+        for (size_t i = 0; i < OPCASES; i++) {
+            const auto& keys = vkeys[rng() % vkeys.size()];
+            valid.Add(TypeKeys(config, keys), keys);
+        }
+        auto stats = MeasureDynamic(valid, [](TelexEngine& e, const std::wstring&) {
+            return static_cast<unsigned>(e.Commit());
+        });
+        auto name = L"ml1ac1r" + std::to_wstring(rules.Count());
+        wprintf(
+            L"  %s Commit: rules = %zu, issues = %zu, median = %.1f ns, min = %.1f ns, mad = %.1f ns\n",
+            name.c_str(),
+            rules.Count(),
+            rules.Issues().size(),
+            stats.median,
+            stats.min,
+            stats.mad);
+        results[{name, L"dynamic", L"Commit"}] = stats;
+    }
+}
+
+// one line per config, engine and operation: config,engine,op,cases,reps,min_ns,median_ns,mean_ns,stddev_ns,mad_ns
+static bool SaveResults(const wchar_t* filename, const OpResults& results) {
+    FILE* f = nullptr;
+    if (_wfopen_s(&f, filename, L"w")) {
+        return false;
+    }
+    bool ok = fprintf(f, "config,engine,op,cases,reps,min_ns,median_ns,mean_ns,stddev_ns,mad_ns\n") > 0;
+    for (const auto& [key, stats] : results) {
+        const auto& [config, engine, op] = key;
+        ok = ok && fprintf(
+                       f,
+                       "%ls,%ls,%ls,%zu,%zu,%.2f,%.2f,%.2f,%.2f,%.2f\n",
+                       config.c_str(),
+                       engine.c_str(),
+                       op.c_str(),
+                       stats.cases,
+                       stats.reps,
+                       stats.min,
+                       stats.median,
+                       stats.mean,
+                       stats.stddev,
+                       stats.mad) > 0;
+    }
+    return !fclose(f) && ok;
+}
+
+static bool LoadResults(const wchar_t* filename, OpResults& results) {
+    FILE* f = nullptr;
+    if (_wfopen_s(&f, filename, L"r")) {
+        return false;
+    }
+    char header[128];
+    bool ok = !!fgets(header, sizeof(header), f);
+    char config[64], engine[64], op[64];
+    OpStats stats;
+    while (ok && fscanf_s(
+                     f,
+                     " %63[^,],%63[^,],%63[^,],%zu,%zu,%lf,%lf,%lf,%lf,%lf",
+                     config,
+                     static_cast<unsigned>(sizeof(config)),
+                     engine,
+                     static_cast<unsigned>(sizeof(engine)),
+                     op,
+                     static_cast<unsigned>(sizeof(op)),
+                     &stats.cases,
+                     &stats.reps,
+                     &stats.min,
+                     &stats.median,
+                     &stats.mean,
+                     &stats.stddev,
+                     &stats.mad) == 10) {
+        results[{
+            std::wstring(config, config + strlen(config)),
+            std::wstring(engine, engine + strlen(engine)),
+            std::wstring(op, op + strlen(op))}] = stats;
+    }
+    fclose(f);
+    return ok;
+}
+
+// true if nothing in `results` is slower than `baseline`
+static bool CompareResults(const OpResults& baseline, const OpResults& results) {
+    bool ok = true;
+    for (const auto& [key, stats] : results) {
+        const auto& [config, engine, op] = key;
+        auto it = baseline.find(key);
+        if (it == baseline.end()) {
+            wprintf(L"  %s %s %s: not in baseline\n", config.c_str(), engine.c_str(), op.c_str());
+            continue;
+        }
+        const auto& base = it->second;
+        auto delta = stats.median - base.median;
+        auto regressed = delta > base.median * RegressionTolerance &&
+                         delta > RegressionMads * std::max(stats.mad, base.mad) && delta > RegressionFloorNs;
+        wprintf(
+            L"  %s %s %s: %.1f ns -> %.1f ns (%+.1f%%)%s\n",
+            config.c_str(),
+            engine.c_str(),
+            op.c_str(),
+            base.median,
+            stats.median,
+            base.median > 0 ? 100.0 * delta / base.median : 0.0,
+            regressed ? L" REGRESSION" : L"");
+        ok = ok && !regressed;
+    }
+    return ok;
+}
+
+bool opbench(const wchar_t* output, const wchar_t* baseline) {
+    auto vwords = LoadWordList(L"..\\..\\data\\vw39kw.txt");
+    auto ewords = LoadWordList(L"..\\..\\data\\ewdsw.txt");
+    std::vector<std::wstring> vkeys;
+    {
+        TelexEngine engine(TelexConfig{});
+        for (const auto& word : vwords) {
+            engine.Reset();
+            if (engine.Backconvert(word) == TelexStates::Valid) {
+                vkeys.push_back(engine.RetrieveRaw());
+            }
+        }
+    }
+    if (vkeys.empty() || ewords.empty()) {
+        wprintf(L"cannot read word lists\n");
+        return false;
+    }
+
+    OpResults results;
+    for (int level = 0; level <= 3; level++) {
+        for (int autocorrect = 0; autocorrect <= 1; autocorrect++) {
+            TelexConfig config;
+            config.optimize_multilang = level;
+            config.autocorrect = !!autocorrect;
+            BenchConfig(
+                config,
+                L"ml" + std::to_wstring(level) + L"ac" + std::to_wstring(autocorrect),
+                vwords,
+                vkeys,
+                ewords,
+                results);
+        }
+    }
+    // the default config with each of the other options turned off
+    TelexConfig config;
+    config.oa_uy_tone1 = false;
+    BenchConfig(config, L"ml1ac0oa0", vwords, vkeys, ewords, results);
+    config = TelexConfig{};
+    config.accept_separate_dd = false;
+    BenchConfig(config, L"ml1ac0dd0", vwords, vkeys, ewords, results);
+    config = TelexConfig{};
+    config.backspaced_word_stays_invalid = false;
+    BenchConfig(config, L"ml1ac0bs0", vwords, vkeys, ewords, results);
+    BenchAutocorrectRules(vkeys, results);
+
+    bool ok = true;
+    if (output && !SaveResults(output, results)) {
+        wprintf(L"cannot write %s\n", output);
+        ok = false;
+    }
+    if (baseline) {
+        OpResults base;
+        if (!LoadResults(baseline, base)) {
+            wprintf(L"cannot read %s\n", baseline);
+            return false;
+        }
+        wprintf(L"compared to %s:\n", baseline);
+        ok = CompareResults(base, results) && ok;
+    }
+    return ok;
+}
@@ -12,13 +12,13 @@ using namespace VietType::TestLib;
 
 bool vietscan(const wchar_t* filename) {
     LONGLONG fsize;
-    auto words = static_cast<wchar_t*>(ReadWholeFile(filename, &fsize));
-    auto wend = words + fsize / sizeof(wchar_t);
+    auto words = static_cast<char16_t*>(ReadWholeFile(filename, &fsize));
+    auto wend = words + fsize / sizeof(char16_t);
 
     TelexConfig config;
     TelexEngine engine(config);
-    for (WordListIterator w(words, wend); w != wend; w++) {
-        std::wstring word(*w, w.wlen());
+    for (Utf16WordListIterator w(words, wend); w != wend; w++) {
+        std::wstring word(w.wstr());
 
         engine.Reset();
         auto state = engine.Backconvert(word);
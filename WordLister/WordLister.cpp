@@ -2,12 +2,19 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "stdafx.h"
+#include "TelexEngine.h"
 
 bool vietscan(const wchar_t* filename);
 bool engscan(const wchar_t* filename);
 bool dualscan(int mode);
 bool bench();
-bool fuzz();
+bool opbench(const wchar_t* output, const wchar_t* baseline);
+bool completionbench();
+bool fuzz(size_t maxLen);
+bool difffuzz(const wchar_t* expectedKind, const wchar_t* actualKind, size_t maxLen, size_t walks);
+bool dfagen(const wchar_t* filename);
+bool convertstream(const wchar_t* encodingName);
+bool engfilter(const wchar_t* wordlist, const wchar_t* filename);
 
 int wmain(int argc, wchar_t** argv) {
     if (argc == 3 && !wcscmp(argv[1], L"vietscan")) {
@@ -21,14 +28,32 @@ int wmain(int argc, wchar_t** argv) {
         return !dualscan(mode);
     } else if (argc == 2 && !wcscmp(argv[1], L"bench")) {
         return !bench();
-    } else if (argc == 2 && !wcscmp(argv[1], L"fuzz")) {
-        return !fuzz();
+    } else if (argc >= 2 && argc <= 4 && !wcscmp(argv[1], L"opbench")) {
+        return !opbench(argc >= 3 ? argv[2] : nullptr, argc >= 4 ? argv[3] : nullptr);
+    } else if (argc == 2 && !wcscmp(argv[1], L"completionbench")) {
+        return !completionbench();
+    } else if (argc >= 2 && argc <= 3 && !wcscmp(argv[1], L"fuzz")) {
+        return !fuzz(argc == 3 ? _wtoi(argv[2]) : VietType::Telex::MaxLength);
+    } else if (argc >= 4 && argc <= 6 && !wcscmp(argv[1], L"difffuzz")) {
+        return !difffuzz(argv[2], argv[3], argc >= 5 ? _wtoi(argv[4]) : 3, argc >= 6 ? _wtoi(argv[5]) : 100000);
+    } else if (argc >= 2 && argc <= 3 && !wcscmp(argv[1], L"dfagen")) {
+        return !dfagen(argc == 3 ? argv[2] : nullptr);
+    } else if (argc >= 2 && argc <= 3 && !wcscmp(argv[1], L"convert")) {
+        return !convertstream(argc == 3 ? argv[2] : nullptr);
+    } else if (argc == 4 && !wcscmp(argv[1], L"engfilter")) {
+        return !engfilter(argv[2], argv[3]);
     } else {
         wprintf(L"usage: \n"
                 L"    wordlister <vietscan|engscan> <filename>\n"
                 L"    wordlister dualscan\n"
                 L"    wordlister bench\n"
-                L"    wordlister fuzz\n");
+                L"    wordlister opbench [output.csv] [baseline.csv]\n"
+                L"    wordlister completionbench\n"
+                L"    wordlister fuzz [maxlen]\n"
+                L"    wordlister difffuzz <dynamic|fixed|cache|dfa> <dynamic|fixed|cache|dfa> [maxlen] [walks]\n"
+                L"    wordlister dfagen [filename]\n"
+                L"    wordlister convert [utf8|utf16] < input > output\n"
+                L"    wordlister engfilter <wordlist> <filename>\n");
         return 1;
     }
 }